@@ -0,0 +1,16 @@
+#!/bin/sh
+# Stand-in for a dedicated server, floods stdout with Unreal log lines, stays quiet for a while, then exits.
+# Usage: floodServerLog.sh [megabytes] [quiet seconds] [exit code]
+megabytes=${1:-256}
+quietSeconds=${2:-0}
+exitCode=${3:-0}
+
+yes "[2023.05.12-14.22.31:412][ 17]LogNetTraffic: Verbose: UNetConnection::ReceivedPacket: Received packet of 87 bytes
+[2023.05.12-14.22.31:413][ 17]LogNet: Warning: UActorChannel::ProcessBunch: New actor channel received non-open packet
+[2023.05.12-14.22.31:413][ 17]LogTemp: Spawned BP_Vehicle_C_12 at X=1520.000 Y=-330.500 Z=92.150
+[2023.05.12-14.22.31:415][ 18]LogReplicationGraph: Error: Actor BP_Pickup_C_3 is not in the grid, skipping" |
+	head -c $((megabytes * 1048576))
+
+# The reader has to sleep meanwhile, not spin
+sleep "$quietSeconds"
+exit "$exitCode"
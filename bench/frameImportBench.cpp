@@ -0,0 +1,357 @@
+// Headless benchmark of the frame snapshot import pipeline.
+// Runs the same FrameLoader pipeline used by FrameAnalyzerWindow::ImportFrameSnapshots over a
+// synthetic directory of frames, without any window, Graphics API or file dialog.
+//
+// Usage: frame_import_bench [--frames N] [--width W] [--height H] [--format png|tga|bmp|mixed]
+//                           [--dir PATH] [--batch N] [--budget MB] [--pixels bc1|rgb] [--delta] [--keep]
+//                           [--thumbnails] [--decoder stb|libpng] [--source CAPTURE_DIR|SEQUENCE.ufs]
+//                           [--cache DIR] [--statistics]
+// Run twice with the same --cache (and --keep or --source) to time an import served by the frame cache.
+
+// StdLib Includes
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Platform Includes
+#if WIN32
+	#include <windows.h>
+	#include <psapi.h>
+#else
+	#include <sys/resource.h>
+#endif
+
+// Third Party Includes
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <fmt/core.h>
+
+// Internal Includes
+#include <app/frameDecoder.h>
+#include <app/frameDeltaStore.h>
+#include <app/frameHashIndex.h>
+#include <app/frameLoader.h>
+#include <app/frameStatistics.h>
+#include "syntheticFrames.h"
+
+namespace fs = std::filesystem;
+using steadyClock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+	int FrameCount = 1000;
+	int Width = 1280;
+	int Height = 720;
+	string Format = "png";
+	string Directory;
+	string SourceDirectory;
+	string CacheDirectory;
+	size_t BatchSize = 32;
+	size_t BudgetMB = PixelBudget::DefaultLimitBytes >> 20;
+	FramePixelFormat PixelFormat = FramePixelFormat::BC1;
+	bool DeltaEncode = false;
+	bool KeepFrames = false;
+	bool Thumbnails = false;
+	bool Statistics = false;
+	FrameDecoderBackend PngDecoder = GetFrameDecoder(FrameImageFormat::Png).GetBackend();
+};
+
+static size_t GetPeakResidentBytes()
+{
+#if WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+	#if __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+	#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+	#endif
+#endif
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--frames" && hasValue) options.FrameCount = std::stoi(argv[++i]);
+		else if (arg == "--width" && hasValue) options.Width = std::stoi(argv[++i]);
+		else if (arg == "--height" && hasValue) options.Height = std::stoi(argv[++i]);
+		else if (arg == "--format" && hasValue) options.Format = argv[++i];
+		else if (arg == "--dir" && hasValue) options.Directory = argv[++i];
+		else if (arg == "--batch" && hasValue) options.BatchSize = std::stoul(argv[++i]);
+		else if (arg == "--budget" && hasValue) options.BudgetMB = std::stoul(argv[++i]);
+		else if (arg == "--pixels" && hasValue)
+		{
+			const string pixels = argv[++i];
+			if (pixels != "bc1" && pixels != "rgb") return false;
+			options.PixelFormat = pixels == "bc1" ? FramePixelFormat::BC1 : FramePixelFormat::RGB8;
+		}
+		else if (arg == "--decoder" && hasValue)
+		{
+			const string decoder = argv[++i];
+			if (decoder != "stb" && decoder != "libpng") return false;
+			options.PngDecoder = decoder == "stb" ? FrameDecoderBackend::Stb : FrameDecoderBackend::LibPng;
+		}
+		else if (arg == "--source" && hasValue) options.SourceDirectory = argv[++i];
+		else if (arg == "--cache" && hasValue) options.CacheDirectory = argv[++i];
+		else if (arg == "--delta") options.DeltaEncode = true;
+		else if (arg == "--keep") options.KeepFrames = true;
+		else if (arg == "--thumbnails") options.Thumbnails = true;
+		else if (arg == "--statistics") options.Statistics = true;
+		else
+		{
+			fmt::print(stderr, "Unknown argument: {0}\n", arg);
+			return false;
+		}
+	}
+
+	if (options.Directory.empty())
+	{
+		options.Directory = (fs::temp_directory_path() / "ue4nt_frame_import_bench").string();
+	}
+	return options.FrameCount > 0 && options.Width > 0 && options.Height > 0;
+}
+
+// Benchmarks an existing capture, frames are loaded in file name order
+static vector<string> ListSourceFrames(const BenchOptions& options)
+{
+	vector<string> framePaths;
+	if (fs::is_regular_file(options.SourceDirectory))
+	{
+		framePaths.push_back(options.SourceDirectory);
+		return framePaths;
+	}
+
+	for (const fs::directory_entry& entry : fs::directory_iterator(options.SourceDirectory))
+	{
+		string ext = entry.path().extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+		if (ext == ".png" || ext == ".tga" || ext == ".bmp" || ext == ".jpeg" || ext == ".jpg" || ext == ".gif")
+		{
+			framePaths.push_back(entry.path().string());
+		}
+	}
+	std::sort(framePaths.begin(), framePaths.end());
+	if (framePaths.size() > static_cast<size_t>(options.FrameCount)) framePaths.resize(options.FrameCount);
+	return framePaths;
+}
+
+static vector<string> GenerateFrames(const BenchOptions& options)
+{
+	using synthetic::FrameFormat;
+	fs::create_directories(options.Directory);
+
+	vector<string> framePaths;
+	framePaths.reserve(options.FrameCount);
+	vector<uint8_t> pixels;
+	for (int frameIt = 0; frameIt < options.FrameCount; ++frameIt)
+	{
+		FrameFormat format = FrameFormat::Png;
+		if (options.Format == "tga") format = FrameFormat::Tga;
+		else if (options.Format == "bmp") format = FrameFormat::Bmp;
+		else if (options.Format == "mixed") format = static_cast<FrameFormat>(frameIt % 3);
+
+		const string fileName = fmt::format("frame_{0:06}_{1}x{2}{3}", frameIt, options.Width, options.Height,
+			synthetic::GetFormatExtension(format));
+		const string framePath = (fs::path(options.Directory) / fileName).string();
+
+		// Re-use frames of previous runs with the same settings
+		if (!fs::exists(framePath))
+		{
+			synthetic::GenerateFramePixels(pixels, options.Width, options.Height, frameIt);
+			synthetic::WriteFrame(framePath, format, pixels, options.Width, options.Height);
+		}
+		framePaths.push_back(framePath);
+	}
+	return framePaths;
+}
+
+// Times the perceptual hash queries of the Frame Analyzer, the loaded hashes are repeated up to
+// HashQueryFrames so the numbers do not depend on how many frames were imported
+static void PrintHashQueries(const FrameHashIndex& frameHashes)
+{
+	constexpr int HashQueryFrames = 100000;
+	if (frameHashes.GetFrameCount() == 0) return;
+
+	FrameHashIndex queryIndex;
+	for (int frameIt = 0; frameIt < max(HashQueryFrames, frameHashes.GetFrameCount()); ++frameIt)
+	{
+		queryIndex.SetHash(frameIt, frameHashes.GetHash(frameIt % frameHashes.GetFrameCount()));
+	}
+
+	vector<int> similarFrames;
+	vector<FrameRun> freezeRuns;
+	steadyClock::time_point start = steadyClock::now();
+	queryIndex.FindSimilar(queryIndex.GetHash(0), FrameHashIndex::DefaultMaxDistance, similarFrames);
+	const double similarMs = std::chrono::duration<double, std::milli>(steadyClock::now() - start).count();
+	start = steadyClock::now();
+	queryIndex.FindFreezeRuns(0, queryIndex.GetFrameCount(), FrameHashIndex::DefaultMaxDistance, 10, freezeRuns);
+	const double freezeMs = std::chrono::duration<double, std::milli>(steadyClock::now() - start).count();
+	fmt::print("Hash queries:      {0:.3f} ms similar ({1} hits), {2:.3f} ms freeze runs ({3} runs) over {4} frames\n",
+		similarMs, similarFrames.size(), freezeMs, freezeRuns.size(), queryIndex.GetFrameCount());
+}
+
+static void PrintStatisticsQueries(const FrameStatisticsSeries& frameStatistics)
+{
+	const int frameCount = frameStatistics.GetFrameCount();
+	if (frameCount == 0) return;
+
+	const float* changedRatio = frameStatistics.GetChangedRatio();
+	const int peakFrame = static_cast<int>(std::max_element(changedRatio, changedRatio + frameCount) - changedRatio);
+	float histogram[LumaHistogramBins];
+	steadyClock::time_point start = steadyClock::now();
+	frameStatistics.GetRangeHistogram(0, frameCount, histogram);
+	const double histogramMs = std::chrono::duration<double, std::milli>(steadyClock::now() - start).count();
+	fmt::print("Frame statistics:  {0:.3f} ms range histogram over {1} frames, peak change {2:.1f}% at frame {3}\n",
+		histogramMs, frameCount, changedRatio[peakFrame] * 100.0f, peakFrame);
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		fmt::print(stderr, "Usage: frame_import_bench [--frames N] [--width W] [--height H] "
+						   "[--format png|tga|bmp|mixed] [--dir PATH] [--batch N] [--budget MB] [--pixels bc1|rgb] "
+						   "[--delta] [--keep] [--thumbnails] [--decoder stb|libpng] "
+						   "[--source CAPTURE_DIR|SEQUENCE.ufs] [--cache DIR] [--statistics]\n");
+		return 1;
+	}
+
+	vector<string> framePaths;
+	if (!options.SourceDirectory.empty())
+	{
+		framePaths = ListSourceFrames(options);
+		fmt::print("Loading frames from {0}\n", options.SourceDirectory);
+	}
+	else
+	{
+		fmt::print("Generating {0} {1} frames ({2}x{3}) at {4}\n", options.FrameCount, options.Format,
+			options.Width, options.Height, options.Directory);
+		framePaths = GenerateFrames(options);
+	}
+
+	string error;
+	vector<FrameSource> frameSources;
+	if (!FrameLoader::ResolveFrameSources(framePaths, frameSources, &error))
+	{
+		fmt::print(stderr, "{0}\n", error);
+		return 1;
+	}
+
+	SetFrameDecoderBackend(FrameImageFormat::Png, options.PngDecoder);
+
+	tf::Executor executor;
+	FrameLoader frameLoader(executor);
+	frameLoader.GetStats().Reset();
+	frameLoader.GetPixelBudget().SetLimit(options.BudgetMB << 20);
+	frameLoader.SetPixelFormat(options.PixelFormat);
+	auto deltaStore = options.DeltaEncode ? std::make_shared<FrameDeltaStore>() : nullptr;
+	frameLoader.SetDeltaStore(deltaStore);
+	frameLoader.SetMakeThumbnails(options.Thumbnails);
+	frameLoader.SetMeasureStatistics(options.Statistics);
+	auto frameCache = options.CacheDirectory.empty() ? nullptr : std::make_shared<FrameCache>();
+	if (frameCache != nullptr && !frameCache->Open(options.CacheDirectory, &error))
+	{
+		fmt::print(stderr, "{0}\n", error);
+		return 1;
+	}
+	frameLoader.SetFrameCache(frameCache);
+	const size_t baseResidentBytes = GetPeakResidentBytes();
+
+	// Emulate the render thread: pull up to a batch per iteration and release pixels as if they were uploaded
+	std::deque<LoadImageJob> uploadDeque;
+	FrameHashIndex frameHashes;
+	FrameStatisticsSeries frameStatistics;
+	FrameStatistics lastStatistics;
+	size_t consumedCount = 0;
+	steadyClock::time_point start = steadyClock::now();
+	frameLoader.Load(std::move(frameSources));
+	while (consumedCount < frameLoader.GetFrameCount())
+	{
+		if (frameLoader.PullLoadedFrames(uploadDeque, options.BatchSize) == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (LoadImageJob& job : uploadDeque)
+		{
+			frameHashes.SetHash(frameHashes.GetFrameCount(), job.PerceptualHash);
+			if (options.Statistics)
+			{
+				// Same bookkeeping as the analyzer, every frame is compared to the one before
+				const float changedRatio = GetChangedRatio(lastStatistics, job.Statistics);
+				frameStatistics.SetFrame(frameStatistics.GetFrameCount(), job.Statistics, changedRatio);
+				lastStatistics = std::move(job.Statistics);
+			}
+			FrameLoader::ReleaseImageData(job);
+		}
+		consumedCount += uploadDeque.size();
+		uploadDeque.clear();
+	}
+	const double elapsedSec = std::chrono::duration<double>(steadyClock::now() - start).count();
+	frameLoader.Wait();
+
+	// Report
+	FrameLoaderStats& stats = frameLoader.GetStats();
+	const double frames = static_cast<double>(consumedCount);
+	auto perFrameMs = [frames](uint64_t ns) { return ns / frames / 1.0e6; };
+	fmt::print("Frames:            {0} ({1} failed)\n", consumedCount, stats.FramesFailed.load());
+	fmt::print("Worker threads:    {0}\n", executor.num_workers());
+	fmt::print("PNG decoder:       {0}\n", GetFrameDecoderBackendName(options.PngDecoder));
+	fmt::print("Wall time:         {0:.3f} s\n", elapsedSec);
+	fmt::print("Throughput:        {0:.1f} frames/s, {1:.1f} MB/s decoded\n", frames / elapsedSec,
+		stats.DecodedBytes / elapsedSec / (1024.0 * 1024.0));
+	fmt::print("Serial emit:       {0:.4f} ms/frame\n", perFrameMs(stats.EmitNs));
+	fmt::print("Parallel decode:   {0:.4f} ms/frame ({1:.4f} ms compressing, {2:.4f} ms thumbnails, "
+			   "{3:.4f} ms hashing)\n",
+		perFrameMs(stats.DecodeNs), perFrameMs(stats.CompressNs), perFrameMs(stats.ThumbnailNs),
+		perFrameMs(stats.HashNs));
+	if (options.Statistics)
+	{
+		fmt::print("Statistics:        {0:.4f} ms/frame ({1:.1f}% of decoding)\n", perFrameMs(stats.StatisticsNs),
+			stats.DecodeNs > 0 ? 100.0 * stats.StatisticsNs / stats.DecodeNs : 0.0);
+	}
+	fmt::print("Serial hand-off:   {0:.4f} ms/frame\n", perFrameMs(stats.HandOffNs));
+	if (frameCache != nullptr)
+	{
+		fmt::print("Frame cache:       {0} hits, {1:.4f} ms/frame in lookups and reads, {2:.1f} MB on disk\n",
+			stats.FramesCached.load(), perFrameMs(stats.CacheNs), frameCache->GetDataSize() / (1024.0 * 1024.0));
+	}
+	fmt::print("Ring full stall:   {0:.3f} ms total\n", stats.RingFullNs / 1.0e6);
+	fmt::print("Budget wait:       {0:.3f} ms total\n", stats.BudgetWaitNs / 1.0e6);
+	fmt::print("Peak pixels:       {0:.1f} MB (budget {1} MB)\n",
+		frameLoader.GetPixelBudget().GetPeakBytes() / (1024.0 * 1024.0), options.BudgetMB);
+	// Steady state loading reuses the buffers the consumer released, allocations stop once the pipeline is full
+	const PixelBufferPool& pixelPool = PixelBufferPool::GetShared();
+	fmt::print("Pixel buffers:     {0} allocated, {1} reused\n", pixelPool.GetAllocationCount(),
+		pixelPool.GetReuseCount());
+	if (deltaStore != nullptr)
+	{
+		fmt::print("Delta store:       {0:.1f} MB ({1:.1f} MB as plain BC1)\n",
+			deltaStore->GetStoredBytes() / (1024.0 * 1024.0), deltaStore->GetEncodedBytes() / (1024.0 * 1024.0));
+	}
+	PrintHashQueries(frameHashes);
+	PrintStatisticsQueries(frameStatistics);
+	fmt::print("Peak RSS:          {0:.1f} MB (before load {1:.1f} MB)\n",
+		GetPeakResidentBytes() / (1024.0 * 1024.0), baseResidentBytes / (1024.0 * 1024.0));
+
+	if (!options.KeepFrames && options.SourceDirectory.empty())
+	{
+		std::error_code error;
+		fs::remove_all(options.Directory, error);
+	}
+	return 0;
+}
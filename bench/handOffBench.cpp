@@ -0,0 +1,255 @@
+// Contention microbenchmark of the decoder -> render thread hand-off.
+// Compares the previous design (mutex guarded vector drained into a deque once more than a batch is
+// waiting) against the lock-free SPSC ring used by FrameLoader. A producer thread plays the serial
+// hand-off stage and a consumer thread plays the render loop, polling at a given interval.
+// The mutex queue is unbounded while the ring holds --capacity items: flooded (--produce-us 0) with a slow
+// consumer, the ring hands off at most capacity items per poll and its producer waits for room.
+//
+// Usage: hand_off_bench [--items N] [--poll-us N] [--produce-us N] [--batch N] [--capacity N]
+
+// StdLib Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Third Party Includes
+#include <fmt/core.h>
+
+// Internal Includes
+#include <RVCore/spscRing.h>
+#include <app/frameLoader.h>
+
+using steadyClock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+	size_t ItemCount = 200000;
+	int PollUs = 0;	   // Consumer polling interval, zero spins
+	int ProduceUs = 0; // Simulated decode time between hand-offs, zero floods
+	size_t BatchSize = 32;
+	size_t Capacity = FrameLoader::HandOffCapacity;
+};
+
+// What travels through the hand-off, a real job plus when it was handed off
+struct HandOffItem
+{
+	LoadImageJob Job;
+	int64_t PushedNs = 0;
+};
+
+struct HandOffResult
+{
+	double WallSec = 0.0;
+	uint64_t ProducerNs = 0; // Time spent inside push (lock wait or ring full stall)
+	uint64_t ConsumerNs = 0; // Time spent inside pull
+	vector<int64_t> LatencyNs;
+};
+
+static int64_t NowNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(steadyClock::now().time_since_epoch()).count();
+}
+
+static void Spin(int us)
+{
+	if (us <= 0) return;
+	const steadyClock::time_point end = steadyClock::now() + std::chrono::microseconds(us);
+	while (steadyClock::now() < end) { }
+}
+
+// Replica of the original hand-off: every push locks, the consumer only locks once a batch is waiting
+class MutexHandOff
+{
+  public:
+	MutexHandOff(size_t itemCount, size_t batchSize) : _itemCount(itemCount), _batchSize(batchSize)
+	{
+		_buff.reserve(itemCount);
+	}
+
+	bool Push(HandOffItem&& item)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_buff.push_back(std::move(item));
+		_buffSize = _buff.size();
+		return true;
+	}
+
+	size_t Pull(std::deque<HandOffItem>& out)
+	{
+		const size_t pendingCount = _buffSize;
+		const size_t remainingCount = _itemCount - _pulledCount;
+		if (pendingCount == 0 || (pendingCount <= _batchSize && remainingCount > _batchSize)) return 0;
+
+		std::lock_guard<std::mutex> lock(_lock);
+		const size_t pulledCount = _buff.size();
+		out.insert(out.end(), std::make_move_iterator(_buff.begin()), std::make_move_iterator(_buff.end()));
+		_buff.clear();
+		_buffSize = 0;
+		_pulledCount += pulledCount;
+		return pulledCount;
+	}
+
+  private:
+	std::mutex _lock;
+	vector<HandOffItem> _buff;
+	std::atomic<size_t> _buffSize = {0};
+	size_t _itemCount;
+	size_t _batchSize;
+	size_t _pulledCount = 0;
+};
+
+// The hand-off of FrameLoader: a full ring blocks the producer until the consumer frees slots
+class RingHandOff
+{
+  public:
+	explicit RingHandOff(size_t capacity) : _ring(capacity) {}
+
+	bool Push(HandOffItem&& item)
+	{
+		if (_ring.TryPush(std::move(item))) return true;
+
+		std::unique_lock<std::mutex> lock(_fullLock);
+		_producerWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with the fence of Pull
+		_slotsFreed.wait(lock, [&]() { return _ring.TryPush(std::move(item)); });
+		_producerWaiting.store(false, std::memory_order_relaxed);
+		return true;
+	}
+
+	size_t Pull(std::deque<HandOffItem>& out)
+	{
+		size_t pulledCount = 0;
+		HandOffItem item;
+		while (_ring.TryPop(item))
+		{
+			out.push_back(std::move(item));
+			pulledCount++;
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (pulledCount > 0 && _producerWaiting.load(std::memory_order_relaxed))
+		{
+			std::lock_guard<std::mutex> lock(_fullLock);
+			_slotsFreed.notify_one();
+		}
+		return pulledCount;
+	}
+
+  private:
+	rv::SpscRing<HandOffItem> _ring;
+	std::mutex _fullLock;
+	std::condition_variable _slotsFreed;
+	std::atomic<bool> _producerWaiting = {false};
+};
+
+template <typename THandOff>
+static HandOffResult RunHandOff(THandOff& handOff, const BenchOptions& options)
+{
+	HandOffResult result;
+	result.LatencyNs.reserve(options.ItemCount);
+	const steadyClock::time_point start = steadyClock::now();
+
+	std::thread producer(
+		[&]()
+		{
+			for (size_t itemIt = 0; itemIt < options.ItemCount; ++itemIt)
+			{
+				Spin(options.ProduceUs);
+
+				HandOffItem item;
+				item.Job.Width = static_cast<int>(itemIt);
+				item.Job.Source.ImagePath = "D:/Captures/Session42/frame_000000.png";
+				const int64_t pushStart = NowNs();
+				item.PushedNs = pushStart;
+				while (!handOff.Push(std::move(item)))
+				{
+					std::this_thread::yield();
+				}
+				result.ProducerNs += NowNs() - pushStart;
+			}
+		});
+
+	std::deque<HandOffItem> pulled;
+	size_t consumedCount = 0;
+	while (consumedCount < options.ItemCount)
+	{
+		const int64_t pullStart = NowNs();
+		handOff.Pull(pulled);
+		const int64_t pullEnd = NowNs();
+		result.ConsumerNs += pullEnd - pullStart;
+
+		for (const HandOffItem& item : pulled)
+		{
+			result.LatencyNs.push_back(pullEnd - item.PushedNs);
+		}
+		consumedCount += pulled.size();
+		pulled.clear();
+
+		if (options.PollUs > 0) std::this_thread::sleep_for(std::chrono::microseconds(options.PollUs));
+	}
+
+	producer.join();
+	result.WallSec = std::chrono::duration<double>(steadyClock::now() - start).count();
+	return result;
+}
+
+static void PrintResult(const char* name, HandOffResult& result, size_t itemCount)
+{
+	std::sort(result.LatencyNs.begin(), result.LatencyNs.end());
+	auto percentileUs = [&](double p)
+	{
+		const size_t index = min(static_cast<size_t>(p * result.LatencyNs.size()), result.LatencyNs.size() - 1);
+		return result.LatencyNs[index] / 1.0e3;
+	};
+
+	fmt::print("{0:<8} {1:>10.0f} {2:>12.1f} {3:>12.1f} {4:>10.1f} {5:>10.1f} {6:>10.1f}\n", name,
+		itemCount / result.WallSec, result.ProducerNs / double(itemCount), result.ConsumerNs / double(itemCount),
+		percentileUs(0.5), percentileUs(0.99), percentileUs(1.0));
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--items" && hasValue) options.ItemCount = std::stoul(argv[++i]);
+		else if (arg == "--poll-us" && hasValue) options.PollUs = std::stoi(argv[++i]);
+		else if (arg == "--produce-us" && hasValue) options.ProduceUs = std::stoi(argv[++i]);
+		else if (arg == "--batch" && hasValue) options.BatchSize = std::stoul(argv[++i]);
+		else if (arg == "--capacity" && hasValue) options.Capacity = std::stoul(argv[++i]);
+		else return false;
+	}
+	return options.ItemCount > 0 && options.Capacity > 0;
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		fmt::print(stderr, "Usage: hand_off_bench [--items N] [--poll-us N] [--produce-us N] [--batch N] "
+						   "[--capacity N]\n");
+		return 1;
+	}
+
+	fmt::print("Handing off {0} items (consumer poll {1} us, producer spacing {2} us)\n", options.ItemCount,
+		options.PollUs, options.ProduceUs);
+	fmt::print("{0:<8} {1:>10} {2:>12} {3:>12} {4:>10} {5:>10} {6:>10}\n", "Design", "items/s", "push ns/item",
+		"pull ns/item", "p50 us", "p99 us", "max us");
+
+	MutexHandOff mutexHandOff(options.ItemCount, options.BatchSize);
+	HandOffResult mutexResult = RunHandOff(mutexHandOff, options);
+	PrintResult("mutex", mutexResult, options.ItemCount);
+
+	RingHandOff ringHandOff(options.Capacity);
+	HandOffResult ringResult = RunHandOff(ringHandOff, options);
+	PrintResult("ring", ringResult, options.ItemCount);
+	return 0;
+}
@@ -0,0 +1,436 @@
+// Throughput microbenchmark of the server log ingest.
+// Compares the previous design (read queue copied into a string, a substr and a heap string per line, verbosity
+// found by up to seven string searches) against ServerLogStore, which appends into its arena and scans every byte
+// once. Synthetic Unreal output is fed in reads of the pipe buffer size, as the reader thread hands them over.
+// The rates row also counts every line into the time buckets of ServerLogRates, which should cost next to nothing.
+// The indexed row also builds ServerLogIndex (posting lists and columns, the word index on a thread of its own), then
+// times a few filters over the whole log once every word is indexed: the slice the frame changing the filter pays and
+// the total over the frames it takes.
+// The copy row only copies the reads into new chunks of the same size as the arena, the bound for any design that
+// keeps the text (most of it is the first touch of new memory).
+// With --command the output of a real process is ingested instead, read by ServerProcess while this thread sleeps
+// until it's woken up, like the launcher window (bench/floodServerLog.sh stands in for a server).
+//
+// Usage: log_ingest_bench [--megabytes N] [--read-size N] [--repeat N]
+//        log_ingest_bench --command "sh bench/floodServerLog.sh 512 2"
+
+// StdLib Includes
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Third Party Includes
+#include <fmt/core.h>
+
+// Internal Includes
+#include <app/serverLogIndex.h>
+#include <app/serverLogRates.h>
+#include <app/serverLogStore.h>
+#include <app/serverProcess.h>
+
+using steadyClock = std::chrono::steady_clock;
+using string = std::string;
+
+struct BenchOptions
+{
+	size_t Megabytes = 256;
+	size_t ReadSize = 4096; // What a pipe read returns at most
+	int Repeat = 3;
+	string Command; // Ingest the output of this command instead
+};
+
+struct IngestResult
+{
+	double BestSec = 0.0;
+	size_t LineCount = 0;
+	size_t MemoryBytes = 0;
+	size_t VerbosityCounts[7] = {};
+};
+
+// Replica of the original parsing in PullServerOutputLog
+struct LogEntry
+{
+	string message;
+	LogVerbosity verbosity;
+};
+
+static LogVerbosity ParseLogVerbosity(string_view logStrView)
+{
+	if (logStrView.find("Fatal") != string_view::npos) return LogVerbosity::Fatal;
+	if (logStrView.find("Error") != string_view::npos) return LogVerbosity::Error;
+	if (logStrView.find("Warning") != string_view::npos) return LogVerbosity::Warning;
+	if (logStrView.find("Display") != string_view::npos) return LogVerbosity::Display;
+	if (logStrView.find("Log") != string_view::npos) return LogVerbosity::Log;
+	if (logStrView.find("Verbose") != string_view::npos) return LogVerbosity::Verbose;
+	if (logStrView.find("VeryVerbose") != string_view::npos) return LogVerbosity::VeryVerbose;
+	return LogVerbosity::Log;
+}
+
+static void IngestPrevious(const vector<char>& readQueue, vector<LogEntry>& logs)
+{
+	static string output;
+	output.assign(readQueue.begin(), readQueue.end());
+
+	size_t iniEndLine = 0;
+	size_t endEndLine = output.find_first_of('\n', iniEndLine);
+	while (endEndLine != string::npos)
+	{
+		string msg = output.substr(iniEndLine, endEndLine - iniEndLine);
+		string_view msgView = msg;
+
+		LogVerbosity verbosity = LogVerbosity::Log;
+		size_t verbIniP = -1;
+		if (msgView[0] == '[')
+		{
+			verbIniP = msgView.find_first_of(']', verbIniP + 1);
+			verbIniP = msgView.find_first_of(']', verbIniP + 1);
+		}
+		verbIniP = msgView.find_first_of(':', verbIniP + 1) + 1;
+		size_t verbEndP = msgView.find_first_of(':', verbIniP + 1);
+		if (verbIniP != string_view::npos && verbEndP != string_view::npos)
+		{
+			verbosity = ParseLogVerbosity(msgView.substr(verbIniP, verbEndP - verbIniP));
+		}
+		logs.push_back({std::move(msg), verbosity});
+
+		iniEndLine = endEndLine + 1;
+		endEndLine = output.find_first_of('\n', iniEndLine);
+	}
+}
+
+// Dedicated server output with the usual mix: traffic spam, some warnings, categories with and without verbosity
+static string GenerateLog(size_t size)
+{
+	static const char* const Messages[] = {
+		"LogNetTraffic: Verbose: UNetConnection::ReceivedPacket: Received packet of 87 bytes, InPacketId 4123",
+		"LogNet: Warning: UActorChannel::ProcessBunch: New actor channel received non-open packet. bOpen: 0",
+		"LogNet: Display: NotifyAcceptingConnection accepted from: 192.168.0.12:52781",
+		"LogNetPlayerMovement: Warning: ServerMove: TimeStamp expired: 41.832, CurrentTimeStamp: 42.118",
+		"LogTemp: Spawned BP_Vehicle_C_12 at X=1520.000 Y=-330.500 Z=92.150",
+		"LogGameMode: Display: Match State Changed from WaitingToStart to InProgress",
+		"LogReplicationGraph: Error: Actor BP_Pickup_C_3 is not in the grid, skipping",
+		"LogNetTraffic: VeryVerbose: Sent bunch on channel 7, 312 bits, reliable 1",
+	};
+
+	std::mt19937 random(42);
+	string text;
+	text.reserve(size + 256);
+	for (uint32_t lineIt = 0; text.size() < size; ++lineIt)
+	{
+		text += fmt::format("[2023.05.12-14.22.{0:02}:{1:03}][{2:3}]{3}\r\n", (lineIt / 1000) % 60, lineIt % 1000,
+			(lineIt / 8) % 1000, Messages[random() % std::size(Messages)]);
+	}
+	return text;
+}
+
+template <typename TIngest>
+static double TimeIngest(const string& text, size_t readSize, TIngest&& ingest)
+{
+	const steadyClock::time_point start = steadyClock::now();
+	for (size_t readOffset = 0; readOffset < text.size(); readOffset += readSize)
+	{
+		ingest(text.data() + readOffset, std::min(readSize, text.size() - readOffset));
+	}
+	return std::chrono::duration<double>(steadyClock::now() - start).count();
+}
+
+static IngestResult RunPrevious(const string& text, const BenchOptions& options)
+{
+	IngestResult result;
+	for (int repeatIt = 0; repeatIt < options.Repeat; ++repeatIt)
+	{
+		vector<LogEntry> logs;
+		vector<char> readQueue;
+		const double seconds = TimeIngest(text, options.ReadSize,
+			[&](const char* data, size_t size)
+			{
+				readQueue.assign(data, data + size);
+				IngestPrevious(readQueue, logs);
+			});
+		if (repeatIt == 0 || seconds < result.BestSec) result.BestSec = seconds;
+
+		result = {result.BestSec, logs.size(), logs.capacity() * sizeof(LogEntry)};
+		for (const LogEntry& entry : logs)
+		{
+			// Short messages fit in the string itself, the rest is a heap block each
+			if (entry.message.capacity() > string().capacity()) result.MemoryBytes += entry.message.capacity() + 1;
+			result.VerbosityCounts[int(entry.verbosity)]++;
+		}
+	}
+	return result;
+}
+
+static IngestResult RunCopy(const string& text, const BenchOptions& options)
+{
+	IngestResult result;
+	for (int repeatIt = 0; repeatIt < options.Repeat; ++repeatIt)
+	{
+		vector<std::unique_ptr<char[]>> chunks;
+		size_t chunkSize = ServerLogStore::ChunkSize;
+		const double seconds = TimeIngest(text, options.ReadSize,
+			[&](const char* data, size_t size)
+			{
+				while (size > 0)
+				{
+					if (chunkSize == ServerLogStore::ChunkSize)
+					{
+						chunks.emplace_back(new char[ServerLogStore::ChunkSize]);
+						chunkSize = 0;
+					}
+					const size_t copySize = std::min(size, ServerLogStore::ChunkSize - chunkSize);
+					memcpy(chunks.back().get() + chunkSize, data, copySize);
+					chunkSize += copySize;
+					data += copySize;
+					size -= copySize;
+				}
+			});
+		if (repeatIt == 0 || seconds < result.BestSec) result.BestSec = seconds;
+		result.MemoryBytes = chunks.size() * ServerLogStore::ChunkSize;
+	}
+	return result;
+}
+
+static IngestResult RunStore(const string& text, const BenchOptions& options)
+{
+	IngestResult result;
+	for (int repeatIt = 0; repeatIt < options.Repeat; ++repeatIt)
+	{
+		ServerLogStore store;
+		const double seconds =
+			TimeIngest(text, options.ReadSize, [&](const char* data, size_t size) { store.Append(data, size); });
+		if (repeatIt == 0 || seconds < result.BestSec) result.BestSec = seconds;
+
+		result = {result.BestSec, store.GetLineCount(), store.GetMemoryBytes()};
+		for (size_t lineIt = 0; lineIt < store.GetLineCount(); ++lineIt)
+		{
+			result.VerbosityCounts[int(store.GetLine(lineIt).Verbosity)]++;
+		}
+	}
+	return result;
+}
+
+// The output callback only flags the batch and notifies, this thread sleeps until then as the main loop does
+static int RunCommand(const string& command)
+{
+	ServerLogStore store;
+	ServerProcess server;
+	std::mutex wakeLock;
+	std::condition_variable wakeCondition;
+	bool woken = false;
+	server.SetOutputCallback(
+		[&]()
+		{
+			{
+				std::lock_guard<std::mutex> lock(wakeLock);
+				woken = true;
+			}
+			wakeCondition.notify_one();
+		});
+
+	const std::clock_t cpuStart = std::clock();
+	const steadyClock::time_point start = steadyClock::now();
+	string error;
+	if (!server.Start(command, &error))
+	{
+		fmt::print(stderr, "{0}\n", error);
+		return 1;
+	}
+
+	vector<char> batch;
+	size_t outputSize = 0;
+	size_t wakeCount = 0;
+	for (bool exited = false; !exited;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(wakeLock);
+			wakeCondition.wait(lock, [&]() { return woken; });
+			woken = false;
+		}
+		wakeCount++;
+
+		// Checked before pulling, all the output is in the batch once the process exited
+		exited = server.HasExited();
+		if (server.PullOutput(batch) > 0)
+		{
+			store.Append(batch.data(), batch.size());
+			outputSize += batch.size();
+		}
+	}
+	const double seconds = std::chrono::duration<double>(steadyClock::now() - start).count();
+	const double cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+	server.Stop();
+
+	size_t verbosityCounts[7] = {};
+	for (size_t lineIt = 0; lineIt < store.GetLineCount(); ++lineIt)
+	{
+		verbosityCounts[int(store.GetLine(lineIt).Verbosity)]++;
+	}
+	fmt::print("Read {0:.1f} MB ({1} lines, {2} errors, {3} warns) in {4:.2f}s, {5:.0f} MB/s\n", outputSize / 1.0e6,
+		store.GetLineCount(), verbosityCounts[int(LogVerbosity::Error)], verbosityCounts[int(LogVerbosity::Warning)],
+		seconds, outputSize / seconds / 1.0e6);
+	fmt::print("{0} wakes, {1:.2f}s of CPU time in this process, exit code {2}\n", wakeCount, cpuSeconds,
+		server.GetExitCode());
+	return 0;
+}
+
+static void PrintResult(const char* name, const IngestResult& result, size_t textSize)
+{
+	fmt::print("{0:<9} {1:>9.0f} {2:>12.1f} {3:>9} {4:>10.1f} {5:>6} {6:>6} {7:>6}\n", name,
+		textSize / result.BestSec / 1.0e6, result.LineCount / result.BestSec / 1.0e6, result.LineCount,
+		result.MemoryBytes / 1.0e6, result.VerbosityCounts[int(LogVerbosity::Error)],
+		result.VerbosityCounts[int(LogVerbosity::Warning)], result.VerbosityCounts[int(LogVerbosity::Verbose)]);
+}
+
+// Filters as the log view would set them, timed over the whole log once it's indexed
+static void TimeFilters(const ServerLogStore& store, ServerLogIndex& index)
+{
+	struct NamedFilter
+	{
+		const char* Name;
+		LogFilter Filter;
+	};
+	NamedFilter filters[] = {
+		{"Warnings only", {uint8_t(1 << int(LogVerbosity::Warning)), {}, ""}},
+		{"Errors and warnings", {0x07, {}, ""}},
+		{"Hide LogNetTraffic", {0x7F, {}, ""}},
+		{"Search LogNet", {0x7F, {}, "LogNet"}},
+		{"Search lognet warnings", {uint8_t(1 << int(LogVerbosity::Warning)), {}, "lognet"}},
+		{"Search BP_Pickup_C_3", {0x7F, {}, "BP_Pickup_C_3"}},
+		{"Search ReceivedPacket", {0x7F, {}, "ReceivedPacket"}},
+		{"Search \"Net: Warn\"", {0x7F, {}, "Net: Warn"}},
+		{"Search 14.22.31:5", {0x7F, {}, "14.22.31:5"}},
+	};
+	for (uint16_t category = 1; category < store.GetCategoryCount(); ++category)
+	{
+		if (store.GetCategoryName(category) != "LogNetTraffic") continue;
+		filters[2].Filter.HiddenCategories.assign(category + 1, 0);
+		filters[2].Filter.HiddenCategories[category] = 1;
+	}
+
+	// The first call is what the frame changing the filter pays, the rest is spread over the following ones
+	fmt::print("{0:<24} {1:>9} {2:>9} {3:>9} {4:>7}\n", "Filter", "lines", "first ms", "total ms", "frames");
+	for (const NamedFilter& filter : filters)
+	{
+		const steadyClock::time_point start = steadyClock::now();
+		index.SetFilter(store, filter.Filter);
+		const double firstSeconds = std::chrono::duration<double>(steadyClock::now() - start).count();
+		int frames = 1;
+		for (; index.IsEvaluating(); ++frames)
+		{
+			index.Update(store);
+		}
+		const double seconds = std::chrono::duration<double>(steadyClock::now() - start).count();
+		fmt::print("{0:<24} {1:>9} {2:>9.2f} {3:>9.2f} {4:>7}\n", filter.Name,
+			index.IsFiltering() ? index.GetMatchCount() : store.GetLineCount(), firstSeconds * 1000.0, seconds * 1000.0,
+			frames);
+	}
+	index.SetFilter(store, LogFilter());
+}
+
+static IngestResult RunIndexed(const string& text, const BenchOptions& options)
+{
+	IngestResult result;
+	for (int repeatIt = 0; repeatIt < options.Repeat; ++repeatIt)
+	{
+		ServerLogStore store;
+		ServerLogIndex index;
+		const double seconds = TimeIngest(text, options.ReadSize,
+			[&](const char* data, size_t size)
+			{
+				store.Append(data, size);
+				index.Update(store);
+			});
+		if (repeatIt == 0 || seconds < result.BestSec) result.BestSec = seconds;
+
+		// The word thread shares the CPU with the ingest, what it didn't index by the last read is waited for
+		const steadyClock::time_point waitStart = steadyClock::now();
+		index.WaitForWords();
+		const double waitSeconds = std::chrono::duration<double>(steadyClock::now() - waitStart).count();
+
+		result = {result.BestSec, store.GetLineCount(), store.GetMemoryBytes() + index.GetMemoryBytes()};
+		for (int verbosity = 0; verbosity < 7; ++verbosity)
+		{
+			result.VerbosityCounts[verbosity] = index.GetVerbosityLineCount(LogVerbosity(verbosity));
+		}
+		if (repeatIt + 1 == options.Repeat)
+		{
+			PrintResult("indexed", result, text.size());
+			fmt::print("Words indexed {0:.0f} ms after the last read\n", waitSeconds * 1000.0);
+			TimeFilters(store, index);
+		}
+	}
+	return result;
+}
+
+static IngestResult RunRates(const string& text, const BenchOptions& options)
+{
+	IngestResult result;
+	for (int repeatIt = 0; repeatIt < options.Repeat; ++repeatIt)
+	{
+		ServerLogStore store;
+		ServerLogRates rates;
+		const double seconds = TimeIngest(text, options.ReadSize,
+			[&](const char* data, size_t size)
+			{
+				store.Append(data, size);
+				rates.Update(store);
+			});
+		if (repeatIt == 0 || seconds < result.BestSec) result.BestSec = seconds;
+
+		result = {result.BestSec, store.GetLineCount(), store.GetMemoryBytes() + rates.GetMemoryBytes()};
+		for (int verbosity = 0; verbosity < 7; ++verbosity)
+		{
+			const int series = ServerLogRates::GetVerbositySeries(LogVerbosity(verbosity));
+			result.VerbosityCounts[verbosity] = rates.GetLineCount(series);
+		}
+	}
+	return result;
+}
+
+static bool ParseOptions(int argc, char** argv, BenchOptions& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--megabytes" && hasValue) options.Megabytes = std::stoul(argv[++i]);
+		else if (arg == "--read-size" && hasValue) options.ReadSize = std::stoul(argv[++i]);
+		else if (arg == "--repeat" && hasValue) options.Repeat = std::stoi(argv[++i]);
+		else if (arg == "--command" && hasValue) options.Command = argv[++i];
+		else return false;
+	}
+	return options.Megabytes > 0 && options.ReadSize > 0 && options.Repeat > 0;
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		fmt::print(stderr, "Usage: log_ingest_bench [--megabytes N] [--read-size N] [--repeat N] [--command C]\n");
+		return 1;
+	}
+	if (!options.Command.empty()) return RunCommand(options.Command);
+
+	const string text = GenerateLog(options.Megabytes << 20);
+	fmt::print("Ingesting {0:.1f} MB of server output in {1} byte reads (best of {2})\n", text.size() / 1.0e6,
+		options.ReadSize, options.Repeat);
+	fmt::print("{0:<9} {1:>9} {2:>12} {3:>9} {4:>10} {5:>6} {6:>6} {7:>6}\n", "Design", "MB/s", "Mlines/s", "lines",
+		"memory MB", "errors", "warns", "verb.");
+
+	PrintResult("copy", RunCopy(text, options), text.size());
+	PrintResult("previous", RunPrevious(text, options), text.size());
+	PrintResult("store", RunStore(text, options), text.size());
+	PrintResult("rates", RunRates(text, options), text.size());
+	RunIndexed(text, options);
+	return 0;
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+// StdLib Includes
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Writes procedurally generated RGB frames to disk in the formats the frame analyzer imports.
+// There is no standalone image encoder in the repo, so PNG files are written with stored (uncompressed)
+// deflate blocks. Their decode cost is lower than real captures, use --source to bench those instead.
+namespace synthetic
+{
+	enum class FrameFormat
+	{
+		Png,
+		Tga,
+		Bmp
+	};
+
+	inline const char* GetFormatExtension(FrameFormat format)
+	{
+		switch (format)
+		{
+			case FrameFormat::Png: return ".png";
+			case FrameFormat::Tga: return ".tga";
+			case FrameFormat::Bmp: return ".bmp";
+		}
+		return "";
+	}
+
+	// Static gradient background with a moving block, so consecutive frames are mostly similar
+	inline void GenerateFramePixels(std::vector<uint8_t>& pixels, int width, int height, int frameIndex)
+	{
+		pixels.resize(static_cast<size_t>(width) * height * 3);
+		const int blockSize = height / 8 + 1;
+		const int blockX = (frameIndex * 7) % (width > blockSize ? width - blockSize : 1);
+		const int blockY = (frameIndex * 3) % (height > blockSize ? height - blockSize : 1);
+		for (int y = 0; y < height; ++y)
+		{
+			uint8_t* row = &pixels[static_cast<size_t>(y) * width * 3];
+			const bool blockRow = y >= blockY && y < blockY + blockSize;
+			for (int x = 0; x < width; ++x)
+			{
+				const bool inBlock = blockRow && x >= blockX && x < blockX + blockSize;
+				row[x * 3 + 0] = inBlock ? 255 : static_cast<uint8_t>(x * 255 / width);
+				row[x * 3 + 1] = inBlock ? 64 : static_cast<uint8_t>(y * 255 / height);
+				row[x * 3 + 2] = inBlock ? 32 : static_cast<uint8_t>((x + y) & 0xFF);
+			}
+		}
+	}
+
+	namespace detail
+	{
+		inline uint32_t PngCrc(const uint8_t* data, size_t size, uint32_t crc = 0xFFFFFFFFu)
+		{
+			static uint32_t table[256] = {};
+			if (table[1] == 0)
+			{
+				for (uint32_t n = 0; n < 256; ++n)
+				{
+					uint32_t c = n;
+					for (int k = 0; k < 8; ++k)
+					{
+						c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+					}
+					table[n] = c;
+				}
+			}
+			for (size_t i = 0; i < size; ++i)
+			{
+				crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+			}
+			return crc;
+		}
+
+		inline void PutBE32(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		inline void PutLE16(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+		}
+
+		inline void PutLE32(std::vector<uint8_t>& out, uint32_t value)
+		{
+			PutLE16(out, value & 0xFFFF);
+			PutLE16(out, value >> 16);
+		}
+
+		inline void PutPngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+		{
+			PutBE32(out, static_cast<uint32_t>(data.size()));
+			const size_t typeOffset = out.size();
+			out.insert(out.end(), type, type + 4);
+			out.insert(out.end(), data.begin(), data.end());
+			const uint32_t crc = PngCrc(&out[typeOffset], data.size() + 4) ^ 0xFFFFFFFFu;
+			PutBE32(out, crc);
+		}
+
+		inline void EncodePng(std::vector<uint8_t>& out, const std::vector<uint8_t>& pixels, int width, int height)
+		{
+			static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+			out.insert(out.end(), signature, signature + 8);
+
+			std::vector<uint8_t> header;
+			PutBE32(header, width);
+			PutBE32(header, height);
+			header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bits, RGB, deflate, no filter, no interlace
+			PutPngChunk(out, "IHDR", header);
+
+			// Filter byte (none) per scanline
+			const size_t rowSize = static_cast<size_t>(width) * 3;
+			std::vector<uint8_t> raw;
+			raw.reserve((rowSize + 1) * height);
+			for (int y = 0; y < height; ++y)
+			{
+				raw.push_back(0);
+				raw.insert(raw.end(), pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize);
+			}
+
+			// Zlib stream made of stored blocks
+			std::vector<uint8_t> zlib = {0x78, 0x01};
+			uint32_t adlerA = 1, adlerB = 0;
+			for (size_t offset = 0; offset < raw.size(); offset += 65535)
+			{
+				const size_t blockSize = std::min<size_t>(65535, raw.size() - offset);
+				zlib.push_back(offset + blockSize == raw.size() ? 1 : 0);
+				PutLE16(zlib, static_cast<uint32_t>(blockSize));
+				PutLE16(zlib, static_cast<uint32_t>(~blockSize & 0xFFFF));
+				zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+				for (size_t i = offset; i < offset + blockSize; ++i)
+				{
+					adlerA = (adlerA + raw[i]) % 65521;
+					adlerB = (adlerB + adlerA) % 65521;
+				}
+			}
+			PutBE32(zlib, (adlerB << 16) | adlerA);
+			PutPngChunk(out, "IDAT", zlib);
+			PutPngChunk(out, "IEND", {});
+		}
+
+		inline void EncodeTga(std::vector<uint8_t>& out, const std::vector<uint8_t>& pixels, int width, int height)
+		{
+			// Uncompressed true-color, top-left origin
+			uint8_t header[18] = {0, 0, 2};
+			header[12] = static_cast<uint8_t>(width);
+			header[13] = static_cast<uint8_t>(width >> 8);
+			header[14] = static_cast<uint8_t>(height);
+			header[15] = static_cast<uint8_t>(height >> 8);
+			header[16] = 24;
+			header[17] = 0x20;
+			out.insert(out.end(), header, header + 18);
+			for (size_t i = 0; i < pixels.size(); i += 3)
+			{
+				out.insert(out.end(), {pixels[i + 2], pixels[i + 1], pixels[i]});
+			}
+		}
+
+		inline void EncodeBmp(std::vector<uint8_t>& out, const std::vector<uint8_t>& pixels, int width, int height)
+		{
+			const uint32_t rowSize = (static_cast<uint32_t>(width) * 3 + 3) & ~3u;
+			const uint32_t dataSize = rowSize * height;
+			out.insert(out.end(), {'B', 'M'});
+			PutLE32(out, 54 + dataSize);
+			PutLE32(out, 0);
+			PutLE32(out, 54);
+			PutLE32(out, 40);
+			PutLE32(out, width);
+			PutLE32(out, height);
+			PutLE16(out, 1);
+			PutLE16(out, 24);
+			PutLE32(out, 0);
+			PutLE32(out, dataSize);
+			PutLE32(out, 2835);
+			PutLE32(out, 2835);
+			PutLE32(out, 0);
+			PutLE32(out, 0);
+
+			// Bottom-up BGR rows padded to 4 bytes
+			for (int y = height - 1; y >= 0; --y)
+			{
+				const uint8_t* row = &pixels[static_cast<size_t>(y) * width * 3];
+				for (int x = 0; x < width; ++x)
+				{
+					out.insert(out.end(), {row[x * 3 + 2], row[x * 3 + 1], row[x * 3]});
+				}
+				out.insert(out.end(), rowSize - width * 3, 0);
+			}
+		}
+	} // namespace detail
+
+	inline bool WriteFrame(const std::string& path, FrameFormat format, const std::vector<uint8_t>& pixels,
+		int width, int height)
+	{
+		std::vector<uint8_t> encoded;
+		switch (format)
+		{
+			case FrameFormat::Png: detail::EncodePng(encoded, pixels, width, height); break;
+			case FrameFormat::Tga: detail::EncodeTga(encoded, pixels, width, height); break;
+			case FrameFormat::Bmp: detail::EncodeBmp(encoded, pixels, width, height); break;
+		}
+
+		FILE* file = fopen(path.c_str(), "wb");
+		if (file == nullptr) return false;
+		const size_t written = fwrite(encoded.data(), 1, encoded.size(), file);
+		fclose(file);
+		return written == encoded.size();
+	}
+} // namespace synthetic
@@ -0,0 +1,140 @@
+#ifndef __MAPPEDFILE__H__
+#define __MAPPEDFILE__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace rv
+{
+	/*
+	Read-only memory mapping of a whole file.
+	The mapping is released when the object is destroyed, pointers returned by
+	GetData must not outlive it.
+	*/
+	class MappedFile
+	{
+	  public:
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+		MappedFile(MappedFile&&) = delete;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(MappedFile&&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		inline bool Open(const std::string& path);
+		inline void Close();
+
+		// Hints the OS to read the given range ahead of its use
+		inline void Prefetch(size_t offset, size_t size) const;
+
+		const uint8_t* GetData() const { return data; }
+		size_t GetSize() const { return size; }
+		bool IsOpen() const { return data != nullptr; }
+
+	  private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+#if WIN32
+		HANDLE fileHandle = INVALID_HANDLE_VALUE;
+		HANDLE mappingHandle = nullptr;
+#else
+		int fileDesc = -1;
+#endif
+	};
+
+	inline bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+#if WIN32
+		// Files that are still being appended to (the frame cache) can be mapped as well
+		fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		data = static_cast<const uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		fileDesc = open(path.c_str(), O_RDONLY);
+		if (fileDesc < 0) return false;
+
+		struct stat fileStat;
+		if (fstat(fileDesc, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+		if (mapping == MAP_FAILED)
+		{
+			Close();
+			return false;
+		}
+
+		// Frames are mostly streamed in order, let the kernel read ahead aggressively
+		madvise(mapping, fileStat.st_size, MADV_SEQUENTIAL);
+		data = static_cast<const uint8_t*>(mapping);
+		size = static_cast<size_t>(fileStat.st_size);
+#endif
+		if (data == nullptr) Close();
+		return data != nullptr;
+	}
+
+	inline void MappedFile::Close()
+	{
+#if WIN32
+		if (data != nullptr) UnmapViewOfFile(data);
+		if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		mappingHandle = nullptr;
+		fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+		if (fileDesc >= 0) close(fileDesc);
+		fileDesc = -1;
+#endif
+		data = nullptr;
+		size = 0;
+	}
+
+	inline void MappedFile::Prefetch(size_t offset, size_t length) const
+	{
+		if (data == nullptr || offset >= size) return;
+		if (length > size - offset) length = size - offset;
+#if WIN32
+		WIN32_MEMORY_RANGE_ENTRY range = {const_cast<uint8_t*>(data + offset), length};
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+		// madvise requires a page aligned address
+		const size_t pageMask = static_cast<size_t>(sysconf(_SC_PAGESIZE)) - 1;
+		const size_t alignedOffset = offset & ~pageMask;
+		madvise(const_cast<uint8_t*>(data + alignedOffset), length + (offset - alignedOffset), MADV_WILLNEED);
+#endif
+	}
+} // namespace rv
+
+#endif //!__MAPPEDFILE__H__
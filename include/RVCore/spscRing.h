@@ -0,0 +1,94 @@
+#ifndef __SPSCRING__H__
+#define __SPSCRING__H__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace rv
+{
+	/*
+	Bounded lock-free single-producer/single-consumer ring buffer.
+	One thread at a time may push and one thread at a time may pop, neither side ever blocks
+	the other: TryPush fails when the ring is full and TryPop fails when it is empty.
+	The producer (or consumer) may migrate between threads as long as its calls are ordered by
+	some other synchronization (e.g. a serial taskflow pipe).
+	*/
+	template <typename T>
+	class SpscRing
+	{
+	  public:
+		// Capacity is rounded up to a power of two
+		explicit SpscRing(size_t capacity)
+		{
+			size_t roundedCapacity = 1;
+			while (roundedCapacity < capacity)
+			{
+				roundedCapacity <<= 1;
+			}
+
+			slots.reset(new T[roundedCapacity]);
+			mask = roundedCapacity - 1;
+		}
+		SpscRing(SpscRing&&) = delete;
+		SpscRing(const SpscRing&) = delete;
+		SpscRing& operator=(SpscRing&&) = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		// Producer side, the item is only moved from when it was pushed
+		bool TryPush(T&& item)
+		{
+			const size_t tail = tailIndex.load(std::memory_order_relaxed);
+			if (tail - cachedHead > mask)
+			{
+				// Only touch the consumer cache line when the ring looks full
+				cachedHead = headIndex.load(std::memory_order_acquire);
+				if (tail - cachedHead > mask) return false;
+			}
+
+			slots[tail & mask] = std::move(item);
+			tailIndex.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer side
+		bool TryPop(T& item)
+		{
+			const size_t head = headIndex.load(std::memory_order_relaxed);
+			if (head == cachedTail)
+			{
+				// Only touch the producer cache line when the ring looks empty
+				cachedTail = tailIndex.load(std::memory_order_acquire);
+				if (head == cachedTail) return false;
+			}
+
+			item = std::move(slots[head & mask]);
+			headIndex.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Exact only when called from the producer or the consumer while the other side is idle
+		size_t SizeApprox() const
+		{
+			return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire);
+		}
+		size_t Capacity() const { return mask + 1; }
+
+	  private:
+		static constexpr size_t cacheLineSize = 64;
+
+		// Consumer owned
+		alignas(cacheLineSize) std::atomic<size_t> headIndex = {0};
+		size_t cachedTail = 0;
+
+		// Producer owned
+		alignas(cacheLineSize) std::atomic<size_t> tailIndex = {0};
+		size_t cachedHead = 0;
+
+		alignas(cacheLineSize) std::unique_ptr<T[]> slots;
+		size_t mask = 0;
+	};
+} // namespace rv
+
+#endif //!__SPSCRING__H__
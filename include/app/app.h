@@ -10,6 +10,7 @@
 #include <glad/glad.h>
 
 #include <RVCore/iapp.h>
+#include <app/redrawScheduler.h>
 
 class UE4NetworkTool : public rv::IApp
 {
@@ -41,9 +42,10 @@ class UE4NetworkTool : public rv::IApp
 	}
 
 	void DrawAppScreen(double deltaTime);
+	double GetRedrawDelay() const;
 	GLFWwindow* _window = {nullptr};
+	RedrawScheduler _redrawScheduler;
 	bool _fixedFPS = {true};
-	double _accDeltaTime = 0.033f;
 
 	// Windows
 	class ServerLauncherWindow* _serverLauncherWindow;
@@ -0,0 +1,17 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <cstdint>
+
+// BC1 (DXT1) block compression of RGB frames.
+// Every 4x4 pixel block becomes 8 bytes: two RGB565 endpoints followed by 16 2-bit palette indices.
+// Endpoints come from the (inset) bounding box of the block colors and indices from projecting each
+// pixel onto the endpoint axis. Uses SSE2 where available, the scalar path produces identical blocks.
+constexpr size_t BC1BlockSize = 8;
+
+// Bytes needed to hold a width x height frame, partial blocks at the borders are padded
+size_t GetBC1DataSize(int width, int height);
+
+// Compresses tightly packed RGB888 pixels into BC1 blocks (row-major block order)
+void CompressBC1(const uint8_t* rgbPixels, int width, int height, uint8_t* blocks);
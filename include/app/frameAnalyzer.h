@@ -1,84 +1,155 @@
 #pragma once
 
 // StdLib Includes
+#include <deque>
 #include <string>
 #include <vector>
 
 // Third party dependencies
-#include <taskflow/core/taskflow.hpp>
 #include <taskflow/core/executor.hpp>
 
+// Internal Includes
+#include <app/frameDirectoryWatcher.h>
+#include <app/frameFilmstrip.h>
+#include <app/frameHashIndex.h>
+#include <app/frameLoader.h>
+#include <app/frameResidency.h>
+#include <app/frameStatistics.h>
+#include <app/frameTimeline.h>
+#include <app/frameVideoExporter.h>
+
 // Using directives
 using string = std::string;
 template <typename T>
 using vector = std::vector<T>;
 
-// Used to load image data from disk in parallel
-struct LoadImageJob
-{
-	string ImagePath;
-	void* ImageData = nullptr;
-	int Width, Height, NumComp;
-};
+class FrameDeltaStore;
+struct GLFWwindow;
+struct ImVec2;
+typedef unsigned int ImGuiID;
 
-// Used to flush async gpu write alongside frames
-struct SyncImageUploadJob
+// Frames of one import (e.g. the dedicated server or one of the clients), a contiguous range of the analyzer frames.
+// Streams play back together, aligned by their capture timestamps.
+struct FrameStream
 {
-	SyncImageUploadJob(string path, int w, int h, int bufId, int texId)
-		: ImagePath(path), Width(w), Height(h), PixelBuffId(bufId), TextureId(texId)
-	{
-	}
-
-	string ImagePath;
-	int Width, Height;
-	unsigned int PixelBuffId;
-	unsigned int TextureId;
+	string Name;
+	int FirstFrame = 0;
+	int FrameCount = 0;
+	FrameTimeline Timeline;
+	FrameStatistics LastStatistics; // Of the last frame added, the next one is compared to it
 };
 
-// Used to keep track of and draw loaded frames
-struct FrameTexture
+enum class StreamLayout : int
 {
-	string ImageName;
-	unsigned int TextureId;
-	int Width, Height;
-	float Duration = 0.016f;
+	SideBySide,
+	Grid
 };
 
-struct GLFWwindow;
-typedef unsigned int ImGuiID;
-
 class FrameAnalyzerWindow
 {
   public:
-	FrameAnalyzerWindow(bool isOpen, GLFWwindow* window) : ShouldShow(isOpen), _window(window){};
+	FrameAnalyzerWindow(bool isOpen, GLFWwindow* window);
 	~FrameAnalyzerWindow();
 
 	void DrawMenuBarFileItems();
 	void DrawMenuBarWindowItems();
 	void Draw(ImGuiID dockSpaceId, double deltaTime);
 	void DrawLoadingFramesModal();
+	// Seconds until the window has to be drawn again without any input (loaded frames wake the main loop themselves)
+	double GetRedrawDelay() const;
 
 	bool ShouldShow = false;
 
   private:
+	// Export progress is redrawn this often
+	static constexpr double ExportProgressDelay = 0.1;
+	// Most frames loaded per live batch, all of them fit in the hand-off ring (and the default pixel budget as 4K RGB)
+	// so stopping can wait for the batch without pulling them
+	static constexpr size_t MaxLiveBatchFrames = 16;
+
 	void ImportFrameSnapshots();
+	void WatchSnapshotDirectory();
+	void StopWatchingSnapshots();
+	void UpdateLiveIngest();
+	void PullLiveFrames();
+	void ExportVideo();
+	void DrawVideoExport(float width);
+	void ReportVideoExport();
+	bool AddLoadedFrame(LoadImageJob&& job);
+	void DrawStreamFrame(int streamIndex, ImVec2 canvasSize, bool showName);
+	void DrawChangeHeatmap(const FrameTexture& texture, ImVec2 imageMin, ImVec2 imageMax);
+	void DrawFrameSlider(FrameStream& stream);
+	void DrawFrameStatistics(const FrameStream& stream, float width, float height);
+	void DrawFrameSearch(float width);
+	int64_t GetStreamOffset(const FrameStream& stream) const;
+	int FindStream(int frameIndex) const;
+	void LoadSettings();
+	void StoreSettings();
 
-	tf::Taskflow _taskFlow;
 	tf::Executor _taskExecutor;
+	FrameLoader _frameLoader;
+	FrameResidency _frameResidency;
+	FrameVideoExporter _videoExporter;
+	std::shared_ptr<FrameDeltaStore> _deltaStore;
+	std::shared_ptr<FrameCache> _frameCache;
+	FrameFilmstrip _filmstrip;
 
 	// Queue for OpenGL main-thread texture upload
-	std::mutex _uploadImageLock;
-	std::vector<LoadImageJob> _uploadImageBuff;
 	std::deque<LoadImageJob> _uploadImageDeque;
-	std::queue<SyncImageUploadJob> _syncImageUploadQueue;
-	// Up to 16 simultaneous load image jobs
-	std::array<LoadImageJob, 16> _loadImagePipeData;
 
 	GLFWwindow* _window = nullptr;
 	bool _autoPlay = true;
 	float _playbackSpeed = 100.0f;
-	int _imageOffset = 0;
+	int _imageOffset = 0; // Frame of the primary stream (relative to its first frame)
+
+	// Every stream has its own capture timing, playback follows a shared clock instead of a fixed rate
+	vector<FrameStream> _streams;
+	int _primaryStream = 0;
+	StreamLayout _streamLayout = StreamLayout::SideBySide;
+	vector<int> _streamFrames; // Frame each stream shows at the playback time
+	double _playbackTimeUs = 0.0;
+	int _playbackFrame = -1;
+	bool _showTimeSlider = false;
+
+	int _residentFrames = FrameResidency::DefaultWindowSize;
+	int _pixelBudgetMB = static_cast<int>(PixelBudget::DefaultLimitBytes >> 20);
+	vector<PlaybackHint> _playbackHints; // One per stream
+	string* _settingsEntry = nullptr;
+	bool _firstTimeOpen = true;
 	int _loadFrameIt = 0;
-	vector<string> _loadFramesList;
+
+	// Tile change heatmap overlay
+	bool _showChangeHeatmap = false;
+	int _heatmapFrames = 30;
+	int _heatmapFrame = -1;
+	int _heatmapFrameCount = 0;
+	int _heatmapMaxCount = 0;
+	int _heatmapTilesX = 0, _heatmapTilesY = 0;
+	vector<uint16_t> _heatmapCounts;
+
+	// Perceptual hash queries (similar frames and freeze runs)
+	FrameHashIndex _frameHashes;
+	int _searchMaxDistance = FrameHashIndex::DefaultMaxDistance;
+	int _freezeMinFrames = 10;
+	vector<FrameRun> _searchResults;
+	string _searchSummary;
+
+	// Luminance and changed cells of every frame, plotted under the timeline with the histogram of the frames in view
+	FrameStatisticsSeries _frameStatistics;
+	bool _showStatistics = true;
+	int _statisticsFrameCount = 0; // Frames plotted last time, the view is fitted again when more came in
+	int _histogramFirstFrame = -1, _histogramFrameCount = 0;
+	float _rangeHistogram[LumaHistogramBins] = {};
+
+	// Live ingest of a snapshot directory the game is writing to, its frames go to the last stream
+	FrameDirectoryWatcher _directoryWatcher;
+	vector<string> _livePendingPaths; // Completed files waiting for the loader to finish its current batch
+	int _liveStream = -1;
+	int _liveFailedCount = 0;
+	bool _followLive = true; // Keep the playhead on the newest frame
+
+	bool _videoExportPending = false; // Running or done without having been reported
+
+	bool _showLoadingModal = false;
 	vector<FrameTexture> _textures;
 };
\ No newline at end of file
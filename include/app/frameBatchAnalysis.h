@@ -0,0 +1,37 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Internal Includes
+#include <app/frameHashIndex.h>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// Settings of a headless analysis run ("UE4NetworkTool --analyze ...")
+struct FrameBatchOptions
+{
+	vector<string> Inputs;	  // Capture directories or packed sequences, each one analyzed as a stream of its own
+	string ReportPath;		  // JSON report destination, standard output when empty
+	size_t ThreadCount = 0;	  // Pipeline workers, every hardware thread when zero
+	size_t BudgetMB = 0;	  // Decoded pixels in flight, PixelBudget's default when zero
+	int FreezeMaxDistance = FrameHashIndex::DefaultMaxDistance;
+	float FreezeMaxChange = 0.0f; // Tile change ratio a frame may still have and extend a freeze run
+	int FreezeMinFrames = 10;
+};
+
+// Whether the command line asks for a headless analysis instead of the application window
+bool IsFrameBatchCommand(int argc, char** argv);
+bool ParseFrameBatchArguments(int argc, char** argv, FrameBatchOptions& options, string* error = nullptr);
+void PrintFrameBatchUsage(const string& error);
+
+// Loads every input through the FrameLoader pipeline without any window or Graphics API, and writes a report of
+// the per-frame change ratio, freeze runs, duplicate frames and timestamp gaps of each one.
+// Returns the process exit code: 0 on success, 1 when an input or the report couldn't be opened, 2 when frames
+// failed to decode.
+int RunFrameBatchAnalysis(const FrameBatchOptions& options);
@@ -0,0 +1,126 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Internal Includes
+#include <RVCore/mappedFile.h>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// Identifies the bytes a frame was decoded from. Frames of packed sequences use the size and write time
+// of their container, so re-packing a capture invalidates all of its frames.
+struct FrameFingerprint
+{
+	uint64_t PathHash = 0;
+	uint64_t FileSize = 0; // Zero when the file couldn't be inspected (never cached)
+	int64_t WriteTime = 0;
+};
+
+// Processed frame cache, an append-only pair of files in the cache directory:
+// frames.dat holds the BC1 blocks (then the thumbnail blocks and packed statistics) of every cached frame back to back,
+// frames.idx holds a FrameCacheHeader followed by one FrameCacheEntry per frame, written after its data.
+// A frame added again (its thumbnail was missing) supersedes the earlier entry.
+constexpr char FrameCacheMagic[4] = {'U', 'F', 'C', 'I'};
+constexpr uint32_t FrameCacheVersion = 3;
+
+struct FrameCacheHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t ThumbnailWidth; // Cached thumbnails are dropped along with everything else when the size changes
+	uint32_t ThumbnailHeight;
+};
+
+struct FrameCacheEntry
+{
+	uint64_t PathHash;
+	uint64_t FileSize;
+	int64_t WriteTime;
+	uint64_t Offset; // Offset of the frame blocks in frames.dat, the thumbnail blocks and statistics follow them
+	uint32_t BlocksSize;
+	uint32_t ThumbnailSize; // Zero when the frame was cached without a thumbnail
+	uint32_t Width;
+	uint32_t Height;
+	uint64_t PerceptualHash;
+	uint32_t StatisticsSize; // Zero when the frame was cached without statistics (see PackFrameStatistics)
+	uint32_t Reserved;
+};
+
+static_assert(sizeof(FrameCacheHeader) == 16, "FrameCacheHeader layout changed!");
+static_assert(sizeof(FrameCacheEntry) == 64, "FrameCacheEntry layout changed!");
+
+// Frames read back from the cache skip decoding, compression, thumbnails and hashing: a cache hit is a copy out of
+// the memory mapped frames.dat, which the OS reads ahead sequentially as frames are imported in order.
+// Find and the data getters are safe to call from any number of threads, while Add calls are serialized by the
+// caller (the frame loader adds from its serial hand-off stage). Frames added are only found after Refresh.
+class FrameCache
+{
+  public:
+	// The cache starts over the next time it is opened past this size
+	static constexpr uint64_t DefaultLimitBytes = uint64_t(4) << 30;
+
+	FrameCache() = default;
+	~FrameCache();
+	FrameCache(FrameCache&&) = delete;
+	FrameCache(const FrameCache&) = delete;
+	FrameCache& operator=(FrameCache&&) = delete;
+	FrameCache& operator=(const FrameCache&) = delete;
+
+	// Creates the directory if needed, an unreadable or outdated cache is cleared
+	bool Open(const string& directory, string* error = nullptr);
+	void Close();
+	// Deletes every cached frame
+	void Clear();
+	// Makes the frames added since Open (or the last Refresh) visible, only call while nothing is looked up
+	void Refresh();
+
+	const FrameCacheEntry* Find(const FrameFingerprint& fingerprint) const;
+	const uint8_t* GetBlocks(const FrameCacheEntry& entry) const { return _data.GetData() + entry.Offset; }
+	const uint8_t* GetThumbnail(const FrameCacheEntry& entry) const { return GetBlocks(entry) + entry.BlocksSize; }
+	const uint8_t* GetStatistics(const FrameCacheEntry& entry) const
+	{
+		return GetThumbnail(entry) + entry.ThumbnailSize;
+	}
+
+	// Returns false if the frame couldn't be written (or the cache is full)
+	bool Add(const FrameFingerprint& fingerprint, const uint8_t* blocks, size_t blocksSize, const uint8_t* thumbnail,
+		size_t thumbnailSize, const uint8_t* statistics, size_t statisticsSize, int width, int height,
+		uint64_t perceptualHash);
+
+	bool IsOpen() const { return _indexWriter != nullptr; }
+	size_t GetFrameCount() const { return _entries.size(); }
+	uint64_t GetDataSize() const { return _dataSize; }
+	const string& GetDirectory() const { return _directory; }
+	void SetLimit(uint64_t limitBytes) { _limitBytes = limitBytes; }
+
+	// Cache directory of the application, in the temporary directory
+	static string GetDefaultDirectory();
+	// Fingerprints the frame stored in filePath, key tells frames of the same file apart (the frame image path)
+	static bool GetFingerprint(const string& filePath, const string& key, FrameFingerprint& fingerprint);
+
+  private:
+	bool OpenWriters();
+	void ReadIndex();
+
+	string _directory;
+	string _dataPath;
+	string _indexPath;
+	uint64_t _limitBytes = DefaultLimitBytes;
+
+	// Frames visible to Find, frames.dat is mapped up to the last Refresh
+	rv::MappedFile _data;
+	std::unordered_map<uint64_t, FrameCacheEntry> _entries;
+	uint64_t _indexReadBytes = 0;
+
+	FILE* _dataWriter = nullptr;
+	FILE* _indexWriter = nullptr;
+	uint64_t _dataSize = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <vector>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+// In-memory store of a BC1 frame sequence, delta encoded by tiles.
+// Frames are split in tiles of TileBlocks x TileBlocks BC1 blocks (16x16 pixels). Keyframes keep all of
+// their blocks, other frames only keep the tiles that differ from their keyframe, so any frame is rebuilt
+// from its keyframe plus one delta (no chains to walk when scrubbing). Captures of network sessions are
+// mostly static, which makes deltas a small fraction of a frame.
+// Every frame also keeps a mask of the tiles that changed since the previous frame, used for heatmaps.
+// Frames are appended by a single writer while any number of threads read them.
+class FrameDeltaStore
+{
+  public:
+	static constexpr int TileBlocks = 4;
+	static constexpr int TileSize = TileBlocks * 4; // In pixels
+	static constexpr int DefaultKeyframeInterval = 64;
+
+	explicit FrameDeltaStore(int keyframeInterval = DefaultKeyframeInterval);
+
+	// Appends a frame in sequence order and returns its index
+	int AddFrame(const uint8_t* bc1Blocks, int width, int height);
+	// Rebuilds the BC1 blocks of a frame, output must hold GetBC1DataSize(width, height) bytes
+	bool DecodeFrame(int frameIndex, uint8_t* bc1Blocks) const;
+	// Adds how many times each tile changed over the given frames (counts sized to the tile grid of lastFrame)
+	bool AccumulateChanges(int firstFrame, int lastFrame, vector<uint16_t>& counts, int& tilesX, int& tilesY) const;
+	void Clear();
+
+	int GetFrameCount() const;
+	bool GetFrameSize(int frameIndex, int& width, int& height) const;
+	// Ratio of tiles that changed since the previous frame
+	float GetChangeRatio(int frameIndex) const;
+	size_t GetStoredBytes() const;	// Bytes held by keyframes and deltas
+	size_t GetEncodedBytes() const; // Bytes the same frames take as plain BC1
+
+  private:
+	struct StoredFrame
+	{
+		int Width, Height;
+		int KeyframeIndex;			 // Itself for keyframes
+		vector<uint8_t> Blocks;		 // Keyframes: every block, deltas: changed tiles packed in Tiles order
+		vector<uint32_t> Tiles;		 // Tiles that differ from the keyframe (deltas only)
+		vector<uint64_t> ChangeMask; // Tiles that differ from the previous frame
+		uint32_t ChangedTileCount = 0;
+	};
+
+	int _keyframeInterval;
+	mutable std::shared_mutex _lock;
+	std::deque<StoredFrame> _frames;
+	vector<uint8_t> _previousBlocks; // Last added frame, only touched by the writer
+	size_t _storedBytes = 0;
+	size_t _encodedBytes = 0;
+};
+
+// Ratio of the tiles (as split by FrameDeltaStore) that differ between two BC1 frames of the same size,
+// for consumers that only need the change ratio and don't keep the frames
+float GetTileChangeRatio(const uint8_t* bc1Blocks, const uint8_t* previousBc1Blocks, int width, int height);
@@ -0,0 +1,94 @@
+#pragma once
+
+// StdLib Includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// Tails a snapshot directory while the game writes to it, reporting every new frame file once it is complete.
+// On Linux files are reported as soon as inotify sees them closed after writing (or moved in), elsewhere (or when
+// inotify is unavailable) the directory is polled and a file is reported once its size held still for DebounceMs.
+// Files already in the directory when watching starts are not reported, unless they are still being written (their
+// size changes before it held still for DebounceMs). When inotify drops events (its queue overflowed), the directory
+// is scanned for the files they were about.
+// Watching runs on a thread of its own, ready frames are pulled from any other thread.
+class FrameDirectoryWatcher
+{
+  public:
+	static constexpr int PollIntervalMs = 30;
+	static constexpr int DebounceMs = 60;
+
+	FrameDirectoryWatcher() = default;
+	~FrameDirectoryWatcher();
+	FrameDirectoryWatcher(FrameDirectoryWatcher&&) = delete;
+	FrameDirectoryWatcher(const FrameDirectoryWatcher&) = delete;
+	FrameDirectoryWatcher& operator=(FrameDirectoryWatcher&&) = delete;
+	FrameDirectoryWatcher& operator=(const FrameDirectoryWatcher&) = delete;
+
+	// Stops watching the previous directory (if any), returns false if the directory can't be watched
+	bool Start(const string& directory, string* error = nullptr);
+	void Stop();
+
+	// Moves the frames completed since the last call into framePaths, in the order they were completed
+	size_t PullReadyFrames(vector<string>& framePaths);
+	// Called on the watching thread whenever a frame is ready, only change it while not watching
+	void SetReadyCallback(std::function<void()> onReady) { _onReady = std::move(onReady); }
+
+	bool IsWatching() const { return _thread.joinable(); }
+	bool IsPolling() const { return _polling; }
+	const string& GetDirectory() const { return _directory; }
+
+	// Whether the file name has one of the image extensions frames are imported from
+	static bool IsFrameFileName(const string& fileName);
+
+  private:
+	using steadyClock = std::chrono::steady_clock;
+
+	// What a directory scan looks for
+	enum class ScanKind
+	{
+		Initial,	 // Files already there when watching starts
+		NewFiles,	 // Every file not reported yet (polling, or after inotify dropped events)
+		PendingFiles // Only the files seen before, until their size holds still
+	};
+
+	// A file seen by a scan that is not reported (or known) yet
+	struct PendingFile
+	{
+		uintmax_t Size;
+		steadyClock::time_point StableSince;
+		steadyClock::time_point LastSeen;
+		bool Initial; // There when watching started and not written since, known without being reported
+	};
+
+	void NotifyLoop();
+	void PollLoop();
+	void ScanDirectory(ScanKind scanKind);
+	void MarkReady(const string& framePath);
+
+	string _directory;
+	std::thread _thread;
+	std::atomic<bool> _stopRequested = {false};
+	bool _polling = false;
+	int _notifyFd = -1;
+
+	// Only touched by the watching thread
+	std::unordered_map<string, PendingFile> _pendingFiles;
+	std::unordered_set<string> _knownFiles;
+
+	std::mutex _readyLock;
+	vector<string> _readyFrames;
+	std::function<void()> _onReady;
+};
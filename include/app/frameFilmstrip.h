@@ -0,0 +1,44 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <vector>
+
+// Internal Includes
+#include <app/thumbnail.h>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+// Timeline strip of frame thumbnails drawn under the frame viewer.
+// Thumbnails are block compressed during import and packed into a few large atlas textures, and the
+// strip is virtualized: only thumbnails inside the visible range emit draw commands.
+class FrameFilmstrip
+{
+  public:
+	static constexpr int AtlasSize = 4096;
+	static constexpr float ThumbnailSpacing = 2.0f;
+
+	FrameFilmstrip() = default;
+	~FrameFilmstrip();
+	FrameFilmstrip(FrameFilmstrip&&) = delete;
+	FrameFilmstrip(const FrameFilmstrip&) = delete;
+	FrameFilmstrip& operator=(FrameFilmstrip&&) = delete;
+	FrameFilmstrip& operator=(const FrameFilmstrip&) = delete;
+
+	// Uploads the BC1 thumbnail of a frame into its atlas slot (must be called from the GL thread)
+	void AddThumbnail(int frameIndex, const vector<uint8_t>& bc1Thumbnail);
+	// Draws the strip of frameCount frames starting at firstFrame with the given height, returns true when a
+	// thumbnail was clicked (frameIndex, relative to firstFrame, is updated)
+	bool Draw(const char* id, float height, int firstFrame, int frameCount, int& frameIndex);
+	void Clear();
+
+  private:
+	static constexpr int ThumbnailsPerRow = AtlasSize / ThumbnailWidth;
+	static constexpr int ThumbnailsPerAtlas = ThumbnailsPerRow * (AtlasSize / ThumbnailHeight);
+
+	vector<unsigned int> _atlasTextures;
+	vector<bool> _hasThumbnail;
+	int _followedFrame = -1;
+};
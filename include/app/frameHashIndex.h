@@ -0,0 +1,46 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <vector>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+// Difference hash (dHash) of tightly packed RGB888 pixels: the frame is box filtered down to 9x8 luminance
+// samples and every bit tells whether a sample is brighter than its right neighbour. Frames that look alike
+// end up a few bits apart, whatever their resolution or compression artifacts.
+uint64_t ComputePerceptualHash(const uint8_t* rgbPixels, int width, int height);
+
+// Number of differing bits between two perceptual hashes
+int GetHashDistance(uint64_t lhs, uint64_t rhs);
+
+// Inclusive range of consecutive frames
+struct FrameRun
+{
+	int FirstFrame;
+	int LastFrame;
+};
+
+// Perceptual hashes of every imported frame, kept as one flat array (8 bytes per frame) so the queries are
+// plain linear popcount scans: 100k frames fit in under 1 MB and are scanned in well under a millisecond.
+class FrameHashIndex
+{
+  public:
+	static constexpr int DefaultMaxDistance = 4;
+
+	void SetHash(int frameIndex, uint64_t hash);
+	uint64_t GetHash(int frameIndex) const { return _hashes[frameIndex]; }
+	int GetFrameCount() const { return static_cast<int>(_hashes.size()); }
+	void Clear() { _hashes.clear(); }
+
+	// Frames whose hash is within maxDistance bits of the given one, in frame order
+	void FindSimilar(uint64_t hash, int maxDistance, vector<int>& frames) const;
+	// Runs of at least minLength consecutive frames (among frameCount frames from firstFrame), each within
+	// maxDistance bits of the run's first frame
+	void FindFreezeRuns(int firstFrame, int frameCount, int maxDistance, int minLength, vector<FrameRun>& runs) const;
+
+  private:
+	vector<uint64_t> _hashes;
+};
@@ -0,0 +1,274 @@
+#pragma once
+
+// StdLib Includes
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Third party dependencies
+#include <taskflow/core/taskflow.hpp>
+#include <taskflow/core/executor.hpp>
+#include <taskflow/algorithm/pipeline.hpp>
+
+// Internal Includes
+#include <RVCore/spscRing.h>
+#include <app/frameCache.h>
+#include <app/frameStatistics.h>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+class FrameDeltaStore;
+class FrameSequenceFile;
+
+// Where the encoded bytes of a frame live: a loose image file or an entry of a packed frame sequence.
+// Sequence frames get "<container path>/<frame file name>" as their image path.
+struct FrameSource
+{
+	string ImagePath;
+	std::shared_ptr<const FrameSequenceFile> Sequence;
+	uint32_t SequenceIndex = 0;
+	int64_t TimestampUs = -1; // Capture time in microseconds, -1 when unknown (see FrameTimestampResolver)
+};
+
+// Bounds the bytes of decoded pixels alive at once. Producers block in Acquire until consumers
+// release enough pixels, but a frame is always let through when nothing is held (so oversized
+// frames can't stall the pipeline).
+class PixelBudget
+{
+  public:
+	static constexpr size_t DefaultLimitBytes = size_t(512) << 20;
+
+	explicit PixelBudget(size_t limitBytes = DefaultLimitBytes) : _limitBytes(limitBytes) {}
+
+	// Blocks until the bytes fit, returns the time spent waiting in nanoseconds
+	uint64_t Acquire(size_t bytes);
+	// Charges bytes without waiting (used to correct estimates once the real size is known)
+	void Charge(size_t bytes);
+	void Release(size_t bytes);
+
+	void SetLimit(size_t limitBytes);
+	size_t GetLimit() const { return _limitBytes; }
+	size_t GetUsedBytes() const { return _usedBytes; }
+	size_t GetPeakBytes() const { return _peakBytes; }
+	bool IsWaiting() const { return _waitingCount > 0; }
+	void ResetPeak() { _peakBytes = _usedBytes.load(); }
+
+  private:
+	void UpdatePeak(size_t usedBytes);
+
+	std::mutex _lock;
+	std::condition_variable _released;
+	std::atomic<size_t> _limitBytes;
+	std::atomic<size_t> _usedBytes = {0};
+	std::atomic<size_t> _peakBytes = {0};
+	std::atomic<int> _waitingCount = {0};
+};
+
+// Recycles the pixels of decoded frames. Frames of a capture share their size, so the buffer the consumer releases
+// is the next one a decoder acquires and steady state loading allocates no pixel memory at all.
+// Released buffers are kept per size, up to the retain limit in total. Thread safe.
+class PixelBufferPool
+{
+  public:
+	static constexpr size_t DefaultRetainLimitBytes = size_t(128) << 20;
+
+	// Pool every LoadImageJob::ImageData comes from (see FrameLoader::ReleaseImageData)
+	static PixelBufferPool& GetShared();
+
+	PixelBufferPool() = default;
+	~PixelBufferPool();
+	PixelBufferPool(PixelBufferPool&&) = delete;
+	PixelBufferPool(const PixelBufferPool&) = delete;
+	PixelBufferPool& operator=(PixelBufferPool&&) = delete;
+	PixelBufferPool& operator=(const PixelBufferPool&) = delete;
+
+	uint8_t* Acquire(size_t size);
+	// Size must be the one the buffer was acquired with
+	void Release(uint8_t* buffer, size_t size);
+	// Frees every retained buffer (e.g. once an import is done)
+	void Trim();
+
+	size_t GetRetainedBytes() const { return _retainedBytes; }
+	uint64_t GetAllocationCount() const { return _allocationCount; }
+	uint64_t GetReuseCount() const { return _reuseCount; }
+
+  private:
+	std::mutex _lock;
+	std::unordered_map<size_t, vector<uint8_t*>> _freeBuffers;
+	std::atomic<size_t> _retainedBytes = {0};
+	std::atomic<uint64_t> _allocationCount = {0};
+	std::atomic<uint64_t> _reuseCount = {0};
+};
+
+// Layout of LoadImageJob::ImageData
+enum class FramePixelFormat : uint8_t
+{
+	RGB8, // Tightly packed RGB, as decoded
+	BC1	  // BC1 (DXT1) blocks, compressed right after decoding
+};
+
+// Used to load image data from disk in parallel
+struct LoadImageJob
+{
+	FrameSource Source;
+	void* ImageData = nullptr; // Acquired from PixelBufferPool::GetShared()
+	int Width, Height, NumComp;
+	FramePixelFormat Format = FramePixelFormat::RGB8;
+	size_t ImageDataSize = 0;
+	int DeltaFrameIndex = -1; // Index in the delta store the frame was appended to (if any)
+	vector<uint8_t> Thumbnail; // BC1 blocks of the timeline thumbnail (if requested)
+	uint64_t PerceptualHash = 0; // See ComputePerceptualHash (if requested)
+	FrameStatistics Statistics;	 // See MeasureFrameStatistics (if requested)
+	FrameFingerprint Fingerprint; // Frame cache key, set when the loader has a frame cache
+	bool Cached = false;		  // Read back from the frame cache instead of decoded
+
+	// Budget the pixels were charged to (if any), returned by FrameLoader::ReleaseImageData
+	PixelBudget* Budget = nullptr;
+	size_t BudgetBytes = 0;
+};
+
+// What DecodeFrameSource produces besides the frame pixels
+struct FrameDecodeOptions
+{
+	FramePixelFormat Format = FramePixelFormat::BC1;
+	bool Thumbnail = false; // Downscale a ThumbnailWidth x ThumbnailHeight BC1 thumbnail
+	bool PerceptualHash = false; // Hash the frame (its thumbnail sized downscale) for similarity queries
+	bool Statistics = false;	 // Measure the luminance statistics of the frame
+	std::atomic<uint64_t>* CompressNs = nullptr;
+	std::atomic<uint64_t>* ThumbnailNs = nullptr;
+	std::atomic<uint64_t>* HashNs = nullptr;
+	std::atomic<uint64_t>* StatisticsNs = nullptr;
+};
+
+// Accumulated timings (in nanoseconds) of every stage of the loading pipeline.
+// Counters are only ever incremented, call Reset() before starting a new measurement.
+struct FrameLoaderStats
+{
+	std::atomic<uint64_t> EmitNs = {0};		// Serial token emission stage
+	std::atomic<uint64_t> DecodeNs = {0};	// Parallel image decoding stage (compression included)
+	std::atomic<uint64_t> CompressNs = {0}; // Block compression part of the decoding stage
+	std::atomic<uint64_t> ThumbnailNs = {0}; // Thumbnail downscale and compression part of the decoding stage
+	std::atomic<uint64_t> HashNs = {0};		 // Perceptual hash part of the decoding stage
+	std::atomic<uint64_t> StatisticsNs = {0}; // Luminance statistics part of the decoding stage
+	std::atomic<uint64_t> CacheNs = {0};	 // Frame cache lookups and reads part of the decoding stage
+	std::atomic<uint64_t> HandOffNs = {0};	// Serial hand-off stage (ring full stalls included)
+	std::atomic<uint64_t> RingFullNs = {0}; // Time the hand-off waited for the consumer to free ring slots
+	std::atomic<uint64_t> BudgetWaitNs = {0}; // Time the emit stage was throttled by the pixel budget
+	std::atomic<uint64_t> FramesDecoded = {0};
+	std::atomic<uint64_t> FramesFailed = {0};
+	std::atomic<uint64_t> FramesCached = {0}; // Frames read back from the frame cache (also counted as decoded)
+	std::atomic<uint64_t> DecodedBytes = {0};
+
+	void Reset();
+};
+
+// Loads a list of image files from disk through a three-stage taskflow pipeline:
+// serial path emission -> parallel decoding (and block compression) -> serial hand-off to the consumer thread.
+// The hand-off is a lock-free single-producer/single-consumer ring, the serial stage is its only
+// producer and the consumer thread (render loop) its only consumer.
+// It has no Graphics API dependencies, the consumer is responsible for uploading the
+// pulled frames and releasing their pixels with ReleaseImageData.
+// Emission waits on the pixel budget, so decoders never run further ahead of the consumer
+// than the budget allows, no matter how many frames are loaded.
+class FrameLoader
+{
+  public:
+	static constexpr size_t MinPipelineLines = 16; // Raised to the worker count on larger machines
+	// Frames handed off between two pulls of the consumer (a redraw), pixels in flight are bounded by the budget
+	static constexpr size_t HandOffCapacity = 2048;
+
+	explicit FrameLoader(tf::Executor& executor);
+	~FrameLoader();
+	FrameLoader(FrameLoader&&) = delete;
+	FrameLoader(const FrameLoader&) = delete;
+	FrameLoader& operator=(FrameLoader&&) = delete;
+	FrameLoader& operator=(const FrameLoader&) = delete;
+
+	// Starts loading the given frames asynchronously, returns false if a load is already running
+	bool Load(vector<FrameSource> frameSources);
+	// Blocks until every frame went through the pipeline
+	void Wait();
+	// Stops emitting frames and drops whatever is decoded until the running load returns. Frames the
+	// consumer already pulled must be released first, or a throttled pipeline never gets to stop.
+	void Cancel();
+
+	// Moves up to maxCount decoded frames into the consumer queue, never blocks.
+	// Must always be called from the same thread (or calls ordered by the caller).
+	size_t PullLoadedFrames(std::deque<LoadImageJob>& uploadDeque, size_t maxCount = SIZE_MAX);
+	// Gives the pixels back to the shared pixel buffer pool and their bytes back to the budget they were charged to
+	static void ReleaseImageData(LoadImageJob& job);
+
+	// Expands the user selected paths into frame sources, packed sequences are opened and mapped
+	static bool ResolveFrameSources(const vector<string>& paths, vector<FrameSource>& frameSources,
+		string* error = nullptr);
+	// Decodes a single frame into the requested pixel format, safe to call from any thread
+	static bool DecodeFrameSource(const FrameSource& source, LoadImageJob& job,
+		const FrameDecodeOptions& options = FrameDecodeOptions());
+
+	bool IsLoading() const { return _handedOffCount < _loadFramesList.size(); }
+	size_t GetFrameCount() const { return _loadFramesList.size(); }
+	size_t GetHandedOffCount() const { return _handedOffCount; }
+	size_t GetPipelineLines() const { return _loadImagePipeData.size(); }
+	FrameLoaderStats& GetStats() { return _stats; }
+	PixelBudget& GetPixelBudget() { return _pixelBudget; }
+	// Format handed off frames are decoded to, only change it while not loading
+	void SetPixelFormat(FramePixelFormat format) { _pixelFormat = format; }
+	FramePixelFormat GetPixelFormat() const { return _pixelFormat; }
+	// Whether handed off frames carry a timeline thumbnail, only change it while not loading
+	void SetMakeThumbnails(bool makeThumbnails) { _makeThumbnails = makeThumbnails; }
+	// Whether handed off frames carry their luminance statistics, only change it while not loading
+	void SetMeasureStatistics(bool measureStatistics) { _measureStatistics = measureStatistics; }
+	// Block compressed frames are appended (in order) to the delta store by the hand-off stage
+	void SetDeltaStore(std::shared_ptr<FrameDeltaStore> deltaStore) { _deltaStore = std::move(deltaStore); }
+	// Block compressed frames found in the cache skip decoding, the ones that are not get added to it
+	// (in order) by the hand-off stage. Only change it while not loading.
+	void SetFrameCache(std::shared_ptr<FrameCache> frameCache) { _frameCache = std::move(frameCache); }
+	// Called by the hand-off stage (on a worker thread) after every frame handed off, e.g. to wake the consumer up.
+	// Only change it while not loading.
+	void SetHandOffCallback(std::function<void()> onHandOff) { _onHandOff = std::move(onHandOff); }
+
+  private:
+	void EmitStage(tf::Pipeflow& pf);
+	void DecodeStage(tf::Pipeflow& pf);
+	void HandOffStage(tf::Pipeflow& pf);
+	bool ReadCachedFrame(LoadImageJob& job);
+	void DropHandedOffFrames();
+	void NotifyRingSlotsFreed();
+
+	tf::Executor& _executor;
+	tf::Taskflow _taskFlow;
+	tf::Pipeline<tf::Pipe<>, tf::Pipe<>, tf::Pipe<>> _loadImagePipeline;
+	tf::Future<void> _loadHandle;
+	FrameLoaderStats _stats;
+	PixelBudget _pixelBudget;
+	std::atomic<size_t> _estimatedFrameBytes = {0};
+	std::atomic<bool> _cancelRequested = {false};
+	FramePixelFormat _pixelFormat = FramePixelFormat::BC1;
+	bool _makeThumbnails = false;
+	bool _measureStatistics = false;
+	vector<uint8_t> _packedStatistics; // Scratch of the hand-off stage, for the frame cache
+	std::shared_ptr<FrameDeltaStore> _deltaStore;
+	std::shared_ptr<FrameCache> _frameCache;
+	std::function<void()> _onHandOff;
+
+	// Queue for main-thread consumption, the hand-off stage sleeps while it is full until the consumer frees slots
+	rv::SpscRing<LoadImageJob> _uploadImageRing;
+	std::atomic<size_t> _handedOffCount = {0};
+	std::mutex _ringFullLock;
+	std::condition_variable _ringSlotsFreed;
+	std::atomic<bool> _ringFullWaiting = {false};
+
+	// One load image job per pipeline line
+	vector<LoadImageJob> _loadImagePipeData;
+	vector<FrameSource> _loadFramesList;
+};
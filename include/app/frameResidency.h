@@ -0,0 +1,158 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Third party dependencies
+#include <taskflow/core/executor.hpp>
+
+// Internal Includes
+#include <app/frameLoader.h>
+#include <app/frameTextureArray.h>
+#include <app/pixelUploadRing.h>
+
+class FrameDeltaStore;
+
+// Used to flush async gpu write alongside frames
+struct SyncImageUploadJob
+{
+	SyncImageUploadJob(int frame, FramePixelFormat format, size_t size, int slot, FrameLayer layer)
+		: FrameIndex(frame), Format(format), DataSize(size), UploadSlot(slot), Layer(layer)
+	{
+	}
+
+	int FrameIndex;
+	FramePixelFormat Format;
+	size_t DataSize;
+	int UploadSlot; // Slot of the upload ring the pixels were staged in
+	FrameLayer Layer;
+};
+
+// Used to keep track of and draw loaded frames
+struct FrameTexture
+{
+	string ImageName;
+	FrameSource Source;
+	FrameLayer Layer; // No texture while the frame is not resident in GPU memory
+	int Width, Height;
+	int DeltaFrameIndex = -1; // Index in the delta store, when the frame can be rebuilt from memory
+};
+
+// Where a viewer is heading, used to decide which frames should be resident
+struct PlaybackHint
+{
+	int Playhead = 0;
+	int Direction = 1; // 1 forward, -1 backward, 0 paused
+	int Stride = 1;	   // Frames skipped per step (Shift skips by 10)
+	float Speed = 1.0f; // Playback speed multiplier
+
+	// Frames the playhead wraps around in (the stream it plays), every frame when FrameCount is negative
+	int FirstFrame = 0;
+	int FrameCount = -1;
+};
+
+// Keeps only a window of frames around the playheads resident in GPU memory (one playhead per stream, sharing
+// the window).
+// Frames out of the window are evicted in least recently used order and frames ahead of the playhead are rebuilt
+// on demand from the delta store (or decoded from disk / the mapped frame sequence when they aren't in it)
+// and uploaded through a fixed ring of pixel buffer objects (staging stops while every slot is waiting to sync)
+// into layers of texture array chunks.
+class FrameResidency
+{
+  public:
+	static constexpr int DefaultWindowSize = 256;
+	static constexpr int MaxDecodesInFlight = 16;
+	static constexpr int MaxStagesPerUpdate = 32;
+	// Block compressed frames sync with a plain copy, RGB frames copy 6 times the bytes
+	static constexpr int MaxSyncCostPerUpdate = 32;
+	static constexpr int RGBSyncCost = 6;
+
+	FrameResidency(tf::Executor& executor, vector<FrameTexture>& frames);
+	~FrameResidency();
+	FrameResidency(FrameResidency&&) = delete;
+	FrameResidency(const FrameResidency&) = delete;
+	FrameResidency& operator=(FrameResidency&&) = delete;
+	FrameResidency& operator=(const FrameResidency&) = delete;
+
+	// Offers pixels decoded by the import pipeline, they are only uploaded if the frame ends up in the window
+	void OfferDecodedFrame(int frameIndex, LoadImageJob&& job);
+	// Plans the window around the playheads, uploads finished decodes and requests the missing frames
+	void Update(const vector<PlaybackHint>& hints);
+	// Returns the layer of the closest resident frame at or before frameIndex (no texture if there is none), the
+	// search wraps around inside the frames of the hint
+	FrameLayer AcquireTexture(const PlaybackHint& hint, int frameIndex, int& shownFrameIndex);
+	// Releases every texture, pending decodes are discarded when they complete
+	void Clear();
+
+	void SetDeltaStore(std::shared_ptr<const FrameDeltaStore> deltaStore) { _deltaStore = std::move(deltaStore); }
+	void SetWindowSize(int windowSize);
+	int GetWindowSize() const { return _windowSize; }
+	int GetResidentCount() const { return _textureCount; }
+	int GetTextureChunkCount() const { return _textureArrays.GetChunkCount(); }
+	int GetDecodesInFlight() const { return _decodesInFlight; }
+	// Nothing is being decoded, staged or uploaded: the resident frames only change when the playheads move
+	bool IsSettled() const { return _decodesInFlight == 0 && _readyJobs.empty() && _syncImageUploadQueue.empty(); }
+
+  private:
+	enum class FrameState : uint8_t
+	{
+		NotResident,
+		Decoding, // Being decoded or waiting to be staged
+		Uploading,
+		Resident,
+		Failed
+	};
+
+	// Shared with async decode tasks, so they can complete after the residency is cleared or gone
+	struct DecodeResults
+	{
+		~DecodeResults();
+
+		std::mutex Lock;
+		vector<std::pair<int, LoadImageJob>> Jobs;
+	};
+
+	void ReserveFrameSlots();
+	void PlanWindow(const vector<PlaybackHint>& hints);
+	void PlanHintWindow(const PlaybackHint& hint, int desiredCount, vector<int>& desiredFrames);
+	void CollectDecodes();
+	void SyncUploads();
+	void StageUploads();
+	void RequestDecodes();
+	void MakeResident(int frameIndex, const FrameLayer& layer);
+	FrameLayer AllocateTexture(int width, int height, FramePixelFormat format);
+	FrameLayer Evict(int frameIndex);
+	int FindEvictionCandidate(bool allowDesired) const;
+	bool IsDesired(int frameIndex) const { return _desiredEpoch[frameIndex] == _planEpoch; }
+
+	tf::Executor& _executor;
+	vector<FrameTexture>& _frames;
+	std::shared_ptr<DecodeResults> _decodeResults;
+	std::shared_ptr<const FrameDeltaStore> _deltaStore;
+
+	// Per frame bookkeeping (same size as _frames)
+	vector<FrameState> _frameStates;
+	vector<uint64_t> _lastUseTick;
+	vector<uint32_t> _desiredEpoch;
+
+	vector<int> _desiredFrames; // Priority ordered, closest to the playheads first
+	vector<vector<int>> _hintDesiredFrames;
+	vector<int> _residentFrames;
+	std::deque<std::pair<int, LoadImageJob>> _readyJobs;
+	std::queue<SyncImageUploadJob> _syncImageUploadQueue;
+	PixelUploadRing _uploadRing = PixelUploadRing(MaxStagesPerUpdate);
+	FrameTextureArrays _textureArrays;
+
+	int _windowSize = DefaultWindowSize;
+	int _textureCount = 0;
+	int _decodesInFlight = 0;
+	uint32_t _planEpoch = 0;
+	uint64_t _tick = 0;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Internal Includes
+#include <RVCore/mappedFile.h>
+
+namespace tf
+{
+	class Executor;
+}
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// Packed frame sequence container (*.ufs). Layout:
+// [FrameSequenceHeader][FrameIndexEntry * FrameCount][payloads...][frame names blob]
+// Payloads are the original encoded image files (PNG, TGA...) stored back to back, so packing never
+// re-encodes and the analyzer decodes straight out of the memory mapping.
+constexpr char FrameSequenceMagic[4] = {'U', 'F', 'S', 'Q'};
+constexpr uint32_t FrameSequenceVersion = 1;
+constexpr const char* FrameSequenceExtension = ".ufs";
+
+struct FrameSequenceHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t FrameCount;
+	uint32_t Reserved;
+	uint64_t IndexOffset;
+	uint64_t NamesOffset;
+};
+
+struct FrameIndexEntry
+{
+	uint64_t Offset; // Absolute payload offset in the file
+	uint64_t Size;	 // Encoded payload size in bytes
+	uint32_t Width;
+	uint32_t Height;
+	int64_t TimestampUs; // Capture time in microseconds (see FrameTimestampResolver), -1 when there is none
+	uint32_t NameOffset; // Offset into the names blob
+	uint32_t NameSize;
+};
+
+static_assert(sizeof(FrameSequenceHeader) == 32, "FrameSequenceHeader layout changed!");
+static_assert(sizeof(FrameIndexEntry) == 40, "FrameIndexEntry layout changed!");
+
+class FrameSequenceFile
+{
+  public:
+	FrameSequenceFile() = default;
+
+	bool Open(const string& path, string* error = nullptr);
+	void Close();
+
+	// Asks the OS to start paging the given frames in
+	void Prefetch(uint32_t frameIndex, uint32_t frameCount = 1) const;
+
+	uint32_t GetFrameCount() const { return _header != nullptr ? _header->FrameCount : 0; }
+	const FrameIndexEntry& GetEntry(uint32_t frameIndex) const { return _index[frameIndex]; }
+	const uint8_t* GetPayload(uint32_t frameIndex) const { return _file.GetData() + _index[frameIndex].Offset; }
+	std::string_view GetFrameName(uint32_t frameIndex) const;
+	const string& GetPath() const { return _path; }
+
+	static bool IsFrameSequencePath(const string& path);
+
+  private:
+	rv::MappedFile _file;
+	string _path;
+	const FrameSequenceHeader* _header = nullptr;
+	const FrameIndexEntry* _index = nullptr;
+	const char* _names = nullptr;
+};
+
+// Packs loose image files into a single frame sequence container.
+// Files are read and probed in parallel and written in the given order by a serial stage.
+bool PackFrameSequence(const vector<string>& framePaths, const string& outputPath, tf::Executor& executor,
+	string* error = nullptr);
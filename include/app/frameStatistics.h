@@ -0,0 +1,59 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+// Luminance histograms have one bin per 4 luma levels
+constexpr int LumaHistogramBins = 64;
+// Frames are compared by the mean luminance of 8x8 pixel cells
+constexpr int LumaCellSize = 8;
+// A cell changed when its mean luminance moved by more than this (out of 255)
+constexpr int ChangedLumaThreshold = 8;
+
+// Luminance statistics of one frame, measured by the decoders from the pixels they already have
+struct FrameStatistics
+{
+	float MeanLuma = 0.0f; // 0 to 1
+	float Histogram[LumaHistogramBins] = {}; // Fraction of the pixels in every bin, adds up to 1
+	int CellsX = 0, CellsY = 0;
+	vector<uint8_t> Cells; // Mean luminance of every whole cell, row by row
+};
+
+// Rec. 601 luma of every other row, summed into the mean, the cells and (every eighth row) the histogram in a
+// single pass.
+// Pixels are weighted 16 at a time with SSE2 where available, the scalar path gives the same results.
+void MeasureFrameStatistics(const uint8_t* rgbPixels, int width, int height, FrameStatistics& statistics);
+
+// Fraction of the cells that changed between two consecutive frames: 0 for the first frame, 1 when the size changed
+float GetChangedRatio(const FrameStatistics& previous, const FrameStatistics& current);
+
+// Flat copy of the statistics, as stored in the frame cache
+size_t GetPackedStatisticsSize(const FrameStatistics& statistics);
+void PackFrameStatistics(const FrameStatistics& statistics, uint8_t* bytes);
+bool UnpackFrameStatistics(const uint8_t* bytes, size_t size, FrameStatistics& statistics);
+
+// Statistics of every imported frame as contiguous arrays (struct of arrays), so they plot as series straight out of
+// memory and a range histogram is a vectorized sum over consecutive frames.
+class FrameStatisticsSeries
+{
+  public:
+	void SetFrame(int frameIndex, const FrameStatistics& statistics, float changedRatio);
+	int GetFrameCount() const { return static_cast<int>(_meanLuma.size()); }
+	void Clear();
+
+	const float* GetMeanLuma() const { return _meanLuma.data(); }
+	const float* GetChangedRatio() const { return _changedRatio.data(); }
+	// Average histogram of frameCount frames from firstFrame
+	void GetRangeHistogram(int firstFrame, int frameCount, float histogram[LumaHistogramBins]) const;
+
+  private:
+	vector<float> _meanLuma;
+	vector<float> _changedRatio;
+	vector<float> _histograms; // LumaHistogramBins per frame
+};
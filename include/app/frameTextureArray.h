@@ -0,0 +1,78 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Internal Includes
+#include <app/frameLoader.h>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+struct ImVec2;
+
+// Where a resident frame lives: a layer of a texture array chunk (TextureId is zero when it has none)
+struct FrameLayer
+{
+	unsigned int TextureId = 0;
+	int Layer = 0;
+};
+
+// GPU storage of resident frames. Same sized frames share GL_TEXTURE_2D_ARRAY chunks, so storage is allocated and
+// sampling parameters are set once per chunk rather than once per frame, and frames are uploaded into layers of
+// storage that already exists. A chunk holds up to MaxLayersPerChunk layers, fewer for large frames
+// (about ChunkTargetBytes per chunk). Chunks are deleted as soon as their last layer is freed.
+// Must be used from the GL thread.
+class FrameTextureArrays
+{
+  public:
+	static constexpr int MaxLayersPerChunk = 64;
+	static constexpr size_t ChunkTargetBytes = size_t(64) << 20;
+
+	FrameTextureArrays() = default;
+	~FrameTextureArrays() = default; // Call Release while the GL context is current
+	FrameTextureArrays(FrameTextureArrays&&) = delete;
+	FrameTextureArrays(const FrameTextureArrays&) = delete;
+	FrameTextureArrays& operator=(FrameTextureArrays&&) = delete;
+	FrameTextureArrays& operator=(const FrameTextureArrays&) = delete;
+
+	// Takes a free layer for a frame of the given size and format, a new chunk is allocated when none is left
+	FrameLayer Allocate(int width, int height, FramePixelFormat format);
+	void Free(const FrameLayer& layer);
+	// Whether frames of the given size and format can be uploaded into the layer
+	bool Fits(const FrameLayer& layer, int width, int height, FramePixelFormat format) const;
+	// Uploads the pixels at the start of the bound GL_PIXEL_UNPACK_BUFFER into the layer, or the ones in client memory
+	// at pixels when no buffer is bound
+	void Upload(const FrameLayer& layer, size_t dataSize, const void* pixels = nullptr);
+	// Deletes every chunk
+	void Release();
+
+	// Caps chunks to the number of frames that can be resident at once
+	void SetMaxChunkLayers(int maxChunkLayers) { _maxChunkLayers = maxChunkLayers; }
+	int GetChunkCount() const { return static_cast<int>(_chunks.size()); }
+
+  private:
+	struct Chunk
+	{
+		unsigned int TextureId = 0;
+		int Width, Height;
+		FramePixelFormat Format;
+		int LayerCount;
+		vector<int> FreeLayers;
+	};
+
+	Chunk* FindChunk(unsigned int textureId);
+	const Chunk* FindChunk(unsigned int textureId) const;
+
+	vector<Chunk> _chunks;
+	int _maxChunkLayers = MaxLayersPerChunk;
+};
+
+// Image item showing a layer of a frame texture array, laid out like ImGui::Image. ImGui only samples 2D textures,
+// the layer is drawn through a draw list callback that switches to a shader sampling the array for that one image.
+void FrameLayerImage(const FrameLayer& layer, const ImVec2& size);
+// Deletes the layer shader, call while the GL context is current
+void ReleaseFrameLayerShader();
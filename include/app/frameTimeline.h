@@ -0,0 +1,76 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// Capture timestamp of a frame in microseconds, parsed from its file name: the last "_<number>ms" or
+// "_<number>us" token before the extension (e.g. "Frame_00042_16733ms.png"). Returns -1 when there is none.
+int64_t ParseFrameNameTimestamp(std::string_view fileName);
+
+// Finds the capture timestamps of loose frame files. A "timestamps.csv" ("<file name>,<milliseconds>" per line)
+// or "timestamps.json" (object of file name to milliseconds) next to the frames takes precedence over the file
+// name convention. Sidecars are parsed once per directory.
+class FrameTimestampResolver
+{
+  public:
+	// Timestamp in microseconds, -1 when the frame has none
+	int64_t Resolve(const string& imagePath);
+
+  private:
+	using NameTimestamps = std::unordered_map<string, int64_t>;
+
+	const NameTimestamps& GetDirectory(const string& directory);
+
+	// Sidecar timestamps of every directory seen so far, keyed by file name
+	std::unordered_map<string, NameTimestamps> _directories;
+};
+
+// Start time of every frame relative to the first one, so seeking by time is a binary search.
+// Frames without a timestamp (or out of order) are assumed NominalFrameUs after the previous one, gaps between
+// timestamps are kept however long they are.
+class FrameTimeline
+{
+  public:
+	static constexpr int64_t NominalFrameUs = 16667;
+	static constexpr int64_t MaxFrameGapUs = 10 * 1000 * 1000; // Longest a gap is drawn (exported videos)
+	static constexpr int64_t HitchFactor = 3; // Frames lasting this many times the median are hitches
+
+	void Append(int64_t timestampUs);
+	void Clear();
+
+	int GetFrameCount() const { return static_cast<int>(_startTimesUs.size()); }
+	int64_t GetFrameTime(int frameIndex) const { return _startTimesUs[frameIndex]; }
+	int64_t GetFrameDuration(int frameIndex) const;
+	int64_t GetTotalTime() const;
+	bool HasTimestamps() const { return _timestampedCount > 0; }
+	// Capture timestamp of the timeline start, -1 without timestamps (used to align timelines to each other)
+	int64_t GetOriginTime() const { return _originUs; }
+
+	// Frame shown at the given time (clamped to the timeline), O(log n)
+	int FindFrame(int64_t timeUs) const;
+
+	// Frames that lasted HitchFactor times the median frame duration, recomputed when frames were appended
+	const vector<int>& GetHitches();
+	int64_t GetMedianDuration();
+
+  private:
+	void UpdateStatistics();
+
+	vector<int64_t> _startTimesUs;
+	int64_t _lastTimestampUs = -1;
+	int64_t _originUs = -1;
+	int _timestampedCount = 0;
+
+	int _statisticsFrameCount = 0;
+	int64_t _medianDurationUs = NominalFrameUs;
+	vector<int> _hitches;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+// StdLib Includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Third party dependencies
+#include <taskflow/core/taskflow.hpp>
+#include <taskflow/core/executor.hpp>
+#include <taskflow/algorithm/pipeline.hpp>
+
+// Internal Includes
+#include <app/frameLoader.h>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+class FrameTimeline;
+
+// Writes frames into an uncompressed YUV4MPEG2 (.y4m, 4:2:0) video, which players and encoders (ffmpeg, VLC)
+// read as is. Frames are resampled to a constant frame rate (the median capture duration) following their capture
+// timestamps, so hitches show in the video as they do in the analyzer. The video takes the size of the first frame,
+// frames of another size are scaled to it.
+// Runs in the background as a taskflow pipeline:
+// serial frame emission -> parallel decoding and YUV conversion -> serial in-order writing.
+// Every pipeline line owns the YUV buffer of one frame, so memory is bounded by the line count whatever the length
+// of the capture, and the writer issues whole frame writes straight out of those buffers.
+class FrameVideoExporter
+{
+  public:
+	static constexpr size_t MaxPipelineLines = 16;
+	static constexpr int64_t MinFrameDurationUs = 1000;	   // Up to 1000 frames per second
+	static constexpr int64_t MaxFrameDurationUs = 1000000; // Down to 1 frame per second
+
+	explicit FrameVideoExporter(tf::Executor& executor);
+	~FrameVideoExporter();
+	FrameVideoExporter(FrameVideoExporter&&) = delete;
+	FrameVideoExporter(const FrameVideoExporter&) = delete;
+	FrameVideoExporter& operator=(FrameVideoExporter&&) = delete;
+	FrameVideoExporter& operator=(const FrameVideoExporter&) = delete;
+
+	// Starts writing the frames (timed by the timeline of their stream) into a width x height video at filePath,
+	// returns false if an export is already running or the file can't be created
+	bool Export(const string& filePath, vector<FrameSource> frameSources, FrameTimeline& timeline, int width,
+		int height, string* error = nullptr);
+	// Stops writing, the file keeps the frames written so far (and is still a valid video)
+	void Cancel();
+	// Blocks until the export is done
+	void Wait();
+
+	bool IsExporting() const;
+	// Output frames, a capture frame on screen for several output frames counts as many
+	size_t GetFrameCount() const { return _outputFrameCount; }
+	size_t GetWrittenCount() const { return _writtenCount; }
+	uint64_t GetWrittenBytes() const { return _writtenBytes; }
+	// Capture frames that couldn't be decoded, the previous frame is repeated in their place
+	size_t GetFailedCount() const { return _failedCount; }
+	double GetElapsedSeconds() const;
+	const string& GetFilePath() const { return _filePath; }
+	// Why writing stopped short, only read it once the export is done
+	const string& GetError() const { return _error; }
+
+  private:
+	// A capture frame and the number of output frames it stays on screen for
+	struct ExportFrame
+	{
+		int SourceIndex;
+		int Repeat;
+	};
+
+	// Frame carried by a pipeline line, its buffers keep their capacity from one frame to the next
+	struct ExportLine
+	{
+		size_t FrameIndex = 0;
+		bool Converted = false;
+		vector<uint8_t> ScaledPixels;
+		vector<uint8_t> Yuv;
+	};
+
+	void EmitStage(tf::Pipeflow& pf);
+	void ConvertStage(tf::Pipeflow& pf);
+	void WriteStage(tf::Pipeflow& pf);
+	void CloseFile();
+
+	tf::Executor& _executor;
+	tf::Taskflow _taskFlow;
+	tf::Pipeline<tf::Pipe<>, tf::Pipe<>, tf::Pipe<>> _exportPipeline;
+	tf::Future<void> _exportHandle;
+	vector<ExportLine> _exportLines;
+
+	vector<FrameSource> _frameSources;
+	vector<ExportFrame> _exportFrames;
+	int _width = 0;
+	int _height = 0;
+	string _filePath;
+	FILE* _file = nullptr;
+	vector<uint8_t> _lastYuv; // Last frame written, repeated for frames that fail (only touched by the writer)
+	string _error;
+
+	std::atomic<bool> _cancelRequested = {false};
+	size_t _outputFrameCount = 0;
+	std::atomic<size_t> _writtenCount = {0};
+	std::atomic<size_t> _failedCount = {0};
+	std::atomic<uint64_t> _writtenBytes = {0};
+	std::chrono::steady_clock::time_point _startTime;
+	std::atomic<uint64_t> _elapsedNs = {0};
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+// Fixed ring of pixel buffer objects that frames are staged through on their way to textures.
+// Slots are handed out and given back in order (uploads are synced in the order they were staged) and only grow
+// when a larger frame comes through, so steady state uploads create and delete no GL objects.
+// GL 3.3 has no persistent mapping, a slot is mapped again for every frame with its previous storage invalidated:
+// if the driver still reads it for an earlier upload it renames the storage instead of waiting.
+class PixelUploadRing
+{
+  public:
+	static constexpr int DefaultSlotCount = 32;
+
+	explicit PixelUploadRing(int slotCount = DefaultSlotCount) : _slots(slotCount) {}
+	~PixelUploadRing() = default; // Call Release while the GL context is current
+	PixelUploadRing(PixelUploadRing&&) = delete;
+	PixelUploadRing(const PixelUploadRing&) = delete;
+	PixelUploadRing& operator=(PixelUploadRing&&) = delete;
+	PixelUploadRing& operator=(const PixelUploadRing&) = delete;
+
+	// Takes the next slot, with room for at least size bytes, returns -1 when every slot is taken
+	int Acquire(size_t size);
+	// Maps the first size bytes of the slot for writing (nullptr on failure), the previous contents are discarded
+	uint8_t* Map(int slotIndex, size_t size);
+	// Returns false if the mapped contents were lost
+	bool Unmap(int slotIndex);
+	// Binds the slot to GL_PIXEL_UNPACK_BUFFER, texture uploads then source from it
+	void Bind(int slotIndex) const;
+	// Gives back the newest slot taken, when nothing was staged into it after all
+	void Unacquire();
+	// Gives back the oldest slot taken, once the upload sourcing from it was issued
+	void Free();
+	// Deletes the buffer objects, the ring creates them again when used next
+	void Release();
+
+	bool IsFull() const { return _usedCount == static_cast<int>(_slots.size()); }
+	int GetUsedCount() const { return _usedCount; }
+	uint64_t GetBufferAllocationCount() const { return _bufferAllocationCount; }
+
+  private:
+	struct Slot
+	{
+		unsigned int BufferId = 0;
+		size_t Capacity = 0;
+	};
+
+	vector<Slot> _slots;
+	int _nextSlot = 0;
+	int _usedCount = 0;
+	uint64_t _bufferAllocationCount = 0; // Buffer objects created or grown
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+// StdLib Includes
+#include <atomic>
+#include <limits>
+
+struct GLFWwindow;
+
+// Decides when the main loop draws the next frame, so the application sleeps instead of redrawing what didn't change.
+// The loop waits in glfwWaitEventsTimeout until one of these happens:
+// - Input reaches the window, ImGui then gets InputSettleFrames frames to settle hover states, popups and layout
+// - The deadline requested by the last frame passes (the next frame of the playback, uploads still in progress)
+// - Another thread calls Wake (log lines arrived, frames were loaded)
+// Must be used from the main thread, except for Wake.
+class RedrawScheduler
+{
+  public:
+	static constexpr int InputSettleFrames = 3;
+	static constexpr double NoDeadline = std::numeric_limits<double>::infinity();
+
+	RedrawScheduler() = default;
+	~RedrawScheduler() = default;
+	RedrawScheduler(RedrawScheduler&&) = delete;
+	RedrawScheduler(const RedrawScheduler&) = delete;
+	RedrawScheduler& operator=(RedrawScheduler&&) = delete;
+	RedrawScheduler& operator=(const RedrawScheduler&) = delete;
+
+	// Installs the input callbacks of the window, call it before the ImGui backend installs (and chains) its own
+	void Attach(GLFWwindow* window);
+	// Blocks until the next frame is due (at least minFrameInterval after the previous one), processing window
+	// events meanwhile. Returns false without waiting for it if the window is asked to close.
+	// deltaTime is the time since the previous frame, waiting with no deadline counts as a single frame interval.
+	bool WaitForRedraw(double minFrameInterval, double& deltaTime);
+	// Called once a frame was drawn, the next one is due within delay seconds at the latest (NoDeadline when it only
+	// changes with input or wakes)
+	void OnFrameDrawn(double delay);
+
+	// Requests a redraw from any thread, the main loop wakes up if it is waiting
+	static void Wake();
+
+  private:
+	static constexpr double IdleDeltaTime = 1.0 / 60.0;
+
+	static void OnInput(GLFWwindow* window);
+
+	GLFWwindow* _window = nullptr;
+	int _settleFrames = InputSettleFrames; // The first frames draw right away
+	bool _wokenUp = false;
+	double _lastDrawTime = 0.0;
+	double _deadline = NoDeadline; // glfwGetTime the next frame is due at
+
+	static std::atomic<bool> _wakeRequested;
+};
@@ -4,15 +4,11 @@
 #include <string>
 #include <vector>
 
-// Windows Server Deploy Specific Includes
-#if WIN32
-	#include <cstdio>
-	#include <cstdlib>
-	#include <mutex>
-	#include <strsafe.h>
-	#include <tchar.h>
-	#include <windows.h>
-#endif
+// Internal Includes
+#include <app/serverLogIndex.h>
+#include <app/serverLogRates.h>
+#include <app/serverLogStore.h>
+#include <app/serverProcess.h>
 
 // Using Directives and TypeDefs
 template <typename T>
@@ -20,23 +16,6 @@ using vector = std::vector<T>;
 using string = std::string;
 typedef unsigned int ImGuiID;
 
-enum class LogVerbosity : unsigned char
-{
-	Fatal,
-	Error,
-	Warning,
-	Display,
-	Log,
-	Verbose,
-	VeryVerbose
-};
-
-struct LogEntry
-{
-	string message;
-	LogVerbosity verbosity;
-};
-
 class ServerLauncherWindow
 {
   public:
@@ -46,6 +25,9 @@ class ServerLauncherWindow
 
 	void Draw(ImGuiID dockSpaceId, double deltaTime);
 	void DrawMenuBarWindowItems();
+	// Seconds until the window has to be drawn again without any input (log lines and the server exiting wake the
+	// main loop themselves)
+	double GetRedrawDelay() const;
 
 	bool ShouldShow = false;
 	bool FirstTimeOpen = true;
@@ -65,26 +47,24 @@ class ServerLauncherWindow
 	string _additionalParamLine;
 
 	bool _forceAutoScroll = {false};
-	vector<LogEntry> _serverLogs;
+	ServerLogStore _serverLogs;
+	ServerLogIndex _logIndex;
+	LogFilter _logFilter; // Edited by the filter widgets, handed to the index when it changes
+	char _logSearchBuf[256] = {};
+	ServerLogRates _logRates;
+	bool _plotLogRates = true;
+	bool _logRatesFollow = true; // Whether the plot shows the newest second
+	double _logRatesEndTime = 0.0;
+	vector<LogRateSeries> _busiestLogRates;
 
-#if WIN32
 	void LaunchServerProcess();
-	DWORD ForceCloseServer();
 	void PullServerOutputLog();
+	void DrawLogFilter();
+	void DrawLogRates(float height);
 	void PullServerProcessStatus();
 
-	DWORD _exitCode = 0;
-	PPROCESS_INFORMATION _serverProcInfo = nullptr;
-	HANDLE _hChildStdOut_Rd = nullptr;
-	HANDLE _hChildStdOut_Wr = nullptr;
-	HANDLE _hAsyncReadServerHandle = nullptr;
+	ServerProcess _server;
+	uint32_t _exitCode = 0; // Of the last server, kept once it's stopped
 	bool _copyToClipboard = false;
-	string _partialLogLine;
-	vector<char> _asyncReadQueue;
-
-	// Statics
-	static void CloseServerOnCrashCallback(void* pVoid);
-	DWORD static __stdcall AsyncReadServerStdout(void* pVoid);
-	static std::mutex _threadMutex;
-#endif
+	vector<char> _readBatch; // Swapped with the batch of the reader, so both keep their capacity
 };
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+// StdLib Includes
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Internal Includes
+#include <app/serverLogStore.h>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// What the server log view shows
+struct LogFilter
+{
+	uint8_t Verbosities = 0x7F; // One bit per LogVerbosity
+	vector<uint8_t> HiddenCategories; // Indexed by category id, categories past its end are shown
+	string Search; // Case insensitive substring of the line
+
+	bool ShowsVerbosity(LogVerbosity verbosity) const { return (Verbosities >> int(verbosity)) & 1; }
+	bool ShowsCategory(uint16_t category) const
+	{
+		return category >= HiddenCategories.size() || HiddenCategories[category] == 0;
+	}
+};
+
+// Indexes of a ServerLogStore, built incrementally as lines arrive, so the log view only walks the lines that match
+// its filter:
+// - Every verbosity and category has a posting list (the ids of its lines), a filter showing a single verbosity is
+//   drawn straight from its list, a few small categories are merged from theirs
+// - The verbosity and category of every line are kept in columns as well, for filters that show most of the log
+// - Every word of the log (a run of letters, digits, '_' and non-ASCII bytes, case folded) has a posting list of its
+//   own, delta encoded. A search without separators is the union of the lists of the words holding it, exact without
+//   reading any text. A search with separators only reads the lines holding all of its parts, lines whose
+//   "Category: Verbosity:" header holds the whole search match without reading them either.
+// Words are indexed by a thread of their own, off the ingest path, the lines it didn't reach yet when the filter gets
+// to them are searched by their text. Filters are evaluated up to EvaluationBudget per call, a search that has to verify many
+// lines completes over a few frames while the matches found so far are shown. Lines arriving afterwards are matched
+// as they are indexed.
+// Must be used from the thread that owns the store.
+class ServerLogIndex
+{
+  public:
+	static constexpr std::chrono::microseconds EvaluationBudget = std::chrono::microseconds(6000);
+	// Words are indexed in batches of lines, searches wait for one batch at most
+	static constexpr size_t WordBatchSize = 2048;
+
+	ServerLogIndex();
+	~ServerLogIndex();
+	ServerLogIndex(ServerLogIndex&&) = delete;
+	ServerLogIndex(const ServerLogIndex&) = delete;
+	ServerLogIndex& operator=(ServerLogIndex&&) = delete;
+	ServerLogIndex& operator=(const ServerLogIndex&) = delete;
+
+	// Indexes the lines added to the store since the last call and carries on evaluating the filter, call it every
+	// frame while IsEvaluating
+	void Update(const ServerLogStore& store);
+	// Call it before ServerLogStore::Clear (the word thread reads the text of the lines), hidden categories are
+	// forgotten as their ids are reused
+	void Clear();
+	// Blocks until the word thread indexed every line given to Update (benchmarks and tests)
+	void WaitForWords();
+
+	void SetFilter(const ServerLogStore& store, const LogFilter& filter);
+	const LogFilter& GetFilter() const { return _filter; }
+	// Whether the filter hides any line, the matches are meaningless otherwise
+	bool IsFiltering() const { return _filtering; }
+	// Whether the matches don't cover every indexed line yet
+	bool IsEvaluating() const { return _filtering && _evaluatedCount < _indexedCount; }
+	float GetEvaluatedRatio() const { return _indexedCount > 0 ? float(_evaluatedCount) / _indexedCount : 1.0f; }
+	size_t GetMatchCount() const { return _matchList->size(); }
+	uint32_t GetMatch(size_t matchIndex) const { return (*_matchList)[matchIndex]; }
+
+	size_t GetVerbosityLineCount(LogVerbosity verbosity) const { return _verbosityLines[int(verbosity)].size(); }
+	size_t GetCategoryLineCount(uint16_t category) const
+	{
+		return category < _categoryLines.size() ? _categoryLines[category].size() : 0;
+	}
+	// Bytes held by the posting lists, the columns, the words and the matches
+	size_t GetMemoryBytes() const;
+
+  private:
+	static constexpr int VerbosityCount = 7;
+	// Searches are evaluated over ranges of lines, the words of a range are gathered in a bit set that stays in cache
+	static constexpr size_t RangeBits = 15;
+	static constexpr size_t RangeSize = size_t(1) << RangeBits;
+
+	// Lines of a word, as varint deltas from the line after the previous one
+	struct WordPostings
+	{
+		vector<uint8_t> Deltas;
+		uint32_t NextLine = 0; // One past the last line holding the word
+		uint32_t LineCount = 0;
+	};
+	// Where a search is in the lines of a word, the delta at Offset leads to its next line. The word thread may add
+	// lines past the last one anytime.
+	struct WordCursor
+	{
+		uint32_t Word;
+		uint32_t Offset;
+		uint32_t NextLine; // One past the last line visited
+	};
+	struct PendingLine
+	{
+		const char* Text;
+		size_t Size;
+	};
+	// A part of the search between separators, the words holding it start with it after a separator and end with it
+	// before one. Its cursors end at CursorEnd, after the ones of the previous part.
+	struct SearchRun
+	{
+		uint32_t Start;
+		uint32_t Size;
+		bool AfterSeparator;
+		bool BeforeSeparator;
+		size_t CursorEnd;
+	};
+
+	void IndexWords();
+	void AddLineWords(const PendingLine& line, uint32_t lineId);
+	uint32_t InternWord(const char* word, size_t size, uint32_t hash);
+	size_t FindWordSlot(const char* word, size_t size, uint32_t hash) const;
+	size_t GetWordEnd(uint32_t word) const;
+	void GrowWordSlots();
+	void FindRunWords(const SearchRun& run, uint32_t firstWord, vector<uint32_t>& words) const;
+	void AddRunCursors(size_t run, const vector<uint32_t>& words);
+
+	void Evaluate(const ServerLogStore& store);
+	void EvaluateSearch(const ServerLogStore& store);
+	void ExtendSearch();
+	void ContinueEvaluation(const ServerLogStore& store);
+	void EvaluateSearchRange(const ServerLogStore& store, size_t rangeStart, size_t rangeEnd);
+	void GatherRunLines(size_t run, size_t rangeStart, size_t rangeEnd, uint64_t* rangeLines);
+	void MatchSearchHeaders(const ServerLogStore& store, size_t firstCategory);
+
+	vector<uint32_t> _verbosityLines[VerbosityCount];
+	vector<vector<uint32_t>> _categoryLines;
+	vector<uint8_t> _lineVerbosities;
+	vector<uint16_t> _lineCategories;
+	size_t _indexedCount = 0;
+	vector<PendingLine> _newLines; // Handed to the word thread at the end of Update
+
+	// Owned by the word thread, everything below is guarded by _wordLock
+	std::thread _wordThread;
+	mutable std::mutex _wordLock;
+	std::condition_variable _wordWake;
+	std::condition_variable _wordsIndexed;
+	bool _stopWords = false;
+	vector<PendingLine> _pendingLines;
+	size_t _pendingStart = 0;
+	size_t _wordIndexedCount = 0;
+	string _wordText = "\n"; // Every folded word, each one followed by a line break
+	vector<uint32_t> _wordStarts;
+	vector<uint32_t> _wordHashes;
+	vector<uint32_t> _wordSlots; // Open addressing on the hashes, word id + 1 per slot
+	vector<WordPostings> _wordPostings;
+	string _foldedWord;
+
+	LogFilter _filter;
+	bool _filtering = false;
+	vector<uint32_t> _matches;
+	const vector<uint32_t>* _matchList = &_matches; // _matches or the posting list of the only verbosity shown
+	size_t _evaluatedCount = 0;
+
+	// The search folded to lower case. Lines the word index covers are evaluated from the cursors of the words of its
+	// parts (the ones worth narrowing the lines down with, ordered by their line count), the others by their text.
+	// Without separators the words are the matches, else the lines whose header holds the search are.
+	string _search;
+	bool _searchIsWord = false;
+	vector<SearchRun> _searchRuns;
+	vector<WordCursor> _searchCursors;
+	size_t _searchIndexedCount = 0; // Lines and words of the index when the cursors were last extended
+	size_t _searchWordCount = 0;
+	vector<uint8_t> _headerMatches; // VerbosityCount + 1 per category
+	vector<uint8_t> _shownCategories;
+	vector<uint64_t> _rangeLines;
+	vector<uint64_t> _runLines;
+	vector<uint32_t> _rangeCandidates;
+};
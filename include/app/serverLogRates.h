@@ -0,0 +1,101 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Internal Includes
+#include <app/serverLogStore.h>
+
+// Using directives
+template <typename T>
+using vector = std::vector<T>;
+
+// One series of ServerLogRates, with its lines over the whole ring
+struct LogRateSeries
+{
+	int Series;
+	uint16_t Category;
+	LogVerbosity Verbosity;
+	uint64_t LineCount;
+};
+
+// Lines of the server log per second, counted into fixed time buckets as they are ingested: in total, by verbosity, by
+// category and by category and verbosity. Lines are placed by their "[2023.05.12-14.22.31:412]" timestamp, lines
+// without one by their arrival time, moved onto the log clock by the offset seen at the last timestamped line.
+// Buckets live in a ring of the last BucketCount seconds, stored by column: every series is a contiguous array of
+// counts that plots as it is, starting at GetRingOffset. Counting a line is a single increment of its category and
+// verbosity, the series are updated once per category and verbosity in every second of a batch. A bucket going out of
+// the ring is cleared once across the series.
+// Must be used from the thread that owns the store.
+class ServerLogRates
+{
+  public:
+	static constexpr int64_t BucketMilliseconds = 1000;
+	static constexpr double BucketSeconds = BucketMilliseconds / 1000.0;
+	static constexpr size_t BucketCount = 3600;
+	static constexpr int AllLinesSeries = 0;
+
+	ServerLogRates() = default;
+	~ServerLogRates() = default;
+	ServerLogRates(ServerLogRates&&) = delete;
+	ServerLogRates(const ServerLogRates&) = delete;
+	ServerLogRates& operator=(ServerLogRates&&) = delete;
+	ServerLogRates& operator=(const ServerLogRates&) = delete;
+
+	// Counts the lines added to the store since the last call, which all arrived now
+	void Update(const ServerLogStore& store);
+	// Call it along with ServerLogStore::Clear, series of categories go away as their ids are reused
+	void Clear();
+
+	// Times and the ring are meaningless while empty
+	bool IsEmpty() const { return _newestBucket == NoBucket; }
+	// Seconds since the epoch: the start of the oldest bucket in the ring that has lines, the end of the newest one
+	double GetFirstTime() const;
+	double GetEndTime() const { return (_newestBucket + 1) * BucketSeconds; }
+	// Every series holds BucketCount counts, the oldest at GetRingOffset, starting at GetRingStartTime
+	double GetRingStartTime() const { return (_newestBucket + 1 - int64_t(BucketCount)) * BucketSeconds; }
+	int GetRingOffset() const { return static_cast<int>(GetSlot(_newestBucket + 1)); }
+
+	static int GetVerbositySeries(LogVerbosity verbosity) { return 1 + int(verbosity); }
+	// -1 until the category (and verbosity) has a line
+	int GetCategorySeries(uint16_t category) const;
+	int GetCategoryVerbositySeries(uint16_t category, LogVerbosity verbosity) const;
+	const uint32_t* GetCounts(int series) const { return _counts.data() + series * BucketCount; }
+	uint64_t GetLineCount(int series) const { return _lineCounts[series]; }
+
+	// The categories, and the categories with Warning or worse, with the most lines in the ring (up to count, busiest
+	// first)
+	void FindBusiestCategories(size_t count, vector<LogRateSeries>& busiest) const;
+	void FindBusiestWarnings(size_t count, vector<LogRateSeries>& busiest) const;
+	size_t GetMemoryBytes() const;
+
+  private:
+	static constexpr int VerbosityCount = 7;
+	static constexpr int64_t NoBucket = INT64_MIN;
+
+	static size_t GetSlot(int64_t bucket);
+	bool ParseTimestamp(string_view text, int64_t& time);
+	void AddPendingLines();
+	void AdvanceTo(int64_t bucket);
+	int AddSeries();
+
+	vector<uint32_t> _counts; // BucketCount per series, series after series, bucket b in slot b % BucketCount
+	vector<uint64_t> _lineCounts; // Of every series, over the ring
+	vector<int> _categorySeries;
+	vector<int> _categoryVerbositySeries; // VerbosityCount per category
+	size_t _countedLineCount = 0;
+	int64_t _firstBucket = NoBucket;
+	int64_t _newestBucket = NoBucket;
+	int64_t _arrivalOffset = 0; // Log time minus arrival time at the last timestamped line, in milliseconds
+
+	// Lines of the same second are counted by category and verbosity, then added to the series together
+	int64_t _pendingBucket = NoBucket;
+	vector<uint32_t> _pendingCounts; // VerbosityCount per category
+	vector<uint32_t> _pendingIndices; // Of the counts above 0, in the order they first showed up
+
+	// Consecutive lines mostly share their second, "[2023.05.12-14.22.31:", it's only converted when it changes
+	char _second[21] = {};
+	int64_t _secondTime = 0;
+};
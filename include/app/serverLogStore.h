@@ -0,0 +1,105 @@
+#pragma once
+
+// StdLib Includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Using directives
+using string_view = std::string_view;
+template <typename T>
+using vector = std::vector<T>;
+
+enum class LogVerbosity : unsigned char
+{
+	Fatal,
+	Error,
+	Warning,
+	Display,
+	Log,
+	Verbose,
+	VeryVerbose
+};
+
+// As Unreal prints them, in LogVerbosity order
+inline constexpr string_view LogVerbosityNames[] = {
+	"Fatal", "Error", "Warning", "Display", "Log", "Verbose", "VeryVerbose"};
+
+// One line of the log, its text lives in the arena of the store
+struct LogLine
+{
+	uint32_t Chunk;
+	uint32_t Offset;
+	uint32_t Length;	  // Without the line break
+	uint16_t Category;	  // See ServerLogStore::GetCategoryName, 0 when the line has none
+	LogVerbosity Verbosity;
+};
+static_assert(sizeof(LogLine) == 16, "LogLine should stay compact, there is one per line of output");
+
+// Append-only store of the server output. Raw stdout bytes are copied once into large arena chunks and every complete
+// line gets an entry in a flat line index, so a log of millions of lines costs its text plus 16 bytes per line,
+// without a single allocation per line. Lines are handed out as string_views into the arena, which stay valid until
+// the store is cleared. Categories are interned (as views into the arena as well) and referenced by id.
+// Line breaks are found 64 bytes at a time (AVX2 or SSE2 where available) while the bytes are copied, then the
+// "[timestamp][frame]" prefix, the category and the verbosity of every line come out of the bit masks of the first
+// 64 bytes of the line.
+// Not thread safe, the reader thread hands its batches over to the thread that owns the store.
+class ServerLogStore
+{
+  public:
+	static constexpr size_t ChunkSize = size_t(1) << 20;
+	// The line index grows by blocks as well, so it's never moved (nor touched twice) while the log grows
+	static constexpr size_t LineBlockBits = 16;
+	static constexpr size_t LineBlockSize = size_t(1) << LineBlockBits;
+
+	ServerLogStore() = default;
+	~ServerLogStore() = default;
+	ServerLogStore(ServerLogStore&&) = delete;
+	ServerLogStore(const ServerLogStore&) = delete;
+	ServerLogStore& operator=(ServerLogStore&&) = delete;
+	ServerLogStore& operator=(const ServerLogStore&) = delete;
+
+	// Appends raw output, complete lines are indexed right away while a trailing partial line waits for the rest
+	void Append(const char* data, size_t size);
+	// Drops every complete line, a partial line is kept for the output still to come
+	void Clear();
+
+	size_t GetLineCount() const { return _lineCount; }
+	const LogLine& GetLine(size_t lineIndex) const
+	{
+		return _lineBlocks[lineIndex >> LineBlockBits][lineIndex & (LineBlockSize - 1)];
+	}
+	string_view GetText(const LogLine& line) const
+	{
+		return {_chunks[line.Chunk].Bytes.get() + line.Offset, line.Length};
+	}
+	string_view GetText(size_t lineIndex) const { return GetText(GetLine(lineIndex)); }
+	size_t GetCategoryCount() const { return _categories.size(); }
+	string_view GetCategoryName(uint16_t category) const { return _categories[category]; }
+	// Bytes held by the arena and the line index
+	size_t GetMemoryBytes() const;
+
+  private:
+	struct Chunk
+	{
+		std::unique_ptr<char[]> Bytes;
+		size_t Size = 0;
+		size_t Capacity = 0;
+	};
+
+	void StartChunk();
+	void CopyAndIndexLines(const char* data, size_t size);
+	void AddLine(size_t lineEnd);
+	uint16_t InternCategory(string_view name);
+
+	vector<Chunk> _chunks;
+	vector<std::unique_ptr<LogLine[]>> _lineBlocks;
+	size_t _lineCount = 0;
+	size_t _lineStart = 0; // Start of the partial line in the last chunk
+	vector<string_view> _categories = {string_view()};
+	std::unordered_map<string_view, uint16_t> _categoryIds;
+	uint16_t _lastCategory = 0; // Consecutive lines mostly share their category, it's checked before the lookup
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+// StdLib Includes
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Using directives
+using string = std::string;
+template <typename T>
+using vector = std::vector<T>;
+
+// Runs the dedicated server as a child process, its stdout and stderr are read by a thread of its own.
+// The reader sleeps until output arrives (poll on Linux, a blocking ReadFile on Windows) and leaves once the pipe
+// reaches its end, then waits for the process to exit and records the exit code. Output piles up in a batch that is
+// swapped out by the thread owning the process, it's woken up once per batch through the output callback.
+// On Linux the command line runs through /bin/sh in a process group of its own, on Windows in a job object, so
+// stopping the server kills whatever it started as well.
+class ServerProcess
+{
+  public:
+	static constexpr size_t ReadSize = 64 * 1024; // A full Linux pipe buffer
+
+	ServerProcess() = default;
+	~ServerProcess();
+	ServerProcess(ServerProcess&&) = delete;
+	ServerProcess(const ServerProcess&) = delete;
+	ServerProcess& operator=(ServerProcess&&) = delete;
+	ServerProcess& operator=(const ServerProcess&) = delete;
+
+	// Stops the previous process (if any), returns false if the command couldn't be launched. error also gets a
+	// warning when the server started without the job object that ties it to the application (Windows).
+	bool Start(const string& commandLine, string* error = nullptr);
+	// Kills the process if it's still running, waits for the reader and releases the process.
+	// Output read so far can still be pulled.
+	void Stop();
+
+	// Whether a process was started and not stopped yet, it may have exited already
+	bool IsStarted() const { return _readThread.joinable(); }
+	// Whether the started process exited, its output was read to the end by then
+	bool HasExited() const { return _exited; }
+	// Exit code of the last process, 128 + the signal number when it was killed by one (Linux)
+	uint32_t GetExitCode() const { return _exitCode; }
+
+	// Swaps the output read since the last call into batch, returns its size
+	size_t PullOutput(vector<char>& batch);
+	// Called on the reader thread when output arrives while the batch is empty and once the process exited, only
+	// change it while not started
+	void SetOutputCallback(std::function<void()> onOutput) { _onOutput = std::move(onOutput); }
+
+  private:
+	void ReadLoop();
+	void PushOutput(const char* data, size_t size);
+
+	std::thread _readThread;
+	std::atomic<bool> _exited = {false};
+	uint32_t _exitCode = 0; // Written by the reader before _exited
+
+#if WIN32
+	void* _process = nullptr;
+	void* _job = nullptr;
+	void* _outputPipe = nullptr;
+	std::atomic<bool> _stopRequested = {false};
+#else
+	int _processId = -1;
+	int _outputFd = -1;
+	int _stopPipe[2] = {-1, -1}; // Written by Stop to wake the reader up
+#endif
+
+	std::mutex _outputLock;
+	vector<char> _output;
+	std::function<void()> _onOutput;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+// StdLib Includes
+#include <cstdint>
+
+// Size of the timeline thumbnails (both multiples of the BC1 block size so they pack into atlases). Frames of another
+// aspect ratio are fitted inside, with black bars (see FitThumbnail and LetterboxThumbnail).
+constexpr int ThumbnailWidth = 128;
+constexpr int ThumbnailHeight = 72;
+
+// Largest size a width x height frame scales to within a thumbnail, keeping its aspect ratio
+void FitThumbnail(int width, int height, int& fitWidth, int& fitHeight);
+// Centers fitted RGB888 pixels (see FitThumbnail) into a ThumbnailWidth x ThumbnailHeight thumbnail, bars are black
+void LetterboxThumbnail(const uint8_t* fitPixels, int fitWidth, int fitHeight, uint8_t* thumbnailPixels);
+
+// Box filter downscale of tightly packed RGB888 pixels. Every output pixel is the average of the source
+// rectangle it covers; rows are accumulated with SSE2 where available.
+void DownscaleBox(const uint8_t* rgbPixels, int width, int height, uint8_t* outPixels, int outWidth, int outHeight);
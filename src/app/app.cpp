@@ -46,6 +46,9 @@ void UE4NetworkTool::Setup()
 
 	glfwSetInputMode(_window, GLFW_STICKY_KEYS, GLFW_TRUE);
 
+	// Frames are only drawn when something changed, installed first so the ImGui callbacks chain to it
+	_redrawScheduler.Attach(_window);
+
 	// Setup Dear ImGui context
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -109,29 +112,24 @@ void UE4NetworkTool::Shutdown()
 	glfwTerminate();
 }
 
-constexpr float fixedFPSDeltaTime = 1.0f/60.0f;
+constexpr double fixedFPSDeltaTime = 1.0 / 60.0;
 
 void UE4NetworkTool::Update(double deltaTime)
 {
-	shouldQuit = glfwWindowShouldClose(_window);
-
-	_accDeltaTime += deltaTime;
-	if (_accDeltaTime < fixedFPSDeltaTime && _fixedFPS) return;
-	if (_accDeltaTime > fixedFPSDeltaTime)
+	// Sleeps until input, a wake from another thread or the deadline of the last frame (polls the events too)
+	double frameDeltaTime = 0.0;
+	if (!_redrawScheduler.WaitForRedraw(_fixedFPS ? fixedFPSDeltaTime : 0.0, frameDeltaTime))
 	{
-		_accDeltaTime = fmod(_accDeltaTime, fixedFPSDeltaTime);
+		shouldQuit = true;
+		return;
 	}
 
-	// Poll first so ImGUI has the events.
-	// This performs some callbacks as well
-	glfwPollEvents();
-
 	// ImGUI frame initialization
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 
-	DrawAppScreen(_fixedFPS ? fixedFPSDeltaTime : deltaTime);
+	DrawAppScreen(frameDeltaTime);
 
 	// ImGUI frame baking (finalization)
 	ImGui::Render();
@@ -142,6 +140,14 @@ void UE4NetworkTool::Update(double deltaTime)
 	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
 	glfwSwapBuffers(_window);
+	_redrawScheduler.OnFrameDrawn(GetRedrawDelay());
+}
+
+double UE4NetworkTool::GetRedrawDelay() const
+{
+	// The demo windows animate
+	if (showDemoWindows) return 0.0;
+	return min(_frameAnalyzerWindow->GetRedrawDelay(), _serverLauncherWindow->GetRedrawDelay());
 }
 
 void UE4NetworkTool::DrawAppScreen(double deltaTime)
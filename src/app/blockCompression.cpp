@@ -0,0 +1,223 @@
+#include <app/blockCompression.h>
+
+// StdLib Includes
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define BC1_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define BC1_USE_SSE2 0
+#endif
+
+size_t GetBC1DataSize(int width, int height)
+{
+	const size_t blocksX = (static_cast<size_t>(width) + 3) / 4;
+	const size_t blocksY = (static_cast<size_t>(height) + 3) / 4;
+	return blocksX * blocksY * BC1BlockSize;
+}
+
+// Gathers a 4x4 block as RGBX, clamping reads at the frame borders
+static void LoadBlock(const uint8_t* rgbPixels, int width, int height, int blockX, int blockY, uint8_t block[64])
+{
+	const int pixelX = blockX * 4;
+	const int pixelY = blockY * 4;
+	if (pixelX + 4 <= width && pixelY + 4 <= height)
+	{
+		for (int y = 0; y < 4; ++y)
+		{
+			const uint8_t* row = rgbPixels + (static_cast<size_t>(pixelY + y) * width + pixelX) * 3;
+			for (int x = 0; x < 4; ++x)
+			{
+				uint8_t* texel = block + (y * 4 + x) * 4;
+				texel[0] = row[x * 3 + 0];
+				texel[1] = row[x * 3 + 1];
+				texel[2] = row[x * 3 + 2];
+				texel[3] = 0;
+			}
+		}
+		return;
+	}
+
+	for (int y = 0; y < 4; ++y)
+	{
+		const int clampedY = pixelY + y < height ? pixelY + y : height - 1;
+		for (int x = 0; x < 4; ++x)
+		{
+			const int clampedX = pixelX + x < width ? pixelX + x : width - 1;
+			const uint8_t* pixel = rgbPixels + (static_cast<size_t>(clampedY) * width + clampedX) * 3;
+			uint8_t* texel = block + (y * 4 + x) * 4;
+			texel[0] = pixel[0];
+			texel[1] = pixel[1];
+			texel[2] = pixel[2];
+			texel[3] = 0;
+		}
+	}
+}
+
+static inline uint16_t PackRGB565(const int rgb[3])
+{
+	const int r = (rgb[0] * 31 + 127) / 255;
+	const int g = (rgb[1] * 63 + 127) / 255;
+	const int b = (rgb[2] * 31 + 127) / 255;
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static inline void UnpackRGB565(uint16_t color, int rgb[3])
+{
+	const int r = (color >> 11) & 31;
+	const int g = (color >> 5) & 63;
+	const int b = color & 31;
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void ComputeBounds(const uint8_t block[64], int minColor[3], int maxColor[3])
+{
+#if BC1_USE_SSE2
+	const __m128i* texels = reinterpret_cast<const __m128i*>(block);
+	const __m128i row0 = _mm_loadu_si128(texels + 0), row1 = _mm_loadu_si128(texels + 1);
+	const __m128i row2 = _mm_loadu_si128(texels + 2), row3 = _mm_loadu_si128(texels + 3);
+
+	__m128i minBytes = _mm_min_epu8(_mm_min_epu8(row0, row1), _mm_min_epu8(row2, row3));
+	__m128i maxBytes = _mm_max_epu8(_mm_max_epu8(row0, row1), _mm_max_epu8(row2, row3));
+	minBytes = _mm_min_epu8(minBytes, _mm_srli_si128(minBytes, 8));
+	maxBytes = _mm_max_epu8(maxBytes, _mm_srli_si128(maxBytes, 8));
+	minBytes = _mm_min_epu8(minBytes, _mm_srli_si128(minBytes, 4));
+	maxBytes = _mm_max_epu8(maxBytes, _mm_srli_si128(maxBytes, 4));
+
+	const uint32_t minTexel = static_cast<uint32_t>(_mm_cvtsi128_si32(minBytes));
+	const uint32_t maxTexel = static_cast<uint32_t>(_mm_cvtsi128_si32(maxBytes));
+	for (int channel = 0; channel < 3; ++channel)
+	{
+		minColor[channel] = (minTexel >> (channel * 8)) & 0xFF;
+		maxColor[channel] = (maxTexel >> (channel * 8)) & 0xFF;
+	}
+#else
+	for (int channel = 0; channel < 3; ++channel)
+	{
+		minColor[channel] = 255;
+		maxColor[channel] = 0;
+	}
+	for (int texelIt = 0; texelIt < 16; ++texelIt)
+	{
+		for (int channel = 0; channel < 3; ++channel)
+		{
+			const int value = block[texelIt * 4 + channel];
+			minColor[channel] = value < minColor[channel] ? value : minColor[channel];
+			maxColor[channel] = value > maxColor[channel] ? value : maxColor[channel];
+		}
+	}
+#endif
+}
+
+// Nearest palette level of every texel along the endpoint axis (0 at color1 ... 3 at color0)
+static void ComputeLevels(const uint8_t block[64], const int color1[3], const int axis[3], int levels[16])
+{
+	const int axisLengthSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+	// Levels are a third of the axis apart, so the rounding thresholds sit at 1/6, 3/6 and 5/6 of it
+#if BC1_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i origin = _mm_set_epi16(0, color1[2], color1[1], color1[0], 0, color1[2], color1[1], color1[0]);
+	const __m128i axisVec = _mm_set_epi16(0, axis[2], axis[1], axis[0], 0, axis[2], axis[1], axis[0]);
+	const __m128i threshold0 = _mm_set1_epi32(axisLengthSq - 1);
+	const __m128i threshold1 = _mm_set1_epi32(axisLengthSq * 3 - 1);
+	const __m128i threshold2 = _mm_set1_epi32(axisLengthSq * 5 - 1);
+
+	const __m128i* texels = reinterpret_cast<const __m128i*>(block);
+	for (int rowIt = 0; rowIt < 4; ++rowIt)
+	{
+		const __m128i row = _mm_loadu_si128(texels + rowIt);
+
+		// Two texels per register as 16-bit channels, madd leaves [r*ar + g*ag, b*ab] pairs per texel
+		__m128i dotLo = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(row, zero), origin), axisVec);
+		__m128i dotHi = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(row, zero), origin), axisVec);
+		dotLo = _mm_add_epi32(dotLo, _mm_srli_epi64(dotLo, 32));
+		dotHi = _mm_add_epi32(dotHi, _mm_srli_epi64(dotHi, 32));
+		dotLo = _mm_shuffle_epi32(dotLo, _MM_SHUFFLE(3, 1, 2, 0));
+		dotHi = _mm_shuffle_epi32(dotHi, _MM_SHUFFLE(3, 1, 2, 0));
+		const __m128i dot = _mm_unpacklo_epi64(dotLo, dotHi);
+
+		// dot * 6 compared against the thresholds, every passed threshold adds one level
+		const __m128i dot6 = _mm_add_epi32(_mm_slli_epi32(dot, 2), _mm_slli_epi32(dot, 1));
+		__m128i level = _mm_cmpgt_epi32(dot6, threshold0);
+		level = _mm_add_epi32(level, _mm_cmpgt_epi32(dot6, threshold1));
+		level = _mm_add_epi32(level, _mm_cmpgt_epi32(dot6, threshold2));
+		level = _mm_sub_epi32(zero, level);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(levels + rowIt * 4), level);
+	}
+#else
+	for (int texelIt = 0; texelIt < 16; ++texelIt)
+	{
+		const uint8_t* texel = block + texelIt * 4;
+		const int dot = (texel[0] - color1[0]) * axis[0] + (texel[1] - color1[1]) * axis[1] +
+						(texel[2] - color1[2]) * axis[2];
+		const int dot6 = dot * 6;
+		levels[texelIt] = (dot6 >= axisLengthSq) + (dot6 >= axisLengthSq * 3) + (dot6 >= axisLengthSq * 5);
+	}
+#endif
+}
+
+static void EncodeBlock(const uint8_t block[64], uint8_t* output)
+{
+	int minColor[3], maxColor[3];
+	ComputeBounds(block, minColor, maxColor);
+
+	// Inset the bounding box a bit, extremes are usually outliers
+	for (int channel = 0; channel < 3; ++channel)
+	{
+		const int inset = (maxColor[channel] - minColor[channel]) >> 4;
+		minColor[channel] += inset;
+		maxColor[channel] -= inset;
+	}
+
+	// Max is never smaller than min in any channel, so color0 >= color1 and we get the 4 color mode
+	const uint16_t color0 = PackRGB565(maxColor);
+	const uint16_t color1 = PackRGB565(minColor);
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		int endpoint0[3], endpoint1[3], axis[3];
+		UnpackRGB565(color0, endpoint0);
+		UnpackRGB565(color1, endpoint1);
+		for (int channel = 0; channel < 3; ++channel)
+		{
+			axis[channel] = endpoint0[channel] - endpoint1[channel];
+		}
+
+		int levels[16];
+		ComputeLevels(block, endpoint1, axis, levels);
+
+		// Palette order is color0, color1, 2/3 color0 + 1/3 color1, 1/3 color0 + 2/3 color1
+		static constexpr uint32_t levelToIndex[4] = {1, 3, 2, 0};
+		for (int texelIt = 0; texelIt < 16; ++texelIt)
+		{
+			indices |= levelToIndex[levels[texelIt]] << (texelIt * 2);
+		}
+	}
+
+	output[0] = static_cast<uint8_t>(color0 & 0xFF);
+	output[1] = static_cast<uint8_t>(color0 >> 8);
+	output[2] = static_cast<uint8_t>(color1 & 0xFF);
+	output[3] = static_cast<uint8_t>(color1 >> 8);
+	memcpy(output + 4, &indices, sizeof(indices));
+}
+
+void CompressBC1(const uint8_t* rgbPixels, int width, int height, uint8_t* blocks)
+{
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+
+	alignas(16) uint8_t block[64];
+	for (int blockY = 0; blockY < blocksY; ++blockY)
+	{
+		for (int blockX = 0; blockX < blocksX; ++blockX)
+		{
+			LoadBlock(rgbPixels, width, height, blockX, blockY, block);
+			EncodeBlock(block, blocks);
+			blocks += BC1BlockSize;
+		}
+	}
+}
@@ -1,41 +1,101 @@
 #include <app/frameAnalyzer.h>
 
+// StdLib Includes
+#include <chrono>
+#include <cmath>
+
 // Third Party Includes
 #include <fmt/core.h>
 #include <glad/glad.h>
 #include <glfw/glfw3.h>
 #include <imgui/imgui.h>
+#include <implot/implot.h>
 #include <pfd.h>
 #include <stb_image.h>
 #include <string.h>
-#include <taskflow/algorithm/pipeline.hpp>
 
 // Internal Includes
 #include <RVCore/utils.h>
+#include <app/frameDeltaStore.h>
+#include <app/frameSequenceFile.h>
+#include <app/redrawScheduler.h>
+#include <app/settings.h>
 #include <utility>
 
+FrameAnalyzerWindow::FrameAnalyzerWindow(bool isOpen, GLFWwindow* window)
+	: ShouldShow(isOpen), _frameLoader(_taskExecutor), _frameResidency(_taskExecutor, _textures),
+	  _videoExporter(_taskExecutor),
+	  _deltaStore(std::make_shared<FrameDeltaStore>()),
+	  _frameCache(std::make_shared<FrameCache>()), _window(window),
+	  _settingsEntry(Settings::Register("FrameAnalyzerSettings"))
+{
+	// Imported frames are kept delta encoded in memory, so evicted frames never go back to disk
+	_frameLoader.SetDeltaStore(_deltaStore);
+	_frameResidency.SetDeltaStore(_deltaStore);
+
+	// Thumbnails for the timeline strip are made by the decoders, from the pixels they already have
+	_frameLoader.SetMakeThumbnails(true);
+	_frameLoader.SetMeasureStatistics(true);
+
+	// Captures imported before are read back processed instead of decoded again
+	if (_frameCache->Open(FrameCache::GetDefaultDirectory())) _frameLoader.SetFrameCache(_frameCache);
+
+	// Loaded and live frames are drawn as they come, the main loop sleeps otherwise
+	_frameLoader.SetHandOffCallback(RedrawScheduler::Wake);
+	_directoryWatcher.SetReadyCallback(RedrawScheduler::Wake);
+}
+
 FrameAnalyzerWindow::~FrameAnalyzerWindow()
 {
+	// Set information to be saved upon closing
+	StoreSettings();
+	_settingsEntry = nullptr;
+
 	// We don't own the GLFW window
 	// We only use it for inputs
 	_window = nullptr;
 
-	// Release Graphics API textures
-	for (const FrameTexture& texture : _textures)
+	// Release Graphics API textures (frame textures are declared after the residency, so do it explicitly)
+	_frameResidency.Clear();
+	_filmstrip.Clear();
+	ReleaseFrameLayerShader();
+
+	_directoryWatcher.Stop();
+
+	// Drop any decoded frames that never made it to the GPU (this gives their budget back, so a
+	// throttled loader is able to stop)
+	for (LoadImageJob& job : _uploadImageDeque)
 	{
-		glDeleteTextures(1, &texture.TextureId);
+		FrameLoader::ReleaseImageData(job);
 	}
+	_frameLoader.Cancel();
 
-	_loadFramesList.clear();
+	_uploadImageDeque.clear();
 	_textures.clear();
 }
 
 void FrameAnalyzerWindow::DrawMenuBarFileItems()
 {
-	if (ImGui::MenuItem("Import Frame Snapshot(s)"))
+	if (ImGui::MenuItem("Import Frame Snapshot(s)", nullptr, false, !_showLoadingModal))
 	{
 		ImportFrameSnapshots();
 	}
+	if (_liveStream < 0 && ImGui::MenuItem("Watch Snapshot Directory", nullptr, false, !_showLoadingModal))
+	{
+		WatchSnapshotDirectory();
+	}
+	else if (_liveStream >= 0 && ImGui::MenuItem("Stop Watching Snapshots"))
+	{
+		StopWatchingSnapshots();
+	}
+	if (ImGui::MenuItem("Export Video (Y4M)", nullptr, false, !_textures.empty() && !_videoExportPending))
+	{
+		ExportVideo();
+	}
+	if (ImGui::MenuItem("Clear Frame Cache", nullptr, false, _frameCache->IsOpen() && !_frameLoader.IsLoading()))
+	{
+		_frameCache->Clear();
+	}
 }
 
 void FrameAnalyzerWindow::DrawMenuBarWindowItems()
@@ -48,6 +108,17 @@ void FrameAnalyzerWindow::DrawMenuBarWindowItems()
 
 void FrameAnalyzerWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 {
+	if (_firstTimeOpen)
+	{
+		_firstTimeOpen = false;
+		LoadSettings();
+	}
+
+	// Keep uploading the frames around the playheads (planned from last draw's playback state)
+	_frameResidency.Update(_playbackHints);
+	UpdateLiveIngest();
+	ReportVideoExport();
+
 	if (!ShouldShow) return;
 
 	ImGui::SetNextWindowDockID(dockSpaceId, ImGuiCond_FirstUseEver);
@@ -56,7 +127,8 @@ void FrameAnalyzerWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 		if (_textures.empty())
 		{
 			// Centralize text
-			const char* importText = "Import Frames to Start Using the Analyzer";
+			const char* importText =
+				_liveStream >= 0 ? "Waiting for Snapshots to be Written" : "Import Frames to Start Using the Analyzer";
 			ImVec2 textSize = ImGui::CalcTextSize(importText);
 			ImVec2 textPos = ImGui::GetWindowSize();
 			textPos.x = (textPos.x - textSize.x) * 0.5f;
@@ -82,18 +154,33 @@ void FrameAnalyzerWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 			return;
 		}
 
-		// Try to show any available snapshot in timeline
-		FrameTexture& texture = _textures[_imageOffset];
+		// The primary stream is the one stepped, scrubbed and searched, the others follow it by capture time
+		if (_streams[_primaryStream].FrameCount == 0)
+		{
+			_primaryStream = FindStream(0);
+		}
+		FrameStream& primary = _streams[_primaryStream];
+		const int size = primary.FrameCount;
+		_imageOffset = min(_imageOffset, size - 1);
 
-		// Check if we should increment imageOffset based on input
-		static double playbackTime = 0;
-		playbackTime += deltaTime * (_playbackSpeed / 100.0f);
+		// Watching a live session shows frames as soon as they are written
+		if (_followLive && _primaryStream == _liveStream)
+		{
+			_imageOffset = size - 1;
+		}
+
+		// Frames seeked by hand (keys, sliders, filmstrip) move the playback clock with them
+		if (_imageOffset != _playbackFrame)
+		{
+			const int64_t frameTimeUs = GetStreamOffset(primary) + primary.Timeline.GetFrameTime(_imageOffset);
+			_playbackTimeUs = static_cast<double>(frameTimeUs);
+			_playbackFrame = _imageOffset;
+		}
 
 		static int lastSpaceState = glfwGetKey(_window, GLFW_KEY_SPACE);
 		static int lastRightState = glfwGetKey(_window, GLFW_KEY_RIGHT);
 		static int lastLeftState = glfwGetKey(_window, GLFW_KEY_LEFT);
 
-		const int size = static_cast<int>(_textures.size());
 		if (_autoPlay)
 		{
 			if (!lastSpaceState && glfwGetKey(_window, GLFW_KEY_SPACE))
@@ -101,11 +188,16 @@ void FrameAnalyzerWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 				_autoPlay = false;
 			}
 
-			if (playbackTime > texture.Duration)
+			// Frames stay on screen as long as they did when captured, so hitches play back as hitches
+			double totalTimeUs = 0.0;
+			for (const FrameStream& stream : _streams)
 			{
-				_imageOffset = (_imageOffset + 1) % size;
-				playbackTime = 0;
+				const int64_t streamEndUs = GetStreamOffset(stream) + stream.Timeline.GetTotalTime();
+				totalTimeUs = max(totalTimeUs, static_cast<double>(streamEndUs));
 			}
+			_playbackTimeUs = fmod(_playbackTimeUs + deltaTime * 1.0e6 * (_playbackSpeed / 100.0f), totalTimeUs);
+			_imageOffset = primary.Timeline.FindFrame(static_cast<int64_t>(_playbackTimeUs) - GetStreamOffset(primary));
+			_playbackFrame = _imageOffset;
 		}
 		else
 		{
@@ -128,6 +220,26 @@ void FrameAnalyzerWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 		lastRightState = glfwGetKey(_window, GLFW_KEY_RIGHT);
 		lastLeftState = glfwGetKey(_window, GLFW_KEY_LEFT);
 
+		// Let the residency know where every stream is heading so it prefetches the right frames
+		const int streamCount = static_cast<int>(_streams.size());
+		_streamFrames.resize(streamCount);
+		_playbackHints.resize(streamCount);
+		for (int streamIt = 0; streamIt < streamCount; ++streamIt)
+		{
+			const FrameStream& stream = _streams[streamIt];
+			const int64_t streamTimeUs = static_cast<int64_t>(_playbackTimeUs) - GetStreamOffset(stream);
+			_streamFrames[streamIt] =
+				streamIt == _primaryStream ? _imageOffset : stream.Timeline.FindFrame(streamTimeUs);
+
+			PlaybackHint& hint = _playbackHints[streamIt];
+			hint.Playhead = stream.FirstFrame + _streamFrames[streamIt];
+			hint.Direction = _autoPlay ? 1 : 0;
+			hint.Stride = glfwGetKey(_window, GLFW_KEY_LEFT_SHIFT) ? 10 : 1;
+			hint.Speed = _playbackSpeed / 100.0f;
+			hint.FirstFrame = stream.FirstFrame;
+			hint.FrameCount = stream.FrameCount;
+		}
+
 		// Draw one of the image frames
 		ImGui::BeginChild("SnapshotViewer", ImVec2(), false);
 
@@ -135,183 +247,484 @@ void FrameAnalyzerWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 		ImVec2 availCanvasSize = ImGui::GetContentRegionAvail();
 		float sliderHeight = ImGui::CalcTextSize("##dummy", nullptr, true).y;
 		sliderHeight += ImGui::GetStyle().FramePadding.y * 2.0f;
-		availCanvasSize.y -= sliderHeight * 2;						  // Two sliders
+		availCanvasSize.y -= sliderHeight * (_videoExportPending ? 6 : 5); // Rows of sliders (and export progress)
+		const float filmstripHeight = sliderHeight * 3.0f + ImGui::GetStyle().ScrollbarSize;
+		availCanvasSize.y -= filmstripHeight + ImGui::GetStyle().ItemSpacing.y; // Thumbnail strip
 		availCanvasSize.y -= ImGui::GetStyle().FramePadding.y * 2.0f; // Its own frame padding
+		const float statisticsHeight = _showStatistics ? sliderHeight * 5.0f : 0.0f;
+		if (_showStatistics) availCanvasSize.y -= statisticsHeight + ImGui::GetStyle().ItemSpacing.y; // Plots
 
-		// Maintain aspect-ratio and fit by touching the corners from within
-		ImVec2 imageDrawSize = availCanvasSize;
-		float hAlignOffset = 0.0f; // Horizontal alignment offset
-		float imageAspect = texture.Width / (float)texture.Height;
-		float availAspect = availCanvasSize.x / (float)availCanvasSize.y;
-		if (availAspect > imageAspect) // Canvas is wider than image (fit by height)
+		// Streams that have frames share the canvas, side by side or in a grid
+		vector<int> shownStreams;
+		for (int streamIt = 0; streamIt < streamCount; ++streamIt)
 		{
-			imageDrawSize.x = availCanvasSize.y * imageAspect;
-			hAlignOffset = (availCanvasSize.x - imageDrawSize.x) / 2.0f;
+			if (_streams[streamIt].FrameCount > 0) shownStreams.push_back(streamIt);
 		}
-		else // Canvas is taller than image (fit by width)
+		if (shownStreams.size() == 1)
 		{
-			imageDrawSize.y = availCanvasSize.x / imageAspect;
+			DrawStreamFrame(shownStreams[0], availCanvasSize, false);
+		}
+		else
+		{
+			const int shownCount = static_cast<int>(shownStreams.size());
+			const int columns = _streamLayout == StreamLayout::SideBySide
+									? shownCount
+									: static_cast<int>(ceilf(sqrtf(static_cast<float>(shownCount))));
+			const int rows = (shownCount + columns - 1) / columns;
+			const ImVec2 canvasPos = ImGui::GetCursorPos();
+			const ImVec2 cellSize(availCanvasSize.x / columns, availCanvasSize.y / rows);
+			for (int shownIt = 0; shownIt < shownCount; ++shownIt)
+			{
+				const int column = shownIt % columns;
+				const int row = shownIt / columns;
+				ImGui::SetCursorPos(ImVec2(canvasPos.x + column * cellSize.x, canvasPos.y + row * cellSize.y));
+				ImGui::PushID(shownStreams[shownIt]);
+				DrawStreamFrame(shownStreams[shownIt], cellSize, true);
+				ImGui::PopID();
+			}
+			ImGui::SetCursorPos(ImVec2(canvasPos.x, canvasPos.y + availCanvasSize.y + ImGui::GetStyle().ItemSpacing.y));
 		}
 
-		// Ensure the image is centered if it has any gaps because of aspect correction
-		ImGui::SetCursorPosX(hAlignOffset);
-		ImGui::Image(reinterpret_cast<void*>((intptr_t)texture.TextureId), imageDrawSize);
+		// Clicking a thumbnail jumps there and pauses, like stepping with the arrow keys
+		if (_filmstrip.Draw("##_filmstrip", filmstripHeight, primary.FirstFrame, size, _imageOffset))
+		{
+			_autoPlay = false;
+		}
 
-		ImGui::SetNextItemWidth(availCanvasSize.x);
-		ImGui::SliderInt("##_imageOffsetSlider", &_imageOffset, 0, size - 1, "Frame %d");
+		DrawFrameSlider(primary);
+		if (_showStatistics) DrawFrameStatistics(primary, availCanvasSize.x, statisticsHeight);
 		ImGui::SetNextItemWidth(availCanvasSize.x);
 		ImGui::DragFloat("##_playbackSpeedSlider", &_playbackSpeed, 1.0f, 1.0f, 1000.0f, "Playback Speed %.2f%%");
+		ImGui::SetNextItemWidth(availCanvasSize.x);
+		const string residentText =
+			fmt::format("Resident Frames %d ({0} uploaded in {1} arrays, {2:.1f}/{3:.1f} MB in memory)",
+				_frameResidency.GetResidentCount(), _frameResidency.GetTextureChunkCount(),
+				_deltaStore->GetStoredBytes() / (1024.0 * 1024.0), _deltaStore->GetEncodedBytes() / (1024.0 * 1024.0));
+		if (ImGui::DragInt("##_residentFramesSlider", &_residentFrames, 1.0f, 16, 4096, residentText.c_str()))
+		{
+			_frameResidency.SetWindowSize(_residentFrames);
+		}
+		if (_liveStream >= 0)
+		{
+			const string liveText = _liveFailedCount > 0 ? fmt::format("Follow Live ({0} failed)", _liveFailedCount)
+														 : string("Follow Live");
+			ImGui::Checkbox(liveText.c_str(), &_followLive);
+			ImGui::SameLine();
+		}
+		ImGui::Checkbox("Statistics", &_showStatistics);
+		ImGui::SameLine();
+		ImGui::Checkbox("Change Heatmap", &_showChangeHeatmap);
+		ImGui::SameLine();
+		const float layoutWidth = shownStreams.size() > 1 ? availCanvasSize.x * 0.2f : 0.0f;
+		ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - layoutWidth);
+		ImGui::DragInt("##_heatmapFramesSlider", &_heatmapFrames, 1.0f, 1, 1000, "Over the Last %d Frames");
+		if (shownStreams.size() > 1)
+		{
+			ImGui::SameLine();
+			ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+			ImGui::Combo("##_streamLayoutCombo", reinterpret_cast<int*>(&_streamLayout), "Side by Side\0Grid\0");
+		}
+		DrawFrameSearch(availCanvasSize.x);
+		DrawVideoExport(availCanvasSize.x);
 		ImGui::EndChild();
 	}
 	ImGui::End();
 }
 
-void FrameAnalyzerWindow::DrawLoadingFramesModal()
+void FrameAnalyzerWindow::DrawStreamFrame(int streamIndex, ImVec2 canvasSize, bool showName)
 {
-	if (_loadFramesList.empty() && _syncImageUploadQueue.empty()) return;
+	const FrameStream& stream = _streams[streamIndex];
+	const int frameIndex = stream.FirstFrame + _streamFrames[streamIndex];
+	const ImVec2 cellPos = ImGui::GetCursorPos();
 
-	// This is our first time showing the modal, trigger it up
-	if (_loadFrameIt == 0)
+	// Name of the stream on top of its frame, the primary one is highlighted
+	if (showName)
 	{
-		ImGui::OpenPopup("Loading Frames");
+		const ImVec4 nameColor = ImGui::GetStyleColorVec4(
+			streamIndex == _primaryStream ? ImGuiCol_PlotHistogram : ImGuiCol_TextDisabled);
+		ImGui::TextColored(nameColor, "%s (Frame %d)", stream.Name.c_str(), _streamFrames[streamIndex]);
+		canvasSize.y -= ImGui::GetTextLineHeightWithSpacing();
 	}
 
-	// Show loading modal at center
-	ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize;
-	ImGuiViewport* viewport = ImGui::GetMainViewport();
-	ImGui::SetNextWindowPos(viewport->GetCenter(), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-	if (ImGui::BeginPopupModal("Loading Frames", nullptr, flags))
+	// Show the closest resident frame while the current one is not uploaded
+	int shownFrameIndex = frameIndex;
+	const FrameLayer frameLayer =
+		_frameResidency.AcquireTexture(_playbackHints[streamIndex], frameIndex, shownFrameIndex);
+	const FrameTexture& shownTexture = _textures[shownFrameIndex];
+
+	// Maintain aspect-ratio and fit by touching the corners from within
+	ImVec2 imageDrawSize = canvasSize;
+	float hAlignOffset = 0.0f; // Horizontal alignment offset
+	float imageAspect = shownTexture.Width / (float)shownTexture.Height;
+	float availAspect = canvasSize.x / (float)canvasSize.y;
+	if (availAspect > imageAspect) // Canvas is wider than image (fit by height)
+	{
+		imageDrawSize.x = canvasSize.y * imageAspect;
+		hAlignOffset = (canvasSize.x - imageDrawSize.x) / 2.0f;
+	}
+	else // Canvas is taller than image (fit by width)
 	{
-		size_t loadingListSize = _loadFramesList.size();
+		imageDrawSize.y = canvasSize.x / imageAspect;
+	}
 
-		// We only flush if there are more than 32 texture in the buffer or there are less than 32 textures
-		// remaining. This ensures we don't keep locking the async tasks too often to pull from the buffer.
-		if (_uploadImageBuff.size() > 32 || (loadingListSize - _loadFrameIt) <= 32)
+	// Ensure the image is centered if it has any gaps because of aspect correction
+	if (frameLayer.TextureId != 0)
+	{
+		ImGui::SetCursorPosX(cellPos.x + hAlignOffset);
+		FrameLayerImage(frameLayer, imageDrawSize);
+		if (_showChangeHeatmap && streamIndex == _primaryStream)
 		{
-			_uploadImageLock.lock();
-			_uploadImageDeque.insert(_uploadImageDeque.end(), _uploadImageBuff.begin(), _uploadImageBuff.end());
-			_uploadImageBuff.clear();
-			_uploadImageLock.unlock();
+			DrawChangeHeatmap(shownTexture, ImGui::GetItemRectMin(), ImGui::GetItemRectMax());
 		}
+	}
+	else
+	{
+		ImGui::Dummy(imageDrawSize);
+	}
+
+	// Clicking another stream makes it the primary one, it keeps the frame it is showing
+	if (showName && streamIndex != _primaryStream && ImGui::IsItemClicked())
+	{
+		_primaryStream = streamIndex;
+		_imageOffset = _streamFrames[streamIndex];
+		_playbackFrame = _imageOffset;
+	}
+}
 
-		if (!_uploadImageDeque.empty())
+double FrameAnalyzerWindow::GetRedrawDelay() const
+{
+	// The loading modal shows progress and the residency keeps uploading around the playheads, both every frame
+	if (_showLoadingModal || !_frameResidency.IsSettled()) return 0.0;
+	const double exportDelay = _videoExportPending ? ExportProgressDelay : RedrawScheduler::NoDeadline;
+	if (!ShouldShow || !_autoPlay || _textures.empty()) return exportDelay;
+
+	// Playing back, the next frame is due when one of the streams moves to its next capture (or playback loops)
+	double totalTimeUs = 0.0;
+	for (const FrameStream& stream : _streams)
+	{
+		const int64_t streamEndUs = GetStreamOffset(stream) + stream.Timeline.GetTotalTime();
+		totalTimeUs = max(totalTimeUs, static_cast<double>(streamEndUs));
+	}
+	double delayUs = totalTimeUs - _playbackTimeUs;
+	for (const FrameStream& stream : _streams)
+	{
+		if (stream.FrameCount == 0) continue;
+
+		const double streamTimeUs = _playbackTimeUs - GetStreamOffset(stream);
+		const int frameIndex = stream.Timeline.FindFrame(static_cast<int64_t>(streamTimeUs));
+		if (streamTimeUs < 0.0)
+		{
+			delayUs = min(delayUs, -streamTimeUs);
+		}
+		else if (frameIndex + 1 < stream.FrameCount)
 		{
-			constexpr int jobsMaxCount = 32;
-			const int jobsCount = min(jobsMaxCount, (int)_uploadImageDeque.size());
-			LoadImageJob uploadJobs[jobsMaxCount];
+			delayUs = min(delayUs, stream.Timeline.GetFrameTime(frameIndex + 1) - streamTimeUs);
+		}
+	}
+	return min(max(delayUs, 0.0) * 1.0e-6 / (_playbackSpeed / 100.0f), exportDelay);
+}
 
-			for (int jobsIt = 0; jobsIt < jobsCount; ++jobsIt)
-			{
-				uploadJobs[jobsIt] = std::forward<LoadImageJob>(_uploadImageDeque.front());
-				_uploadImageDeque.pop_front();
-			}
+int64_t FrameAnalyzerWindow::GetStreamOffset(const FrameStream& stream) const
+{
+	// Streams without timestamps start with the earliest one
+	if (stream.Timeline.GetOriginTime() < 0) return 0;
 
-			// Filter for failed load jobs
-			int uploadCount = 0;
-			for (int jobsIt = 0; jobsIt < jobsCount; ++jobsIt)
-			{
-				// We increment the load iterator regardless of loading
-				// success as it is used to track operation completness
-				++_loadFrameIt;
-
-				// Check for failed jobs
-				LoadImageJob& job = uploadJobs[jobsIt];
-				if (job.ImageData == nullptr)
-				{
-					// Error handling
-					pfd::message openImageDialog("Open Image Error",
-						fmt::format("Couldn't Load Image: {0}", job.ImagePath), pfd::choice::ok, pfd::icon::error);
-					continue;
-				}
-
-				// Only those that didn't fail are uploaded
-				++uploadCount;
-			}
+	int64_t earliestOriginUs = stream.Timeline.GetOriginTime();
+	for (const FrameStream& other : _streams)
+	{
+		const int64_t originUs = other.Timeline.GetOriginTime();
+		if (originUs >= 0) earliestOriginUs = min(earliestOriginUs, originUs);
+	}
+	return stream.Timeline.GetOriginTime() - earliestOriginUs;
+}
+
+int FrameAnalyzerWindow::FindStream(int frameIndex) const
+{
+	for (int streamIt = 0; streamIt < static_cast<int>(_streams.size()); ++streamIt)
+	{
+		const FrameStream& stream = _streams[streamIt];
+		if (frameIndex >= stream.FirstFrame && frameIndex < stream.FirstFrame + stream.FrameCount) return streamIt;
+	}
+	return -1;
+}
+
+void FrameAnalyzerWindow::DrawChangeHeatmap(const FrameTexture& texture, ImVec2 imageMin, ImVec2 imageMax)
+{
+	if (texture.DeltaFrameIndex < 0) return;
+
+	// Change counts only move with the frame or the accumulation length
+	const int lastFrame = texture.DeltaFrameIndex;
+	if (lastFrame != _heatmapFrame || _heatmapFrames != _heatmapFrameCount)
+	{
+		_heatmapFrame = lastFrame;
+		_heatmapFrameCount = _heatmapFrames;
+		_heatmapMaxCount = 0;
+		if (!_deltaStore->AccumulateChanges(lastFrame - _heatmapFrames + 1, lastFrame, _heatmapCounts, _heatmapTilesX,
+				_heatmapTilesY))
+		{
+			_heatmapCounts.clear();
+		}
+		for (uint16_t count : _heatmapCounts)
+		{
+			_heatmapMaxCount = max(_heatmapMaxCount, (int)count);
+		}
+	}
+	if (_heatmapMaxCount == 0) return;
+
+	// Tiles are drawn in image space, the last row and column may be partially outside the frame
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	const float tileWidth = FrameDeltaStore::TileSize * (imageMax.x - imageMin.x) / texture.Width;
+	const float tileHeight = FrameDeltaStore::TileSize * (imageMax.y - imageMin.y) / texture.Height;
+	for (int tileY = 0; tileY < _heatmapTilesY; ++tileY)
+	{
+		for (int tileX = 0; tileX < _heatmapTilesX; ++tileX)
+		{
+			const uint16_t count = _heatmapCounts[tileY * _heatmapTilesX + tileX];
+			if (count == 0) continue;
+
+			const float heat = count / (float)_heatmapMaxCount;
+			const ImVec2 tileMin(imageMin.x + tileX * tileWidth, imageMin.y + tileY * tileHeight);
+			const ImVec2 tileMax(min(tileMin.x + tileWidth, imageMax.x), min(tileMin.y + tileHeight, imageMax.y));
+			const ImVec4 heatColor(1.0f, 1.0f - heat, 0.0f, 0.2f + 0.4f * heat);
+			drawList->AddRectFilled(tileMin, tileMax, ImGui::GetColorU32(heatColor));
+		}
+	}
+}
+
+void FrameAnalyzerWindow::DrawFrameSlider(FrameStream& stream)
+{
+	const int frameCount = stream.FrameCount;
+	if (ImGui::Button(_showTimeSlider ? "Time" : "Index"))
+	{
+		_showTimeSlider = !_showTimeSlider;
+	}
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+
+	// Seeking by time is a binary search over the frame start times
+	const double totalTimeSec = stream.Timeline.GetTotalTime() * 1.0e-6;
+	if (_showTimeSlider)
+	{
+		float frameTimeSec = static_cast<float>(stream.Timeline.GetFrameTime(_imageOffset) * 1.0e-6);
+		const string timeText = fmt::format("%.3f s (Frame {0}, {1:.1f} ms)", _imageOffset,
+			stream.Timeline.GetFrameDuration(_imageOffset) * 1.0e-3);
+		if (ImGui::SliderFloat("##_playbackTimeSlider", &frameTimeSec, 0.0f, static_cast<float>(totalTimeSec),
+				timeText.c_str()))
+		{
+			_imageOffset = stream.Timeline.FindFrame(static_cast<int64_t>(frameTimeSec * 1.0e6));
+		}
+	}
+	else
+	{
+		ImGui::SliderInt("##_imageOffsetSlider", &_imageOffset, 0, frameCount - 1, "Frame %d");
+	}
 
-			// Generate OpenGL image handle
-			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	// Hitches are drawn over the slider as gaps, sized by their duration on the time slider
+	if (_frameLoader.IsLoading() || totalTimeSec <= 0.0) return;
 
-			unsigned int pixelBuffIds[jobsMaxCount];
-			glGenBuffers(uploadCount, pixelBuffIds);
+	const ImVec2 sliderMin = ImGui::GetItemRectMin();
+	const ImVec2 sliderMax = ImGui::GetItemRectMax();
+	const float sliderWidth = sliderMax.x - sliderMin.x;
+	const ImU32 hitchColor = ImGui::GetColorU32(ImVec4(1.0f, 0.2f, 0.1f, 0.5f));
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	for (int frameIndex : stream.Timeline.GetHitches())
+	{
+		float hitchMin, hitchMax;
+		if (_showTimeSlider)
+		{
+			hitchMin = static_cast<float>(stream.Timeline.GetFrameTime(frameIndex) * 1.0e-6 / totalTimeSec);
+			hitchMax = static_cast<float>(stream.Timeline.GetFrameTime(frameIndex + 1) * 1.0e-6 / totalTimeSec);
+		}
+		else
+		{
+			hitchMin = hitchMax = frameIndex / (float)max(frameCount - 1, 1);
+		}
+		const float xMin = sliderMin.x + hitchMin * sliderWidth;
+		const float xMax = max(sliderMin.x + hitchMax * sliderWidth, xMin + 1.0f);
+		drawList->AddRectFilled(ImVec2(xMin, sliderMin.y), ImVec2(xMax, sliderMax.y), hitchColor);
+	}
+}
 
-			unsigned int textureIds[jobsMaxCount];
-			glGenTextures(uploadCount, textureIds);
+void FrameAnalyzerWindow::DrawFrameStatistics(const FrameStream& stream, float width, float height)
+{
+	const int frameCount = min(stream.FrameCount, _frameStatistics.GetFrameCount() - stream.FirstFrame);
+	if (frameCount <= 0)
+	{
+		ImGui::Dummy(ImVec2(width, height));
+		return;
+	}
+
+	// Series are plotted straight out of the contiguous arrays. Spikes of changed cells are frames that jumped
+	// (corrections, rubber-banding), while a flat zero is a freeze.
+	const ImPlotFlags plotFlags =
+		ImPlotFlags_NoTitle | ImPlotFlags_NoMenus | ImPlotFlags_NoBoxSelect | ImPlotFlags_NoMouseText;
+	const float histogramWidth = width * 0.2f;
+	int firstVisible = 0, lastVisible = frameCount - 1;
+	const ImVec2 seriesSize(width - histogramWidth - ImGui::GetStyle().ItemSpacing.x, height);
+	if (ImPlot::BeginPlot("##_frameStatisticsPlot", seriesSize, plotFlags))
+	{
+		// The view follows the frames coming in, and stays where the user put it otherwise
+		const ImPlotCond fitCondition = frameCount != _statisticsFrameCount ? ImPlotCond_Always : ImPlotCond_Once;
+		ImPlot::SetupAxes(nullptr, nullptr, 0, ImPlotAxisFlags_Lock);
+		ImPlot::SetupAxisLimits(ImAxis_X1, 0.0, max(frameCount - 1, 1), fitCondition);
+		ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0, ImPlotCond_Always);
+		ImPlot::SetupLegend(ImPlotLocation_NorthWest, ImPlotLegendFlags_Horizontal);
+		ImPlot::PlotLine("Mean Luminance", _frameStatistics.GetMeanLuma() + stream.FirstFrame, frameCount);
+		ImPlot::PlotLine("Changed Cells", _frameStatistics.GetChangedRatio() + stream.FirstFrame, frameCount);
 
-			// Upload CPU Data to Pixel Buffer Objects (for async transfer)
-			for (int jobsIt = 0, uploadIt = 0; jobsIt < jobsCount; ++jobsIt)
+		// The playhead drags like the frame slider
+		double playhead = _imageOffset;
+		if (ImPlot::DragLineX(0, &playhead, ImGui::GetStyleColorVec4(ImGuiCol_SliderGrabActive)))
+		{
+			_imageOffset = std::clamp(static_cast<int>(std::lround(playhead)), 0, frameCount - 1);
+			_autoPlay = false;
+		}
+
+		const ImPlotRect limits = ImPlot::GetPlotLimits();
+		firstVisible = std::clamp(static_cast<int>(std::ceil(limits.X.Min)), 0, frameCount - 1);
+		lastVisible = std::clamp(static_cast<int>(std::floor(limits.X.Max)), firstVisible, frameCount - 1);
+		ImPlot::EndPlot();
+	}
+	_statisticsFrameCount = frameCount;
+
+	// Histogram of the frames in view, only summed again when the view changes
+	const int histogramFirstFrame = stream.FirstFrame + firstVisible;
+	const int histogramFrameCount = lastVisible - firstVisible + 1;
+	if (histogramFirstFrame != _histogramFirstFrame || histogramFrameCount != _histogramFrameCount)
+	{
+		_frameStatistics.GetRangeHistogram(histogramFirstFrame, histogramFrameCount, _rangeHistogram);
+		_histogramFirstFrame = histogramFirstFrame;
+		_histogramFrameCount = histogramFrameCount;
+	}
+
+	ImGui::SameLine();
+	if (ImPlot::BeginPlot("##_rangeHistogramPlot", ImVec2(histogramWidth, height), plotFlags))
+	{
+		ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_NoTickLabels | ImPlotAxisFlags_Lock,
+			ImPlotAxisFlags_NoTickLabels | ImPlotAxisFlags_AutoFit);
+		ImPlot::SetupAxisLimits(ImAxis_X1, -0.5, LumaHistogramBins - 0.5, ImPlotCond_Always);
+		ImPlot::SetupLegend(ImPlotLocation_North);
+		const string label = fmt::format("Frames {0}-{1}###_rangeHistogram", firstVisible, lastVisible);
+		ImPlot::PlotBars(label.c_str(), _rangeHistogram, LumaHistogramBins, 1.0);
+		ImPlot::EndPlot();
+	}
+}
+
+void FrameAnalyzerWindow::DrawFrameSearch(float width)
+{
+	const float dragWidth = width * 0.15f;
+	const bool findSimilar = ImGui::Button("Similar Frames");
+	ImGui::SameLine();
+	const bool findFreezes = ImGui::Button("Freeze Runs");
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(dragWidth);
+	ImGui::DragInt("##_searchDistanceSlider", &_searchMaxDistance, 0.1f, 0, 32, "Within %d Bits");
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(dragWidth);
+	ImGui::DragInt("##_freezeFramesSlider", &_freezeMinFrames, 1.0f, 2, 10000, "At Least %d Frames");
+
+	// Both queries are linear scans over the hash array, cheap enough to run on the render thread
+	if (findSimilar || findFreezes)
+	{
+		using steadyClock = std::chrono::steady_clock;
+		const steadyClock::time_point start = steadyClock::now();
+		// Similar frames are searched in every stream (e.g. the client frame matching a server one), freezes only
+		// in the primary stream
+		const FrameStream& primary = _streams[_primaryStream];
+		const int currentFrame = primary.FirstFrame + _imageOffset;
+		if (findSimilar)
+		{
+			vector<int> frames;
+			_frameHashes.FindSimilar(_frameHashes.GetHash(currentFrame), _searchMaxDistance, frames);
+			_searchResults.clear();
+			for (int frameIndex : frames)
 			{
-				LoadImageJob& job = uploadJobs[jobsIt];
-				if (job.ImageData == nullptr) continue;
-
-				// Upload It only increments for valid upload jobs
-				unsigned int pixelBuffId = pixelBuffIds[uploadIt];
-				unsigned int textureId = textureIds[uploadIt];
-				uploadIt++;
-
-				// We got ourselves a frame (if the analyzer is not open, do it now)
-				ShouldShow = true;
-
-				// Upload image to Pixel Buffer Object
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffId);
-				const int textureSize = job.Width * job.Height * 3;
-				glBufferData(GL_PIXEL_UNPACK_BUFFER, textureSize, 0, GL_STREAM_DRAW);
-
-				// map the buffer object into client's memory
-				void* gpuAsyncData = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, textureSize,
-					GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
-				if (gpuAsyncData)
-				{
-					// Copy image memory to async stream buffer
-					memcpy(gpuAsyncData, job.ImageData, textureSize);
-
-					// Release the mapped buffer
-					glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-				}
-
-				// Free CPU memory resources
-				stbi_image_free(job.ImageData);
-
-				// Enqueu image for upload sync
-				_syncImageUploadQueue.emplace(std::forward<string>(job.ImagePath), job.Width, job.Height, pixelBuffId,
-					textureId);
+				if (frameIndex != currentFrame) _searchResults.push_back({frameIndex, frameIndex});
 			}
+		}
+		else
+		{
+			_frameHashes.FindFreezeRuns(primary.FirstFrame, primary.FrameCount, _searchMaxDistance, _freezeMinFrames,
+				_searchResults);
+		}
+		const double elapsedMs = std::chrono::duration<double, std::milli>(steadyClock::now() - start).count();
+		_searchSummary = fmt::format("{0} {1} ({2:.2f} ms)", _searchResults.size(),
+			findSimilar ? "Similar Frames" : "Freeze Runs", elapsedMs);
+	}
 
-			// Unbind any used OpenGL object
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-			glBindTexture(GL_TEXTURE_2D, 0);
+	// Picking a result jumps to it (making its stream the primary one) and pauses the playback
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+	if (ImGui::BeginCombo("##_searchResultsCombo", _searchSummary.c_str()))
+	{
+		for (const FrameRun& run : _searchResults)
+		{
+			const int streamIndex = FindStream(run.FirstFrame);
+			if (streamIndex < 0) continue;
+
+			const FrameStream& stream = _streams[streamIndex];
+			const int firstFrame = run.FirstFrame - stream.FirstFrame;
+			const int lastFrame = run.LastFrame - stream.FirstFrame;
+			const string label = run.FirstFrame == run.LastFrame
+									 ? fmt::format("{0} Frame {1}", stream.Name, firstFrame)
+									 : fmt::format("{0} Frames {1} - {2} ({3} frames)", stream.Name, firstFrame,
+										   lastFrame, lastFrame - firstFrame + 1);
+			const bool selected = streamIndex == _primaryStream && _imageOffset == firstFrame;
+			if (ImGui::Selectable(label.c_str(), selected))
+			{
+				_primaryStream = streamIndex;
+				_imageOffset = firstFrame;
+				_playbackFrame = -1;
+				_autoPlay = false;
+			}
 		}
+		ImGui::EndCombo();
+	}
+}
+
+void FrameAnalyzerWindow::DrawLoadingFramesModal()
+{
+	if (!_showLoadingModal) return;
+
+	// This is our first time showing the modal, trigger it up
+	if (_loadFrameIt == 0)
+	{
+		ImGui::OpenPopup("Loading Frames");
+	}
 
-		// Every frame we sync a number of frames from the sync queue
-		if (!_syncImageUploadQueue.empty())
+	// Show loading modal at center
+	ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize;
+	ImGuiViewport* viewport = ImGui::GetMainViewport();
+	ImGui::SetNextWindowPos(viewport->GetCenter(), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+	if (ImGui::BeginPopupModal("Loading Frames", nullptr, flags))
+	{
+		size_t loadingListSize = _frameLoader.GetFrameCount();
+
+		// Drain whatever the decoders handed off, this never waits on them
+		_frameLoader.PullLoadedFrames(_uploadImageDeque);
+
+		// Decoded frames are handed to the residency, which only uploads those around the playhead
+		while (!_uploadImageDeque.empty())
 		{
-			constexpr int syncMaxCount = 1;
-			const int syncCount = min(syncMaxCount, (int)_syncImageUploadQueue.size());
-			for (int syncIt = 0; syncIt < syncCount; syncIt++)
+			LoadImageJob job = std::move(_uploadImageDeque.front());
+			_uploadImageDeque.pop_front();
+
+			// We increment the load iterator regardless of loading
+			// success as it is used to track operation completness
+			++_loadFrameIt;
+
+			// Check for failed jobs
+			if (job.ImageData == nullptr)
 			{
-				const SyncImageUploadJob& job = _syncImageUploadQueue.front();
-
-				glBindTexture(GL_TEXTURE_2D, job.TextureId);
-				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, job.PixelBuffId);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB, job.Width, job.Height, 0, GL_RGB, GL_UNSIGNED_BYTE,
-					0);
-
-				// Parse file-name, extension and directory
-				string fileName, fileExt;
-				string directory = rv::splitFilename(job.ImagePath, fileName, fileExt);
-
-				// Hold snapshot resource
-				FrameTexture snapshot = {std::forward<string>(fileName), job.TextureId, job.Width, job.Height};
-				_textures.push_back(snapshot);
-				_syncImageUploadQueue.pop();
-
-				// Release Pixel Buffer Object
-				glDeleteBuffers(1, &job.PixelBuffId);
+				// Error handling
+				pfd::message openImageDialog("Open Image Error",
+					fmt::format("Couldn't Load Image: {0}", job.Source.ImagePath), pfd::choice::ok, pfd::icon::error);
+				continue;
 			}
 
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-			glBindTexture(GL_TEXTURE_2D, 0);
+			// We got ourselves a frame (if the analyzer is not open, do it now)
+			ShouldShow = true;
+			AddLoadedFrame(std::move(job));
 		}
 
 		// Display loading progress bar
@@ -324,61 +737,290 @@ void FrameAnalyzerWindow::DrawLoadingFramesModal()
 		ImGui::SetCursorPosX((windowWidth - textWidth) * 0.5f);
 		ImGui::Text("%s", progressText.c_str());
 
+		// Decoded pixels waiting for upload, the loader stalls while this is full
+		const PixelBudget& pixelBudget = _frameLoader.GetPixelBudget();
+		const float budgetUsage = pixelBudget.GetUsedBytes() / (float)pixelBudget.GetLimit();
+		string budgetText = fmt::format("Decoded Pixels {0:.1f}/{1:.0f} MB",
+			pixelBudget.GetUsedBytes() / (1024.0 * 1024.0), pixelBudget.GetLimit() / (1024.0 * 1024.0));
+		ImGui::ProgressBar(min(budgetUsage, 1.0f), ImVec2(-FLT_MIN, 0.0f), budgetText.c_str());
+
 		// Close popup condition
 		if (_loadFrameIt == loadingListSize)
 		{
 			ImGui::CloseCurrentPopup();
-
-			// Clear loading list
-			_loadFramesList.clear();
+			_showLoadingModal = false;
 		}
 
 		ImGui::EndPopup();
 	}
 }
+
+// Frame sequences are named after their file, loose frames after their directory
+static string GetStreamName(const string& framePath)
+{
+	string fileName;
+	string directory = rv::splitFilename(framePath, fileName);
+	if (FrameSequenceFile::IsFrameSequencePath(framePath) || directory.empty()) return fileName;
+
+	directory.pop_back();
+	string directoryName;
+	rv::splitFilename(directory, directoryName);
+	return directoryName.empty() ? fileName : directoryName;
+}
+
 void FrameAnalyzerWindow::ImportFrameSnapshots()
 {
 	const string title = "Import Frame Snapshot(s)";
-	const auto filters = vector<string>(
-		{"Image File(s) (*.jpeg,*.png,*.tga,*.bmp,*.gif)", "*.jpeg;*.png;*.tga;*.bmp;*.gif", "All Files", "*"});
+	const auto filters = vector<string>({"Image File(s) (*.jpeg,*.png,*.tga,*.bmp,*.gif)",
+		"*.jpeg;*.png;*.tga;*.bmp;*.gif", "Frame Sequence(s) (*.ufs)", "*.ufs", "All Files", "*"});
 	const pfd::opt options = pfd::opt::multiselect;
-	_loadFramesList = pfd::open_file(title, "C:/", filters, options).result();
+	vector<string> framePaths = pfd::open_file(title, "C:/", filters, options).result();
+	if (framePaths.empty()) return;
 
-	// Reset load iterator
-	_loadFrameIt = 0;
+	// The live stream ends here, imported frames form a stream of their own
+	StopWatchingSnapshots();
 
-	// Reserve texture slots, the load list will be loaded 1 image per frame
-	_textures.reserve(_textures.size() + _loadFramesList.size());
+	// Packed frame sequences are expanded into one source per frame
+	string error;
+	vector<FrameSource> frameSources;
+	if (!FrameLoader::ResolveFrameSources(framePaths, frameSources, &error))
+	{
+		pfd::message openSequenceDialog("Open Frame Sequence Error", fmt::format("Couldn't Open: {0}", error),
+			pfd::choice::ok, pfd::icon::error);
+		return;
+	}
 
-	// Use taskflow to create a parallel loading stage pipeflow with a serial thread-locked queued one
-	static tf::Pipeline _loadImagePipeline = tf::Pipeline(16,
-		tf::Pipe {tf::PipeType::SERIAL,
-			[&](tf::Pipeflow& pf)
-			{
-				// Stop emitting tokens if we reached loading queue end
-				if (pf.token() == _loadFramesList.size())
-				{
-					pf.stop();
-					return;
-				}
-
-				// Enqueue the image to be loaded from the pipe
-				_loadImagePipeData[pf.line()] = {_loadFramesList[pf.token()]};
-			}},
-		tf::Pipe {tf::PipeType::PARALLEL,
-			[&](tf::Pipeflow& pf)
-			{
-				LoadImageJob& job = _loadImagePipeData[pf.line()];
-				job.ImageData = stbi_load(job.ImagePath.c_str(), &job.Width, &job.Height, &job.NumComp, STBI_rgb);
-				job.NumComp = STBI_rgb;
-			}},
-		tf::Pipe {tf::PipeType::SERIAL, [&](tf::Pipeflow& pf)
-			{
-				LoadImageJob& job = _loadImagePipeData[pf.line()];
-				_uploadImageLock.lock();
-				_uploadImageBuff.push_back(std::forward<LoadImageJob>(job));
-				_uploadImageLock.unlock();
-			}});
-	_taskFlow.composed_of(_loadImagePipeline).name("pipeline");
-	_taskExecutor.run(_taskFlow);
+	// Reserve texture slots, the residency keeps a reference to the list
+	_textures.reserve(_textures.size() + frameSources.size());
+
+	// Every import is a stream of its own, played back in sync with the others
+	FrameStream stream;
+	stream.Name = GetStreamName(framePaths.front());
+	stream.FirstFrame = static_cast<int>(_textures.size());
+
+	// Frames are decoded by the loader pipeline and pulled by the loading modal
+	if (_frameLoader.Load(std::move(frameSources)))
+	{
+		_streams.push_back(std::move(stream));
+
+		// Reset load iterator
+		_loadFrameIt = 0;
+		_showLoadingModal = true;
+	}
+}
+
+bool FrameAnalyzerWindow::AddLoadedFrame(LoadImageJob&& job)
+{
+	if (job.ImageData == nullptr) return false;
+
+	// Parse file-name, extension and directory
+	string fileName, fileExt;
+	string directory = rv::splitFilename(job.Source.ImagePath, fileName, fileExt);
+
+	// Hold snapshot resource, the texture is created once the frame becomes resident
+	const int frameIndex = static_cast<int>(_textures.size());
+	_textures.push_back({std::move(fileName), job.Source, 0, job.Width, job.Height, job.DeltaFrameIndex});
+	_frameHashes.SetHash(frameIndex, job.PerceptualHash);
+
+	// Imports and live ingest never overlap, so the frames of the last stream stay contiguous
+	FrameStream& stream = _streams.back();
+	_frameStatistics.SetFrame(frameIndex, job.Statistics, GetChangedRatio(stream.LastStatistics, job.Statistics));
+	stream.LastStatistics = std::move(job.Statistics);
+	stream.FrameCount++;
+	stream.Timeline.Append(job.Source.TimestampUs);
+	if (!job.Thumbnail.empty())
+	{
+		_filmstrip.AddThumbnail(frameIndex, job.Thumbnail);
+	}
+	_frameResidency.OfferDecodedFrame(frameIndex, std::move(job));
+	return true;
+}
+
+void FrameAnalyzerWindow::WatchSnapshotDirectory()
+{
+	const string directory = pfd::select_folder("Watch Snapshot Directory", "C:/").result();
+	if (directory.empty() || _showLoadingModal) return;
+
+	string error;
+	if (!_directoryWatcher.Start(directory, &error))
+	{
+		pfd::message watchDialog("Watch Snapshot Directory Error", fmt::format("Couldn't Watch: {0}", error),
+			pfd::choice::ok, pfd::icon::error);
+		return;
+	}
+
+	// Snapshots written from now on form a stream of their own, the loader takes them in small batches
+	FrameStream stream;
+	stream.Name = fmt::format("{0} (Live)", GetStreamName(directory + "/"));
+	stream.FirstFrame = static_cast<int>(_textures.size());
+	_streams.push_back(std::move(stream));
+	_liveStream = static_cast<int>(_streams.size()) - 1;
+	_liveFailedCount = 0;
+	_followLive = true;
+	ShouldShow = true;
+}
+
+void FrameAnalyzerWindow::StopWatchingSnapshots()
+{
+	if (_liveStream < 0) return;
+
+	_directoryWatcher.Stop();
+	_livePendingPaths.clear();
+
+	// Frames already handed to the loader still belong to the live stream, the batch is small enough to be handed
+	// off whole before they are pulled
+	_frameLoader.Wait();
+	PullLiveFrames();
+	_liveStream = -1;
+}
+
+void FrameAnalyzerWindow::UpdateLiveIngest()
+{
+	if (_liveStream < 0) return;
+
+	// Files completed while the previous batch was decoding go in the next one, so a batch never waits for
+	// more than the one in flight and playback stays a couple of frames behind the game
+	_directoryWatcher.PullReadyFrames(_livePendingPaths);
+	if (!_frameLoader.IsLoading() && !_livePendingPaths.empty())
+	{
+		const size_t batchSize = min(_livePendingPaths.size(), MaxLiveBatchFrames);
+		const vector<string> batchPaths(_livePendingPaths.begin(), _livePendingPaths.begin() + batchSize);
+		vector<FrameSource> frameSources;
+		if (FrameLoader::ResolveFrameSources(batchPaths, frameSources))
+		{
+			_frameLoader.Load(std::move(frameSources));
+		}
+		_livePendingPaths.erase(_livePendingPaths.begin(), _livePendingPaths.begin() + batchSize);
+	}
+	PullLiveFrames();
+}
+
+void FrameAnalyzerWindow::PullLiveFrames()
+{
+	if (_frameLoader.PullLoadedFrames(_uploadImageDeque) == 0) return;
+
+	while (!_uploadImageDeque.empty())
+	{
+		LoadImageJob job = std::move(_uploadImageDeque.front());
+		_uploadImageDeque.pop_front();
+
+		// Snapshots are only reported once complete, but a game killed mid-write still leaves broken files
+		if (!AddLoadedFrame(std::move(job))) _liveFailedCount++;
+	}
+
+	// New frames pull the playhead along while following
+	if (_followLive && _streams[_liveStream].FrameCount > 0)
+	{
+		_primaryStream = _liveStream;
+	}
+}
+
+void FrameAnalyzerWindow::ExportVideo()
+{
+	// Other streams may hold frames while the primary one has none yet (a live stream being watched)
+	if (_streams.empty() || _streams[_primaryStream].FrameCount == 0)
+	{
+		pfd::message exportDialog("Export Video Error", "Couldn't Export: The primary stream has no frames",
+			pfd::choice::ok, pfd::icon::error);
+		return;
+	}
+
+	const string title = "Export Video";
+	const auto filters = vector<string>({"YUV4MPEG2 Video (*.y4m)", "*.y4m"});
+	string filePath = pfd::save_file(title, "C:/", filters).result();
+	if (filePath.empty()) return;
+	if (filePath.size() < 4 || filePath.compare(filePath.size() - 4, 4, ".y4m") != 0) filePath += ".y4m";
+
+	// The primary stream is exported, with the timing it was captured with
+	FrameStream& primary = _streams[_primaryStream];
+	vector<FrameSource> frameSources;
+	frameSources.reserve(primary.FrameCount);
+	for (int frameIt = 0; frameIt < primary.FrameCount; ++frameIt)
+	{
+		frameSources.push_back(_textures[primary.FirstFrame + frameIt].Source);
+	}
+	const FrameTexture& firstFrame = _textures[primary.FirstFrame];
+
+	string error;
+	if (!_videoExporter.Export(filePath, std::move(frameSources), primary.Timeline, firstFrame.Width,
+			firstFrame.Height, &error))
+	{
+		pfd::message exportDialog("Export Video Error", fmt::format("Couldn't Export: {0}", error), pfd::choice::ok,
+			pfd::icon::error);
+		return;
+	}
+	_videoExportPending = true;
+}
+
+void FrameAnalyzerWindow::DrawVideoExport(float width)
+{
+	if (!_videoExportPending) return;
+
+	// Decoding, conversion and writing overlap, so the rate is what reaches the disk
+	const size_t frameCount = _videoExporter.GetFrameCount();
+	const size_t writtenCount = _videoExporter.GetWrittenCount();
+	const double elapsedSeconds = max(_videoExporter.GetElapsedSeconds(), 1.0e-3);
+	const string progressText = fmt::format("Exporting Video {0}/{1} Frames ({2:.0f} MB/s)", writtenCount, frameCount,
+		_videoExporter.GetWrittenBytes() / (1024.0 * 1024.0) / elapsedSeconds);
+	const float cancelWidth = width * 0.15f;
+	ImGui::ProgressBar(writtenCount / (float)max(frameCount, size_t(1)),
+		ImVec2(width - cancelWidth - ImGui::GetStyle().ItemSpacing.x, 0.0f), progressText.c_str());
+	ImGui::SameLine();
+	if (ImGui::Button("Cancel Export", ImVec2(cancelWidth, 0.0f)))
+	{
+		_videoExporter.Cancel();
+	}
+}
+
+void FrameAnalyzerWindow::ReportVideoExport()
+{
+	if (!_videoExportPending || _videoExporter.IsExporting()) return;
+	_videoExportPending = false;
+
+	const string& error = _videoExporter.GetError();
+	if (!error.empty())
+	{
+		pfd::message exportDialog("Export Video Error", error, pfd::choice::ok, pfd::icon::error);
+		return;
+	}
+	const string summary = fmt::format("Wrote {0}/{1} frames ({2} failed to decode) to {3}, {4:.1f} MB in {5:.1f} s",
+		_videoExporter.GetWrittenCount(), _videoExporter.GetFrameCount(), _videoExporter.GetFailedCount(),
+		_videoExporter.GetFilePath(), _videoExporter.GetWrittenBytes() / (1024.0 * 1024.0),
+		_videoExporter.GetElapsedSeconds());
+	pfd::message exportDialog("Video Exported", summary, pfd::choice::ok, pfd::icon::info);
+}
+
+void FrameAnalyzerWindow::LoadSettings()
+{
+	// Load Settings
+	if (_settingsEntry->empty()) return;
+
+	int residentFrames = 0, pixelBudgetMB = 0, showTimeSlider = 0, showStatistics = 0;
+	const int readCount = sscanf(_settingsEntry->c_str(),
+		"ResidentFrames=%i|PixelBudgetMB=%i|ShowTimeSlider=%i|ShowStatistics=%i|", &residentFrames, &pixelBudgetMB,
+		&showTimeSlider, &showStatistics);
+	if (readCount < 1) return;
+
+	_residentFrames = residentFrames;
+	_frameResidency.SetWindowSize(_residentFrames);
+	if (readCount < 2) return;
+
+	_pixelBudgetMB = max(pixelBudgetMB, 1);
+	_frameLoader.GetPixelBudget().SetLimit(size_t(_pixelBudgetMB) << 20);
+	if (readCount < 3) return;
+
+	_showTimeSlider = showTimeSlider != 0;
+	if (readCount < 4) return;
+
+	_showStatistics = showStatistics != 0;
+}
+
+void FrameAnalyzerWindow::StoreSettings()
+{
+	if (_settingsEntry != nullptr)
+	{
+		_settingsEntry->assign(
+			fmt::format("ResidentFrames={0}|PixelBudgetMB={1}|ShowTimeSlider={2}|ShowStatistics={3}|", _residentFrames,
+				_pixelBudgetMB, _showTimeSlider ? 1 : 0, _showStatistics ? 1 : 0));
+	}
 }
@@ -0,0 +1,375 @@
+#include <app/frameBatchAnalysis.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+
+// Platform Includes
+#if WIN32
+	#include <windows.h>
+#endif
+
+// Third Party Includes
+#include <fmt/core.h>
+
+// Internal Includes
+#include <app/frameDeltaStore.h>
+#include <app/frameLoader.h>
+#include <app/frameSequenceFile.h>
+#include <app/frameTimeline.h>
+
+namespace fs = std::filesystem;
+using steadyClock = std::chrono::steady_clock;
+
+// Everything the report needs of a frame, its pixels are released as soon as it was compared to the next one
+struct FrameRecord
+{
+	string ImagePath;
+	int64_t TimestampUs;
+	float ChangeRatio; // Ratio of tiles that changed since the previous frame, 1 for the first one
+	bool Failed;
+};
+
+struct StreamReport
+{
+	string Input;
+	vector<FrameRecord> Frames;
+	FrameHashIndex Hashes;
+	FrameTimeline Timeline;
+	vector<FrameRun> FreezeRuns;
+	vector<int> Duplicates; // Frames whose blocks are identical to the previous frame
+	size_t FailedCount = 0;
+	double WallTimeSec = 0.0;
+};
+
+// The application is linked as a windowed program, reports printed from a console need to attach to it
+static void AttachParentConsole()
+{
+#if WIN32
+	if (GetStdHandle(STD_OUTPUT_HANDLE) == nullptr && AttachConsole(ATTACH_PARENT_PROCESS))
+	{
+		freopen("CONOUT$", "w", stdout);
+		freopen("CONOUT$", "w", stderr);
+	}
+#endif
+}
+
+// Frames of a capture directory in file name order, the same formats the import dialog accepts
+static bool ListCaptureFrames(const string& directory, vector<string>& framePaths, string* error)
+{
+	std::error_code errorCode;
+	for (const fs::directory_entry& entry : fs::directory_iterator(directory, errorCode))
+	{
+		string ext = entry.path().extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+		if (ext == ".png" || ext == ".tga" || ext == ".bmp" || ext == ".jpeg" || ext == ".jpg" || ext == ".gif")
+		{
+			framePaths.push_back(entry.path().string());
+		}
+	}
+	if (errorCode)
+	{
+		if (error != nullptr) *error = fmt::format("{0}: {1}", directory, errorCode.message());
+		return false;
+	}
+	std::sort(framePaths.begin(), framePaths.end());
+	return true;
+}
+
+static string EscapeJson(const string& text)
+{
+	string escaped;
+	escaped.reserve(text.size());
+	for (const char c : text)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			escaped += fmt::format("\\u{0:04x}", static_cast<int>(c));
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+bool IsFrameBatchCommand(int argc, char** argv) { return argc > 1 && string(argv[1]) == "--analyze"; }
+
+// The whole text has to be a number that fits, a sign is only accepted by signed types
+template <typename T>
+static bool ParseNumber(const char* text, T& value)
+{
+	const char* end = text + strlen(text);
+	const std::from_chars_result result = std::from_chars(text, end, value);
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+bool ParseFrameBatchArguments(int argc, char** argv, FrameBatchOptions& options, string* error)
+{
+	auto fail = [&](const string& reason)
+	{
+		if (error != nullptr) *error = reason;
+		return false;
+	};
+
+	for (int i = 2; i < argc; ++i)
+	{
+		const string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		bool validValue = true;
+		if (arg == "--report" && hasValue) options.ReportPath = argv[++i];
+		else if (arg == "--threads" && hasValue) validValue = ParseNumber(argv[++i], options.ThreadCount);
+		else if (arg == "--budget" && hasValue) validValue = ParseNumber(argv[++i], options.BudgetMB);
+		else if (arg == "--freeze-distance" && hasValue) validValue = ParseNumber(argv[++i], options.FreezeMaxDistance);
+		else if (arg == "--freeze-change" && hasValue) validValue = ParseNumber(argv[++i], options.FreezeMaxChange);
+		else if (arg == "--freeze-frames" && hasValue) validValue = ParseNumber(argv[++i], options.FreezeMinFrames);
+		else if (arg.rfind("--", 0) == 0) return fail(fmt::format("Unknown argument: {0}", arg));
+		else options.Inputs.push_back(arg);
+
+		if (!validValue) return fail(fmt::format("Invalid value for {0}: {1}", arg, argv[i]));
+	}
+
+	if (options.Inputs.empty()) return fail("No capture directory or frame sequence given");
+	return true;
+}
+
+void PrintFrameBatchUsage(const string& error)
+{
+	AttachParentConsole();
+	fmt::print(stderr, "{0}\nUsage: UE4NetworkTool --analyze CAPTURE_DIR|SEQUENCE.ufs... [--report REPORT.json] "
+					   "[--threads N] [--budget MB] [--freeze-distance BITS] [--freeze-change RATIO] "
+					   "[--freeze-frames N]\n",
+		error);
+}
+
+// Runs of frames that hold the picture: within FreezeMaxDistance bits of the run's first frame (as the Frame Analyzer
+// search) and with at most FreezeMaxChange of their tiles changed since the previous frame. The hash alone misses
+// small moving objects, the tiles see them. Failed frames end runs.
+static void FindFreezeRuns(const FrameBatchOptions& options, StreamReport& report)
+{
+	report.FreezeRuns.clear();
+	const vector<FrameRecord>& frames = report.Frames;
+	const int frameCount = static_cast<int>(frames.size());
+	int runStart = 0;
+	for (int frameIt = 1; frameIt <= frameCount; ++frameIt)
+	{
+		const bool holds = frameIt < frameCount && !frames[runStart].Failed && !frames[frameIt].Failed &&
+						   frames[frameIt].ChangeRatio <= options.FreezeMaxChange &&
+						   GetHashDistance(report.Hashes.GetHash(frameIt), report.Hashes.GetHash(runStart)) <=
+							   options.FreezeMaxDistance;
+		if (holds) continue;
+
+		if (!frames[runStart].Failed && frameIt - runStart >= max(options.FreezeMinFrames, 2))
+		{
+			report.FreezeRuns.push_back({runStart, frameIt - 1});
+		}
+		runStart = frameIt;
+	}
+}
+
+static bool AnalyzeStream(tf::Executor& executor, const FrameBatchOptions& options, StreamReport& report,
+	string* error)
+{
+	std::error_code errorCode;
+	if (!fs::exists(report.Input, errorCode))
+	{
+		if (error != nullptr) *error = fmt::format("{0}: No such file or directory", report.Input);
+		return false;
+	}
+
+	vector<string> framePaths;
+	if (fs::is_directory(report.Input, errorCode))
+	{
+		if (!ListCaptureFrames(report.Input, framePaths, error)) return false;
+	}
+	else
+	{
+		framePaths.push_back(report.Input);
+	}
+
+	vector<FrameSource> frameSources;
+	if (!FrameLoader::ResolveFrameSources(framePaths, frameSources, error)) return false;
+
+	// The loader wakes this thread up after every frame it hands off (declared before it, it calls back until it's
+	// destroyed)
+	std::mutex handOffLock;
+	std::condition_variable handedOff;
+	size_t handedOffCount = 0;
+
+	// Block compressed frames are what the analyzer keeps, so the change ratios match its heatmap
+	FrameLoader frameLoader(executor);
+	frameLoader.SetHandOffCallback(
+		[&]()
+		{
+			{
+				std::lock_guard<std::mutex> lock(handOffLock);
+				handedOffCount++;
+			}
+			handedOff.notify_one();
+		});
+	frameLoader.SetPixelFormat(FramePixelFormat::BC1);
+	if (options.BudgetMB != 0) frameLoader.GetPixelBudget().SetLimit(options.BudgetMB << 20);
+
+	// Pull frames as they are handed off, only the previous one is held to compare the next against
+	std::deque<LoadImageJob> uploadDeque;
+	LoadImageJob previous;
+	const size_t frameCount = frameSources.size();
+	report.Frames.reserve(frameCount);
+	steadyClock::time_point start = steadyClock::now();
+	frameLoader.Load(std::move(frameSources));
+	while (report.Frames.size() < frameCount)
+	{
+		{
+			std::unique_lock<std::mutex> lock(handOffLock);
+			handedOff.wait(lock, [&]() { return handedOffCount > report.Frames.size(); });
+		}
+		if (frameLoader.PullLoadedFrames(uploadDeque) == 0) continue;
+
+		for (LoadImageJob& job : uploadDeque)
+		{
+			const int frameIndex = static_cast<int>(report.Frames.size());
+			FrameRecord record = {std::move(job.Source.ImagePath), job.Source.TimestampUs, 1.0f, false};
+			if (job.ImageData == nullptr)
+			{
+				record.Failed = true;
+				report.FailedCount++;
+			}
+			else if (previous.ImageData != nullptr && previous.Width == job.Width && previous.Height == job.Height)
+			{
+				record.ChangeRatio = GetTileChangeRatio(static_cast<const uint8_t*>(job.ImageData),
+					static_cast<const uint8_t*>(previous.ImageData), job.Width, job.Height);
+				if (record.ChangeRatio == 0.0f) report.Duplicates.push_back(frameIndex);
+			}
+
+			// Failed frames have no hash, they end freeze runs and keep the last decoded frame as reference
+			report.Hashes.SetHash(frameIndex, record.Failed ? 0 : job.PerceptualHash);
+			report.Timeline.Append(record.TimestampUs);
+			report.Frames.push_back(std::move(record));
+
+			if (job.ImageData != nullptr)
+			{
+				FrameLoader::ReleaseImageData(previous);
+				previous = std::move(job);
+				job.ImageData = nullptr;
+			}
+		}
+		uploadDeque.clear();
+	}
+	FrameLoader::ReleaseImageData(previous);
+	frameLoader.Wait();
+	report.WallTimeSec = std::chrono::duration<double>(steadyClock::now() - start).count();
+
+	FindFreezeRuns(options, report);
+	return true;
+}
+
+static void WriteStreamReport(StreamReport& report, string& json)
+{
+	FrameTimeline& timeline = report.Timeline;
+	json += fmt::format("\t\t{{\n\t\t\t\"input\": \"{0}\",\n", EscapeJson(report.Input));
+	json += fmt::format("\t\t\t\"frameCount\": {0},\n\t\t\t\"failedFrames\": {1},\n", report.Frames.size(),
+		report.FailedCount);
+	json += fmt::format("\t\t\t\"wallTimeSec\": {0:.3f},\n\t\t\t\"hasTimestamps\": {1},\n", report.WallTimeSec,
+		timeline.HasTimestamps());
+	const int64_t medianFrameUs = timeline.GetMedianDuration(); // Also what the total time is extended by
+	json += fmt::format("\t\t\t\"medianFrameUs\": {0},\n\t\t\t\"totalTimeUs\": {1},\n", medianFrameUs,
+		timeline.GetTotalTime());
+
+	json += "\t\t\t\"freezeRuns\": [";
+	for (size_t runIt = 0; runIt < report.FreezeRuns.size(); ++runIt)
+	{
+		const FrameRun& run = report.FreezeRuns[runIt];
+		const int64_t durationUs = timeline.GetFrameTime(run.LastFrame) + timeline.GetFrameDuration(run.LastFrame) -
+								   timeline.GetFrameTime(run.FirstFrame);
+		json += fmt::format("{0}{{\"firstFrame\": {1}, \"lastFrame\": {2}, \"durationUs\": {3}}}",
+			runIt == 0 ? "" : ", ", run.FirstFrame, run.LastFrame, durationUs);
+	}
+
+	json += "],\n\t\t\t\"duplicateFrames\": [";
+	for (size_t duplicateIt = 0; duplicateIt < report.Duplicates.size(); ++duplicateIt)
+	{
+		json += fmt::format("{0}{1}", duplicateIt == 0 ? "" : ", ", report.Duplicates[duplicateIt]);
+	}
+
+	// Gaps are the frames held HitchFactor times longer than the median frame
+	json += "],\n\t\t\t\"timestampGaps\": [";
+	const vector<int>& hitches = timeline.GetHitches();
+	for (size_t hitchIt = 0; hitchIt < hitches.size(); ++hitchIt)
+	{
+		json += fmt::format("{0}{{\"frame\": {1}, \"durationUs\": {2}}}", hitchIt == 0 ? "" : ", ", hitches[hitchIt],
+			timeline.GetFrameDuration(hitches[hitchIt]));
+	}
+
+	json += "],\n\t\t\t\"frames\": [\n";
+	for (size_t frameIt = 0; frameIt < report.Frames.size(); ++frameIt)
+	{
+		const FrameRecord& frame = report.Frames[frameIt];
+		const int frameIndex = static_cast<int>(frameIt);
+		json += fmt::format("\t\t\t\t{{\"path\": \"{0}\", \"timeUs\": {1}, \"timestampUs\": {2}, "
+							"\"changeRatio\": {3:.4f}, \"hash\": \"{4:016x}\", \"failed\": {5}}}{6}\n",
+			EscapeJson(frame.ImagePath), timeline.GetFrameTime(frameIndex), frame.TimestampUs, frame.ChangeRatio,
+			report.Hashes.GetHash(frameIndex), frame.Failed, frameIt + 1 < report.Frames.size() ? "," : "");
+	}
+	json += "\t\t\t]\n\t\t}";
+}
+
+int RunFrameBatchAnalysis(const FrameBatchOptions& options)
+{
+	AttachParentConsole();
+
+	// Inputs are analyzed one after the other, each of them spreading its frames over every worker
+	const size_t threadCount = options.ThreadCount != 0 ? options.ThreadCount : std::thread::hardware_concurrency();
+	tf::Executor executor(max(threadCount, size_t(1)));
+	vector<StreamReport> reports(options.Inputs.size());
+	size_t failedCount = 0;
+	for (size_t inputIt = 0; inputIt < options.Inputs.size(); ++inputIt)
+	{
+		StreamReport& report = reports[inputIt];
+		report.Input = options.Inputs[inputIt];
+
+		string error;
+		if (!AnalyzeStream(executor, options, report, &error))
+		{
+			fmt::print(stderr, "Couldn't Open: {0}\n", error);
+			return 1;
+		}
+		failedCount += report.FailedCount;
+		fmt::print(stderr, "{0}: {1} frames in {2:.2f} s ({3} failed, {4} freeze runs, {5} duplicates, {6} gaps)\n",
+			report.Input, report.Frames.size(), report.WallTimeSec, report.FailedCount, report.FreezeRuns.size(),
+			report.Duplicates.size(), report.Timeline.GetHitches().size());
+	}
+
+	string json = fmt::format("{{\n\t\"workerThreads\": {0},\n\t\"freezeMaxDistance\": {1},\n"
+							  "\t\"freezeMaxChange\": {2},\n\t\"freezeMinFrames\": {3},\n\t\"streams\": [\n",
+		executor.num_workers(), options.FreezeMaxDistance, options.FreezeMaxChange, options.FreezeMinFrames);
+	for (size_t reportIt = 0; reportIt < reports.size(); ++reportIt)
+	{
+		WriteStreamReport(reports[reportIt], json);
+		json += reportIt + 1 < reports.size() ? ",\n" : "\n";
+	}
+	json += "\t]\n}\n";
+
+	FILE* reportFile = options.ReportPath.empty() ? stdout : fopen(options.ReportPath.c_str(), "wb");
+	if (reportFile == nullptr)
+	{
+		fmt::print(stderr, "Couldn't Write: {0}\n", options.ReportPath);
+		return 1;
+	}
+	fwrite(json.data(), 1, json.size(), reportFile);
+	if (reportFile != stdout) fclose(reportFile);
+	return failedCount > 0 ? 2 : 0;
+}
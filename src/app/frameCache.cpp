@@ -0,0 +1,238 @@
+#include <app/frameCache.h>
+
+// StdLib Includes
+#include <cstring>
+#include <filesystem>
+
+// Third Party Includes
+#include <fmt/core.h>
+
+// Internal Includes
+#include <app/thumbnail.h>
+
+namespace fs = std::filesystem;
+
+// FNV-1a, image paths are short and hashed once per frame
+static uint64_t HashPath(const string& path)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (char c : path)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// End of the frame data in frames.dat, past its blocks, thumbnail and statistics
+static uint64_t GetEntryEnd(const FrameCacheEntry& entry)
+{
+	return entry.Offset + entry.BlocksSize + entry.ThumbnailSize + entry.StatisticsSize;
+}
+
+FrameCache::~FrameCache() { Close(); }
+
+bool FrameCache::Open(const string& directory, string* error)
+{
+	Close();
+
+	std::error_code errorCode;
+	fs::create_directories(directory, errorCode);
+	_directory = directory;
+	_dataPath = (fs::path(directory) / "frames.dat").string();
+	_indexPath = (fs::path(directory) / "frames.idx").string();
+
+	// Anything but a current index whose entries all point into the data file (which a crash in between writing
+	// both could leave behind) starts over, as does a cache that outgrew its limit
+	bool isValid = false;
+	if (FILE* index = fopen(_indexPath.c_str(), "rb"))
+	{
+		FrameCacheHeader header;
+		isValid = fread(&header, sizeof(header), 1, index) == 1 &&
+				  memcmp(header.Magic, FrameCacheMagic, sizeof(header.Magic)) == 0 &&
+				  header.Version == FrameCacheVersion && header.ThumbnailWidth == uint32_t(ThumbnailWidth) &&
+				  header.ThumbnailHeight == uint32_t(ThumbnailHeight);
+		fclose(index);
+	}
+	const uintmax_t indexSize = fs::file_size(_indexPath, errorCode);
+	isValid = isValid && (indexSize - sizeof(FrameCacheHeader)) % sizeof(FrameCacheEntry) == 0;
+	const uintmax_t dataSize = fs::file_size(_dataPath, errorCode);
+	isValid = isValid && !errorCode && dataSize <= _limitBytes;
+
+	_dataSize = isValid ? dataSize : 0;
+	_indexReadBytes = sizeof(FrameCacheHeader);
+	if (isValid)
+	{
+		_data.Open(_dataPath);
+		ReadIndex();
+		for (const auto& entry : _entries)
+		{
+			if (GetEntryEnd(entry.second) > _data.GetSize())
+			{
+				isValid = false;
+				break;
+			}
+		}
+	}
+	if (!isValid)
+	{
+		Clear();
+	}
+	else
+	{
+		OpenWriters();
+	}
+
+	if (!IsOpen())
+	{
+		if (error != nullptr) *error = fmt::format("{0}: Unable to open the frame cache", directory);
+		return false;
+	}
+	return true;
+}
+
+void FrameCache::Close()
+{
+	if (_dataWriter != nullptr) fclose(_dataWriter);
+	if (_indexWriter != nullptr) fclose(_indexWriter);
+	_dataWriter = nullptr;
+	_indexWriter = nullptr;
+	_data.Close();
+	_entries.clear();
+}
+
+void FrameCache::Clear()
+{
+	// Mapped files can't be deleted everywhere, let go of everything first
+	Close();
+	std::error_code errorCode;
+	fs::remove(_dataPath, errorCode);
+	fs::remove(_indexPath, errorCode);
+	_dataSize = 0;
+	_indexReadBytes = sizeof(FrameCacheHeader);
+	if (!_directory.empty()) OpenWriters();
+}
+
+void FrameCache::Refresh()
+{
+	if (!IsOpen()) return;
+
+	// Entries are only read back once their data is in the file and the mapping covers it
+	fflush(_dataWriter);
+	fflush(_indexWriter);
+	if (_dataSize > _data.GetSize()) _data.Open(_dataPath);
+	ReadIndex();
+}
+
+const FrameCacheEntry* FrameCache::Find(const FrameFingerprint& fingerprint) const
+{
+	auto entry = _entries.find(fingerprint.PathHash);
+	if (entry == _entries.end()) return nullptr;
+
+	// Same path but the file changed since (or frames.dat couldn't be mapped again)
+	const FrameCacheEntry& cached = entry->second;
+	if (cached.FileSize != fingerprint.FileSize || cached.WriteTime != fingerprint.WriteTime ||
+		GetEntryEnd(cached) > _data.GetSize())
+	{
+		return nullptr;
+	}
+	return &cached;
+}
+
+bool FrameCache::Add(const FrameFingerprint& fingerprint, const uint8_t* blocks, size_t blocksSize,
+	const uint8_t* thumbnail, size_t thumbnailSize, const uint8_t* statistics, size_t statisticsSize, int width,
+	int height, uint64_t perceptualHash)
+{
+	if (!IsOpen() || fingerprint.FileSize == 0) return false;
+	if (_dataSize + blocksSize + thumbnailSize + statisticsSize > _limitBytes) return false;
+
+	FrameCacheEntry entry;
+	entry.PathHash = fingerprint.PathHash;
+	entry.FileSize = fingerprint.FileSize;
+	entry.WriteTime = fingerprint.WriteTime;
+	entry.Offset = _dataSize;
+	entry.BlocksSize = static_cast<uint32_t>(blocksSize);
+	entry.ThumbnailSize = static_cast<uint32_t>(thumbnailSize);
+	entry.Width = static_cast<uint32_t>(width);
+	entry.Height = static_cast<uint32_t>(height);
+	entry.PerceptualHash = perceptualHash;
+	entry.StatisticsSize = static_cast<uint32_t>(statisticsSize);
+	entry.Reserved = 0;
+
+	// A failed write leaves data no entry points to, stop adding so offsets never go out of sync with the file
+	if (fwrite(blocks, 1, blocksSize, _dataWriter) != blocksSize ||
+		(thumbnailSize > 0 && fwrite(thumbnail, 1, thumbnailSize, _dataWriter) != thumbnailSize) ||
+		(statisticsSize > 0 && fwrite(statistics, 1, statisticsSize, _dataWriter) != statisticsSize) ||
+		fwrite(&entry, sizeof(entry), 1, _indexWriter) != 1)
+	{
+		fclose(_dataWriter);
+		fclose(_indexWriter);
+		_dataWriter = nullptr;
+		_indexWriter = nullptr;
+		return false;
+	}
+	_dataSize += blocksSize + thumbnailSize + statisticsSize;
+	return true;
+}
+
+bool FrameCache::GetFingerprint(const string& filePath, const string& key, FrameFingerprint& fingerprint)
+{
+	std::error_code errorCode;
+	const fs::directory_entry file(filePath, errorCode);
+	const uintmax_t fileSize = file.file_size(errorCode);
+	if (errorCode) return false;
+	const fs::file_time_type writeTime = file.last_write_time(errorCode);
+	if (errorCode) return false;
+
+	fingerprint.PathHash = HashPath(key);
+	fingerprint.FileSize = static_cast<uint64_t>(fileSize);
+	fingerprint.WriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+	return true;
+}
+
+string FrameCache::GetDefaultDirectory()
+{
+	std::error_code errorCode;
+	const fs::path tempDirectory = fs::temp_directory_path(errorCode);
+	return (errorCode ? fs::path("FrameCache") : tempDirectory / "UE4NetworkTool" / "FrameCache").string();
+}
+
+bool FrameCache::OpenWriters()
+{
+	_dataWriter = fopen(_dataPath.c_str(), "ab");
+	_indexWriter = fopen(_indexPath.c_str(), "ab");
+	if (_dataWriter == nullptr || _indexWriter == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	// A new index starts with its header
+	std::error_code errorCode;
+	if (fs::file_size(_indexPath, errorCode) == 0)
+	{
+		FrameCacheHeader header = {{}, FrameCacheVersion, ThumbnailWidth, ThumbnailHeight};
+		memcpy(header.Magic, FrameCacheMagic, sizeof(header.Magic));
+		fwrite(&header, sizeof(header), 1, _indexWriter);
+	}
+	return true;
+}
+
+void FrameCache::ReadIndex()
+{
+	FILE* index = fopen(_indexPath.c_str(), "rb");
+	if (index == nullptr) return;
+
+	// Only whole entries are taken, a partially written one is picked up by the next refresh
+	FrameCacheEntry entries[256];
+	fseek(index, static_cast<long>(_indexReadBytes), SEEK_SET);
+	for (size_t readCount; (readCount = fread(entries, sizeof(FrameCacheEntry), 256, index)) > 0;)
+	{
+		for (size_t entryIt = 0; entryIt < readCount; ++entryIt)
+		{
+			_entries[entries[entryIt].PathHash] = entries[entryIt];
+		}
+		_indexReadBytes += readCount * sizeof(FrameCacheEntry);
+	}
+	fclose(index);
+}
@@ -0,0 +1,171 @@
+#include <app/frameDecoder.h>
+
+// StdLib Includes
+#include <array>
+#include <csetjmp>
+#include <cstdlib>
+#include <cstring>
+
+// Third Party Includes
+#include <stb_image.h>
+#include <UEViewer/libs/libpng/png.h>
+
+// The bundled zlib leaves its allocators and messages to the host (UnCoreCompression.cpp in the application),
+// headless tools that link the frame pipeline without UEViewer get plain ones
+#if FRAME_PIPELINE_STANDALONE
+extern "C" void* zcalloc(void* /*opaque*/, unsigned items, unsigned size) { return calloc(items, size); }
+extern "C" void zcfree(void* /*opaque*/, void* ptr) { free(ptr); }
+extern "C" const char* const z_errmsg[10] = {"need dictionary", "stream end", "", "file error", "stream error",
+	"data error", "insufficient memory", "buffer error", "incompatible version", ""};
+#endif
+
+FrameImageFormat DetectFrameImageFormat(const uint8_t* data, size_t size)
+{
+	static const uint8_t pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	if (size >= 8 && memcmp(data, pngSignature, 8) == 0) return FrameImageFormat::Png;
+	if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF) return FrameImageFormat::Jpeg;
+	if (size >= 2 && data[0] == 'B' && data[1] == 'M') return FrameImageFormat::Bmp;
+	if (size >= 4 && memcmp(data, "GIF8", 4) == 0) return FrameImageFormat::Gif;
+	return FrameImageFormat::Tga;
+}
+
+class StbFrameDecoder : public FrameDecoder
+{
+  public:
+	FrameDecoderBackend GetBackend() const override { return FrameDecoderBackend::Stb; }
+
+	bool ReadSize(const uint8_t* data, size_t size, int& width, int& height) const override
+	{
+		int numComp;
+		return stbi_info_from_memory(data, static_cast<int>(size), &width, &height, &numComp) != 0;
+	}
+
+	// stb_image only decodes into its own allocation, rows are copied out of it
+	bool DecodeRGB(const uint8_t* data, size_t size, uint8_t* destination, size_t rowPitch) const override
+	{
+		int width, height, numComp;
+		stbi_uc* pixels = stbi_load_from_memory(data, static_cast<int>(size), &width, &height, &numComp, STBI_rgb);
+		if (pixels == nullptr) return false;
+
+		const size_t rowSize = size_t(width) * STBI_rgb;
+		if (rowPitch == rowSize)
+		{
+			memcpy(destination, pixels, rowSize * height);
+		}
+		else
+		{
+			for (int y = 0; y < height; ++y)
+			{
+				memcpy(destination + y * rowPitch, pixels + y * rowSize, rowSize);
+			}
+		}
+		stbi_image_free(pixels);
+		return true;
+	}
+};
+
+// Encoded bytes libpng pulls from, PNG_STDIO_SUPPORTED is off in the bundled build
+struct PngMemoryReader
+{
+	const uint8_t* Data;
+	size_t Size;
+	size_t Offset;
+};
+
+static void OnPngRead(png_structp png, png_bytep output, png_size_t length)
+{
+	PngMemoryReader* reader = static_cast<PngMemoryReader*>(png_get_io_ptr(png));
+	if (reader->Size - reader->Offset < length) png_error(png, "Truncated PNG");
+
+	memcpy(output, reader->Data + reader->Offset, length);
+	reader->Offset += length;
+}
+
+static void OnPngError(png_structp png, png_const_charp /*message*/) { png_longjmp(png, 1); }
+static void OnPngWarning(png_structp /*png*/, png_const_charp /*message*/) {}
+
+class PngFrameDecoder : public FrameDecoder
+{
+  public:
+	FrameDecoderBackend GetBackend() const override { return FrameDecoderBackend::LibPng; }
+
+	bool ReadSize(const uint8_t* data, size_t size, int& width, int& height) const override
+	{
+		// Width and height are the first fields of the IHDR chunk, right after the signature
+		if (size < 24 || DetectFrameImageFormat(data, size) != FrameImageFormat::Png) return false;
+		width = static_cast<int>(png_get_uint_32(data + 16));
+		height = static_cast<int>(png_get_uint_32(data + 20));
+		return width > 0 && height > 0;
+	}
+
+	// Rows are inflated, unfiltered and converted to RGB8 by libpng one at a time, straight into the destination.
+	// No C++ objects live in here, libpng errors longjmp out.
+	bool DecodeRGB(const uint8_t* data, size_t size, uint8_t* destination, size_t rowPitch) const override
+	{
+		png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, OnPngError, OnPngWarning);
+		if (png == nullptr) return false;
+		png_infop info = png_create_info_struct(png);
+		if (info == nullptr || setjmp(png_jmpbuf(png)))
+		{
+			png_destroy_read_struct(&png, &info, nullptr);
+			return false;
+		}
+
+		PngMemoryReader reader = {data, size, 0};
+		png_set_read_fn(png, &reader, OnPngRead);
+		png_set_crc_action(png, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE);
+		png_set_option(png, PNG_IGNORE_ADLER32, PNG_OPTION_ON);
+		png_read_info(png, info);
+
+		// Whatever the PNG holds (palette, grayscale, alpha, 16 bits) comes out as RGB8
+		const png_byte colorType = png_get_color_type(png, info);
+		png_set_expand(png);
+		png_set_strip_16(png);
+		png_set_strip_alpha(png);
+		if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA) png_set_gray_to_rgb(png);
+		const int passCount = png_set_interlace_handling(png);
+		png_read_update_info(png, info);
+
+		const png_uint_32 width = png_get_image_width(png, info);
+		const png_uint_32 height = png_get_image_height(png, info);
+		if (png_get_rowbytes(png, info) != size_t(width) * 3 || rowPitch < size_t(width) * 3)
+		{
+			png_destroy_read_struct(&png, &info, nullptr);
+			return false;
+		}
+
+		// Interlaced frames are read in passes over the same rows, libpng combines them in place
+		for (int passIt = 0; passIt < passCount; ++passIt)
+		{
+			for (png_uint_32 y = 0; y < height; ++y)
+			{
+				png_read_row(png, destination + y * rowPitch, nullptr);
+			}
+		}
+		png_destroy_read_struct(&png, &info, nullptr);
+		return true;
+	}
+};
+
+static const StbFrameDecoder stbDecoder;
+static const PngFrameDecoder pngDecoder;
+static std::array<const FrameDecoder*, static_cast<size_t>(FrameImageFormat::Count)> formatDecoders = {
+	&pngDecoder, // Png
+	&stbDecoder, // Jpeg
+	&stbDecoder, // Bmp
+	&stbDecoder, // Gif
+	&stbDecoder, // Tga
+};
+
+const FrameDecoder& GetFrameDecoder(FrameImageFormat format) { return *formatDecoders[static_cast<size_t>(format)]; }
+
+void SetFrameDecoderBackend(FrameImageFormat format, FrameDecoderBackend backend)
+{
+	const bool usePng = backend == FrameDecoderBackend::LibPng && format == FrameImageFormat::Png;
+	formatDecoders[static_cast<size_t>(format)] = usePng ? static_cast<const FrameDecoder*>(&pngDecoder) : &stbDecoder;
+}
+
+const char* GetFrameDecoderBackendName(FrameDecoderBackend backend)
+{
+	return backend == FrameDecoderBackend::LibPng ? "libpng" : "stb_image";
+}
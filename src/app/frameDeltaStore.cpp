@@ -0,0 +1,273 @@
+#include <app/frameDeltaStore.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+// Internal Includes
+#include <app/blockCompression.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define DELTA_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define DELTA_USE_SSE2 0
+#endif
+
+#if _MSC_VER
+	#include <intrin.h>
+#endif
+
+// Block rectangle of a tile, tiles at the right and bottom borders may be partial
+struct TileRect
+{
+	int BlockX, BlockY;
+	int BlocksWide, BlocksHigh;
+};
+
+static TileRect GetTileRect(uint32_t tileIndex, int blocksX, int blocksY)
+{
+	const int tilesX = (blocksX + FrameDeltaStore::TileBlocks - 1) / FrameDeltaStore::TileBlocks;
+	TileRect rect;
+	rect.BlockX = static_cast<int>(tileIndex % tilesX) * FrameDeltaStore::TileBlocks;
+	rect.BlockY = static_cast<int>(tileIndex / tilesX) * FrameDeltaStore::TileBlocks;
+	rect.BlocksWide = std::min(FrameDeltaStore::TileBlocks, blocksX - rect.BlockX);
+	rect.BlocksHigh = std::min(FrameDeltaStore::TileBlocks, blocksY - rect.BlockY);
+	return rect;
+}
+
+static bool BytesEqual(const uint8_t* lhs, const uint8_t* rhs, size_t size)
+{
+#if DELTA_USE_SSE2
+	size_t offset = 0;
+	for (; offset + 16 <= size; offset += 16)
+	{
+		const __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + offset)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + offset)));
+		if (_mm_movemask_epi8(equal) != 0xFFFF) return false;
+	}
+	return offset == size || memcmp(lhs + offset, rhs + offset, size - offset) == 0;
+#else
+	return memcmp(lhs, rhs, size) == 0;
+#endif
+}
+
+static bool TileEquals(const uint8_t* lhs, const uint8_t* rhs, const TileRect& rect, int blocksX)
+{
+	const size_t rowSize = rect.BlocksWide * BC1BlockSize;
+	for (int row = 0; row < rect.BlocksHigh; ++row)
+	{
+		const size_t offset = (static_cast<size_t>(rect.BlockY + row) * blocksX + rect.BlockX) * BC1BlockSize;
+		if (!BytesEqual(lhs + offset, rhs + offset, rowSize)) return false;
+	}
+	return true;
+}
+
+static int CountTrailingZeros(uint64_t value)
+{
+#if _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+float GetTileChangeRatio(const uint8_t* bc1Blocks, const uint8_t* previousBc1Blocks, int width, int height)
+{
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+	const int tilesX = (blocksX + FrameDeltaStore::TileBlocks - 1) / FrameDeltaStore::TileBlocks;
+	const int tilesY = (blocksY + FrameDeltaStore::TileBlocks - 1) / FrameDeltaStore::TileBlocks;
+	const uint32_t tileCount = static_cast<uint32_t>(tilesX * tilesY);
+	if (tileCount == 0) return 0.0f;
+
+	uint32_t changedTileCount = 0;
+	for (uint32_t tileIt = 0; tileIt < tileCount; ++tileIt)
+	{
+		const TileRect rect = GetTileRect(tileIt, blocksX, blocksY);
+		if (!TileEquals(bc1Blocks, previousBc1Blocks, rect, blocksX)) changedTileCount++;
+	}
+	return changedTileCount / static_cast<float>(tileCount);
+}
+
+FrameDeltaStore::FrameDeltaStore(int keyframeInterval) : _keyframeInterval(std::max(keyframeInterval, 1)) {}
+
+int FrameDeltaStore::AddFrame(const uint8_t* bc1Blocks, int width, int height)
+{
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+	const int tilesX = (blocksX + TileBlocks - 1) / TileBlocks;
+	const int tilesY = (blocksY + TileBlocks - 1) / TileBlocks;
+	const uint32_t tileCount = static_cast<uint32_t>(tilesX * tilesY);
+	const size_t frameSize = GetBC1DataSize(width, height);
+
+	// Stored frames are never modified, so the writer reads them without locking
+	const int frameIndex = static_cast<int>(_frames.size());
+	const StoredFrame* previous = _frames.empty() ? nullptr : &_frames.back();
+	const bool sameSize = previous != nullptr && previous->Width == width && previous->Height == height;
+
+	StoredFrame frame;
+	frame.Width = width;
+	frame.Height = height;
+	frame.ChangeMask.assign((tileCount + 63) / 64, 0);
+	for (uint32_t tileIt = 0; tileIt < tileCount; ++tileIt)
+	{
+		const TileRect rect = GetTileRect(tileIt, blocksX, blocksY);
+		if (sameSize && TileEquals(bc1Blocks, _previousBlocks.data(), rect, blocksX)) continue;
+
+		frame.ChangeMask[tileIt / 64] |= uint64_t(1) << (tileIt % 64);
+		frame.ChangedTileCount++;
+	}
+
+	// Deltas are always taken against the keyframe, so decoding never walks a chain of frames
+	const int keyframeIndex = previous != nullptr ? previous->KeyframeIndex : -1;
+	bool isKeyframe = !sameSize || frameIndex - keyframeIndex >= _keyframeInterval;
+	if (!isKeyframe)
+	{
+		const uint8_t* keyframeBlocks = _frames[keyframeIndex].Blocks.data();
+		for (uint32_t tileIt = 0; tileIt < tileCount; ++tileIt)
+		{
+			const TileRect rect = GetTileRect(tileIt, blocksX, blocksY);
+			if (!TileEquals(bc1Blocks, keyframeBlocks, rect, blocksX)) frame.Tiles.push_back(tileIt);
+		}
+
+		// Once half the frame drifted from the keyframe a new keyframe is cheaper
+		isKeyframe = frame.Tiles.size() * 2 > tileCount;
+	}
+
+	if (isKeyframe)
+	{
+		frame.KeyframeIndex = frameIndex;
+		frame.Tiles.clear();
+		frame.Blocks.assign(bc1Blocks, bc1Blocks + frameSize);
+	}
+	else
+	{
+		frame.KeyframeIndex = keyframeIndex;
+		frame.Tiles.shrink_to_fit();
+		for (uint32_t tileIndex : frame.Tiles)
+		{
+			const TileRect rect = GetTileRect(tileIndex, blocksX, blocksY);
+			for (int row = 0; row < rect.BlocksHigh; ++row)
+			{
+				const uint8_t* rowBlocks =
+					bc1Blocks + (static_cast<size_t>(rect.BlockY + row) * blocksX + rect.BlockX) * BC1BlockSize;
+				frame.Blocks.insert(frame.Blocks.end(), rowBlocks, rowBlocks + rect.BlocksWide * BC1BlockSize);
+			}
+		}
+	}
+	_previousBlocks.assign(bc1Blocks, bc1Blocks + frameSize);
+
+	const size_t storedBytes = frame.Blocks.size() + frame.Tiles.size() * sizeof(uint32_t) +
+							   frame.ChangeMask.size() * sizeof(uint64_t);
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	_frames.push_back(std::move(frame));
+	_storedBytes += storedBytes;
+	_encodedBytes += frameSize;
+	return frameIndex;
+}
+
+bool FrameDeltaStore::DecodeFrame(int frameIndex, uint8_t* bc1Blocks) const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	if (frameIndex < 0 || frameIndex >= static_cast<int>(_frames.size())) return false;
+
+	const StoredFrame& frame = _frames[frameIndex];
+	const StoredFrame& keyframe = _frames[frame.KeyframeIndex];
+	memcpy(bc1Blocks, keyframe.Blocks.data(), keyframe.Blocks.size());
+	if (frame.KeyframeIndex == frameIndex) return true;
+
+	const int blocksX = (frame.Width + 3) / 4;
+	const int blocksY = (frame.Height + 3) / 4;
+	const uint8_t* tileBlocks = frame.Blocks.data();
+	for (uint32_t tileIndex : frame.Tiles)
+	{
+		const TileRect rect = GetTileRect(tileIndex, blocksX, blocksY);
+		const size_t rowSize = rect.BlocksWide * BC1BlockSize;
+		for (int row = 0; row < rect.BlocksHigh; ++row)
+		{
+			const size_t offset = (static_cast<size_t>(rect.BlockY + row) * blocksX + rect.BlockX) * BC1BlockSize;
+			memcpy(bc1Blocks + offset, tileBlocks, rowSize);
+			tileBlocks += rowSize;
+		}
+	}
+	return true;
+}
+
+bool FrameDeltaStore::AccumulateChanges(int firstFrame, int lastFrame, vector<uint16_t>& counts, int& tilesX,
+	int& tilesY) const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	if (lastFrame < 0 || lastFrame >= static_cast<int>(_frames.size())) return false;
+
+	const StoredFrame& reference = _frames[lastFrame];
+	tilesX = ((reference.Width + 3) / 4 + TileBlocks - 1) / TileBlocks;
+	tilesY = ((reference.Height + 3) / 4 + TileBlocks - 1) / TileBlocks;
+	counts.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+
+	for (int frameIt = std::max(firstFrame, 0); frameIt <= lastFrame; ++frameIt)
+	{
+		const StoredFrame& frame = _frames[frameIt];
+		if (frame.Width != reference.Width || frame.Height != reference.Height) continue;
+
+		for (size_t wordIt = 0; wordIt < frame.ChangeMask.size(); ++wordIt)
+		{
+			for (uint64_t bits = frame.ChangeMask[wordIt]; bits != 0; bits &= bits - 1)
+			{
+				counts[wordIt * 64 + CountTrailingZeros(bits)]++;
+			}
+		}
+	}
+	return true;
+}
+
+void FrameDeltaStore::Clear()
+{
+	std::unique_lock<std::shared_mutex> lock(_lock);
+	_frames.clear();
+	_previousBlocks.clear();
+	_storedBytes = 0;
+	_encodedBytes = 0;
+}
+
+int FrameDeltaStore::GetFrameCount() const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	return static_cast<int>(_frames.size());
+}
+
+bool FrameDeltaStore::GetFrameSize(int frameIndex, int& width, int& height) const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	if (frameIndex < 0 || frameIndex >= static_cast<int>(_frames.size())) return false;
+
+	width = _frames[frameIndex].Width;
+	height = _frames[frameIndex].Height;
+	return true;
+}
+
+float FrameDeltaStore::GetChangeRatio(int frameIndex) const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	if (frameIndex < 0 || frameIndex >= static_cast<int>(_frames.size())) return 0.0f;
+
+	const StoredFrame& frame = _frames[frameIndex];
+	const int tilesX = ((frame.Width + 3) / 4 + TileBlocks - 1) / TileBlocks;
+	const int tilesY = ((frame.Height + 3) / 4 + TileBlocks - 1) / TileBlocks;
+	return frame.ChangedTileCount / static_cast<float>(tilesX * tilesY);
+}
+
+size_t FrameDeltaStore::GetStoredBytes() const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	return _storedBytes;
+}
+
+size_t FrameDeltaStore::GetEncodedBytes() const
+{
+	std::shared_lock<std::shared_mutex> lock(_lock);
+	return _encodedBytes;
+}
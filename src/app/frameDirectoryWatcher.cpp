@@ -0,0 +1,202 @@
+#include <app/frameDirectoryWatcher.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+
+// Platform Includes
+#if __linux__
+	#include <poll.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+// Third Party Includes
+#include <fmt/core.h>
+
+namespace fs = std::filesystem;
+
+FrameDirectoryWatcher::~FrameDirectoryWatcher() { Stop(); }
+
+bool FrameDirectoryWatcher::Start(const string& directory, string* error)
+{
+	Stop();
+
+	std::error_code errorCode;
+	if (!fs::is_directory(directory, errorCode))
+	{
+		if (error != nullptr) *error = fmt::format("{0}: Not a directory", directory);
+		return false;
+	}
+
+	_directory = directory;
+	_stopRequested = false;
+	_pendingFiles.clear();
+	_knownFiles.clear();
+
+	// Subscribe before listing what is already there, so a file written in between is never missed
+	_polling = true;
+#if __linux__
+	_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_notifyFd >= 0 && inotify_add_watch(_notifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0)
+	{
+		_polling = false;
+	}
+	else if (_notifyFd >= 0)
+	{
+		close(_notifyFd);
+		_notifyFd = -1;
+	}
+#endif
+
+	ScanDirectory(ScanKind::Initial);
+	_thread = std::thread([this]() { _polling ? PollLoop() : NotifyLoop(); });
+	return true;
+}
+
+void FrameDirectoryWatcher::Stop()
+{
+	_stopRequested = true;
+	if (_thread.joinable()) _thread.join();
+
+#if __linux__
+	if (_notifyFd >= 0) close(_notifyFd);
+#endif
+	_notifyFd = -1;
+
+	std::lock_guard<std::mutex> lock(_readyLock);
+	_readyFrames.clear();
+}
+
+size_t FrameDirectoryWatcher::PullReadyFrames(vector<string>& framePaths)
+{
+	std::lock_guard<std::mutex> lock(_readyLock);
+	const size_t readyCount = _readyFrames.size();
+	framePaths.insert(framePaths.end(), std::make_move_iterator(_readyFrames.begin()),
+		std::make_move_iterator(_readyFrames.end()));
+	_readyFrames.clear();
+	return readyCount;
+}
+
+bool FrameDirectoryWatcher::IsFrameFileName(const string& fileName)
+{
+	const size_t extPos = fileName.find_last_of('.');
+	if (extPos == string::npos) return false;
+
+	string ext = fileName.substr(extPos);
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+	return ext == ".png" || ext == ".tga" || ext == ".bmp" || ext == ".jpeg" || ext == ".jpg" || ext == ".gif";
+}
+
+void FrameDirectoryWatcher::NotifyLoop()
+{
+#if __linux__
+	alignas(inotify_event) char buffer[16 * 1024];
+	pollfd notifyPoll = {_notifyFd, POLLIN, 0};
+	while (!_stopRequested)
+	{
+		// Wake up every poll interval to check for Stop
+		bool eventsDropped = false;
+		if (poll(&notifyPoll, 1, PollIntervalMs) > 0)
+		{
+			const ssize_t readSize = read(_notifyFd, buffer, sizeof(buffer));
+			for (ssize_t offset = 0; offset < readSize;)
+			{
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+				offset += sizeof(inotify_event) + event->len;
+				if ((event->mask & IN_Q_OVERFLOW) != 0) eventsDropped = true;
+				if (event->len == 0 || (event->mask & IN_ISDIR) != 0 || !IsFrameFileName(event->name)) continue;
+
+				// Closing after a write or a rename into the directory is the file being complete
+				const string framePath = (fs::path(_directory) / event->name).string();
+				_pendingFiles.erase(framePath);
+				if (_knownFiles.insert(framePath).second) MarkReady(framePath);
+			}
+		}
+
+		// Files whose events were dropped are found by their size, as when polling. So are the files that were
+		// being written when watching started (they may have been closed before the watch was added).
+		if (eventsDropped) ScanDirectory(ScanKind::NewFiles);
+		else if (!_pendingFiles.empty()) ScanDirectory(ScanKind::PendingFiles);
+	}
+#endif
+}
+
+void FrameDirectoryWatcher::PollLoop()
+{
+	while (!_stopRequested)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(PollIntervalMs));
+		ScanDirectory(ScanKind::NewFiles);
+	}
+}
+
+void FrameDirectoryWatcher::ScanDirectory(ScanKind scanKind)
+{
+	const steadyClock::time_point now = steadyClock::now();
+	vector<string> completedFrames;
+
+	std::error_code errorCode;
+	for (const fs::directory_entry& entry : fs::directory_iterator(_directory, errorCode))
+	{
+		const string framePath = entry.path().string();
+		if (_knownFiles.count(framePath) != 0 || !IsFrameFileName(entry.path().filename().string())) continue;
+
+		std::error_code sizeError;
+		const uintmax_t size = entry.file_size(sizeError);
+		if (sizeError) continue;
+
+		// Files still being written keep growing, they are only known once their size held still for a while
+		auto pending = _pendingFiles.find(framePath);
+		if (pending == _pendingFiles.end())
+		{
+			if (scanKind != ScanKind::PendingFiles)
+			{
+				_pendingFiles[framePath] = {size, now, now, scanKind == ScanKind::Initial};
+			}
+			continue;
+		}
+
+		PendingFile& file = pending->second;
+		file.LastSeen = now;
+		if (file.Size != size || size == 0)
+		{
+			// Files growing after watching started are new frames, whenever they were created
+			if (file.Size != size) file.Initial = false;
+			file.Size = size;
+			file.StableSince = now;
+			continue;
+		}
+		if (now - file.StableSince < std::chrono::milliseconds(DebounceMs)) continue;
+
+		if (!file.Initial) completedFrames.push_back(framePath);
+		_pendingFiles.erase(pending);
+		_knownFiles.insert(framePath);
+	}
+
+	// Files deleted before they were complete are forgotten
+	if (!errorCode && scanKind != ScanKind::Initial)
+	{
+		for (auto pending = _pendingFiles.begin(); pending != _pendingFiles.end();)
+		{
+			pending = pending->second.LastSeen != now ? _pendingFiles.erase(pending) : std::next(pending);
+		}
+	}
+
+	// Frames completed within the same scan are reported in file name order (captures are numbered)
+	std::sort(completedFrames.begin(), completedFrames.end());
+	for (const string& framePath : completedFrames)
+	{
+		MarkReady(framePath);
+	}
+}
+
+void FrameDirectoryWatcher::MarkReady(const string& framePath)
+{
+	{
+		std::lock_guard<std::mutex> lock(_readyLock);
+		_readyFrames.push_back(framePath);
+	}
+	if (_onReady) _onReady();
+}
@@ -0,0 +1,138 @@
+#include <app/frameFilmstrip.h>
+
+// StdLib Includes
+#include <algorithm>
+
+// Third Party Includes
+#include <glad/glad.h>
+#include <imgui/imgui.h>
+
+// Internal Includes
+#include <app/blockCompression.h>
+
+// Not part of the core profile loader, but exposed by every desktop driver
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+FrameFilmstrip::~FrameFilmstrip() { Clear(); }
+
+void FrameFilmstrip::AddThumbnail(int frameIndex, const vector<uint8_t>& bc1Thumbnail)
+{
+	if (frameIndex < 0 || bc1Thumbnail.size() != GetBC1DataSize(ThumbnailWidth, ThumbnailHeight)) return;
+
+	// Atlases are allocated on demand, uninitialized until their slots are filled
+	const size_t atlasIndex = frameIndex / ThumbnailsPerAtlas;
+	while (_atlasTextures.size() <= atlasIndex)
+	{
+		unsigned int atlasId;
+		glGenTextures(1, &atlasId);
+		glBindTexture(GL_TEXTURE_2D, atlasId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, AtlasSize, AtlasSize, 0,
+			static_cast<GLsizei>(GetBC1DataSize(AtlasSize, AtlasSize)), nullptr);
+		_atlasTextures.push_back(atlasId);
+	}
+
+	const int slot = frameIndex % ThumbnailsPerAtlas;
+	const int offsetX = (slot % ThumbnailsPerRow) * ThumbnailWidth;
+	const int offsetY = (slot / ThumbnailsPerRow) * ThumbnailHeight;
+	glBindTexture(GL_TEXTURE_2D, _atlasTextures[atlasIndex]);
+	glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, offsetX, offsetY, ThumbnailWidth, ThumbnailHeight,
+		GL_COMPRESSED_RGB_S3TC_DXT1_EXT, static_cast<GLsizei>(bc1Thumbnail.size()), bc1Thumbnail.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if (_hasThumbnail.size() <= static_cast<size_t>(frameIndex))
+	{
+		_hasThumbnail.resize(frameIndex + 1, false);
+	}
+	_hasThumbnail[frameIndex] = true;
+}
+
+bool FrameFilmstrip::Draw(const char* id, float height, int firstFrame, int frameCount, int& frameIndex)
+{
+	bool clicked = false;
+	if (ImGui::BeginChild(id, ImVec2(0.0f, height), false, ImGuiWindowFlags_HorizontalScrollbar))
+	{
+		const float thumbnailHeight = height - ImGui::GetStyle().ScrollbarSize;
+		const float thumbnailWidth = thumbnailHeight * ThumbnailWidth / ThumbnailHeight;
+		const float cellWidth = thumbnailWidth + ThumbnailSpacing;
+		const float viewWidth = ImGui::GetWindowWidth();
+
+		// Reserve the whole strip so the scrollbar spans every frame
+		const ImVec2 stripOrigin = ImGui::GetCursorScreenPos();
+		ImGui::Dummy(ImVec2(cellWidth * frameCount, thumbnailHeight));
+
+		// Keep the current frame in view when it moves, without fighting manual scrolling otherwise
+		if (firstFrame + frameIndex != _followedFrame)
+		{
+			_followedFrame = firstFrame + frameIndex;
+			const float frameX = frameIndex * cellWidth;
+			const float scrollX = ImGui::GetScrollX();
+			if (frameX < scrollX || frameX + cellWidth > scrollX + viewWidth)
+			{
+				ImGui::SetScrollX(frameX - (viewWidth - cellWidth) * 0.5f);
+			}
+		}
+
+		// Only the visible range emits draw commands
+		const float scrollX = ImGui::GetScrollX();
+		const int firstVisible = std::max(0, static_cast<int>(scrollX / cellWidth));
+		const int lastVisible = std::min(frameCount - 1, static_cast<int>((scrollX + viewWidth) / cellWidth));
+
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+		const ImVec2 uvSize(ThumbnailWidth / (float)AtlasSize, ThumbnailHeight / (float)AtlasSize);
+		for (int frameIt = firstVisible; frameIt <= lastVisible; ++frameIt)
+		{
+			const ImVec2 thumbnailMin(stripOrigin.x + frameIt * cellWidth, stripOrigin.y);
+			const ImVec2 thumbnailMax(thumbnailMin.x + thumbnailWidth, thumbnailMin.y + thumbnailHeight);
+			const int thumbnailIndex = firstFrame + frameIt;
+			if (static_cast<size_t>(thumbnailIndex) < _hasThumbnail.size() && _hasThumbnail[thumbnailIndex])
+			{
+				const int slot = thumbnailIndex % ThumbnailsPerAtlas;
+				const ImVec2 uvMin((slot % ThumbnailsPerRow) * uvSize.x, (slot / ThumbnailsPerRow) * uvSize.y);
+				const ImVec2 uvMax(uvMin.x + uvSize.x, uvMin.y + uvSize.y);
+				const unsigned int atlasId = _atlasTextures[thumbnailIndex / ThumbnailsPerAtlas];
+				const ImTextureID atlasTexture = reinterpret_cast<void*>((intptr_t)atlasId);
+				drawList->AddImage(atlasTexture, thumbnailMin, thumbnailMax, uvMin, uvMax);
+			}
+			else
+			{
+				drawList->AddRectFilled(thumbnailMin, thumbnailMax, ImGui::GetColorU32(ImGuiCol_FrameBg));
+			}
+
+			if (frameIt == frameIndex)
+			{
+				const ImU32 highlightColor = ImGui::GetColorU32(ImGuiCol_PlotHistogram);
+				drawList->AddRect(thumbnailMin, thumbnailMax, highlightColor, 0.0f, 0, 2.0f);
+			}
+		}
+
+		// Jump to the clicked thumbnail
+		if (ImGui::IsWindowHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+		{
+			const ImVec2 mousePos = ImGui::GetMousePos();
+			const int clickedFrame = static_cast<int>((mousePos.x - stripOrigin.x) / cellWidth);
+			if (mousePos.y < stripOrigin.y + thumbnailHeight && clickedFrame >= 0 && clickedFrame < frameCount)
+			{
+				frameIndex = clickedFrame;
+				_followedFrame = firstFrame + clickedFrame;
+				clicked = true;
+			}
+		}
+	}
+	ImGui::EndChild();
+	return clicked;
+}
+
+void FrameFilmstrip::Clear()
+{
+	if (!_atlasTextures.empty())
+	{
+		glDeleteTextures(static_cast<GLsizei>(_atlasTextures.size()), _atlasTextures.data());
+	}
+	_atlasTextures.clear();
+	_hasThumbnail.clear();
+	_followedFrame = -1;
+}
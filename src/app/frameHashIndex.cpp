@@ -0,0 +1,87 @@
+#include <app/frameHashIndex.h>
+
+// StdLib Includes
+#include <algorithm>
+
+// Internal Includes
+#include <app/thumbnail.h>
+
+static int CountBits(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	// Only a popcnt instruction when the target has one (-mpopcnt), a library call otherwise
+	return __builtin_popcountll(value);
+#else
+	// MSVC's __popcnt64 is the instruction itself, which CPUs before SSE4.2 don't have
+	value -= (value >> 1) & 0x5555555555555555ull;
+	value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<int>((value * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+uint64_t ComputePerceptualHash(const uint8_t* rgbPixels, int width, int height)
+{
+	constexpr int SamplesX = 9;
+	constexpr int SamplesY = 8;
+	uint8_t samples[SamplesX * SamplesY * 3];
+	DownscaleBox(rgbPixels, width, height, samples, SamplesX, SamplesY);
+
+	// Rec. 601 luma in fixed point, exact enough to order neighbours
+	int luma[SamplesX * SamplesY];
+	for (int sampleIt = 0; sampleIt < SamplesX * SamplesY; ++sampleIt)
+	{
+		const uint8_t* rgb = samples + sampleIt * 3;
+		luma[sampleIt] = rgb[0] * 77 + rgb[1] * 150 + rgb[2] * 29;
+	}
+
+	uint64_t hash = 0;
+	for (int y = 0; y < SamplesY; ++y)
+	{
+		for (int x = 0; x < SamplesX - 1; ++x)
+		{
+			hash = (hash << 1) | (luma[y * SamplesX + x] > luma[y * SamplesX + x + 1] ? 1 : 0);
+		}
+	}
+	return hash;
+}
+
+int GetHashDistance(uint64_t lhs, uint64_t rhs) { return CountBits(lhs ^ rhs); }
+
+void FrameHashIndex::SetHash(int frameIndex, uint64_t hash)
+{
+	if (frameIndex < 0) return;
+	if (_hashes.size() <= static_cast<size_t>(frameIndex))
+	{
+		_hashes.resize(frameIndex + 1, 0);
+	}
+	_hashes[frameIndex] = hash;
+}
+
+void FrameHashIndex::FindSimilar(uint64_t hash, int maxDistance, vector<int>& frames) const
+{
+	frames.clear();
+	const uint64_t* hashes = _hashes.data();
+	const int frameCount = static_cast<int>(_hashes.size());
+	for (int frameIt = 0; frameIt < frameCount; ++frameIt)
+	{
+		if (CountBits(hashes[frameIt] ^ hash) <= maxDistance) frames.push_back(frameIt);
+	}
+}
+
+void FrameHashIndex::FindFreezeRuns(int firstFrame, int frameCount, int maxDistance, int minLength,
+	vector<FrameRun>& runs) const
+{
+	runs.clear();
+	const uint64_t* hashes = _hashes.data();
+	const int endFrame = std::min(firstFrame + frameCount, static_cast<int>(_hashes.size()));
+	int runStart = firstFrame;
+	for (int frameIt = firstFrame + 1; frameIt <= endFrame; ++frameIt)
+	{
+		// Compare against the first frame of the run so slow pans or fades never chain into a freeze
+		if (frameIt < endFrame && CountBits(hashes[frameIt] ^ hashes[runStart]) <= maxDistance) continue;
+
+		if (frameIt - runStart >= std::max(minLength, 2)) runs.push_back({runStart, frameIt - 1});
+		runStart = frameIt;
+	}
+}
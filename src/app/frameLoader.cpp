@@ -0,0 +1,571 @@
+#include <app/frameLoader.h>
+
+// StdLib Includes
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+// Third Party Includes
+#include <fmt/core.h>
+#include <stb_image.h>
+
+// Internal Includes
+#include <app/blockCompression.h>
+#include <app/frameDecoder.h>
+#include <app/frameDeltaStore.h>
+#include <app/frameHashIndex.h>
+#include <app/frameSequenceFile.h>
+#include <app/frameTimeline.h>
+#include <app/thumbnail.h>
+
+using steadyClock = std::chrono::steady_clock;
+
+static uint64_t ElapsedNs(steadyClock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(steadyClock::now() - start).count();
+}
+
+void FrameLoaderStats::Reset()
+{
+	EmitNs = 0;
+	DecodeNs = 0;
+	CompressNs = 0;
+	ThumbnailNs = 0;
+	HashNs = 0;
+	StatisticsNs = 0;
+	CacheNs = 0;
+	HandOffNs = 0;
+	RingFullNs = 0;
+	BudgetWaitNs = 0;
+	FramesDecoded = 0;
+	FramesFailed = 0;
+	FramesCached = 0;
+	DecodedBytes = 0;
+}
+
+uint64_t PixelBudget::Acquire(size_t bytes)
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	auto fits = [&]() { return _usedBytes == 0 || _usedBytes + bytes <= _limitBytes; };
+
+	uint64_t waitNs = 0;
+	if (!fits())
+	{
+		steadyClock::time_point start = steadyClock::now();
+		_waitingCount++;
+		_released.wait(lock, fits);
+		_waitingCount--;
+		waitNs = ElapsedNs(start);
+	}
+	UpdatePeak(_usedBytes += bytes);
+	return waitNs;
+}
+
+void PixelBudget::Charge(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	UpdatePeak(_usedBytes += bytes);
+}
+
+void PixelBudget::Release(size_t bytes)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_usedBytes -= bytes;
+	}
+	_released.notify_all();
+}
+
+void PixelBudget::SetLimit(size_t limitBytes)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_limitBytes = limitBytes;
+	}
+	_released.notify_all();
+}
+
+void PixelBudget::UpdatePeak(size_t usedBytes)
+{
+	if (usedBytes > _peakBytes) _peakBytes = usedBytes;
+}
+
+PixelBufferPool& PixelBufferPool::GetShared()
+{
+	static PixelBufferPool sharedPool;
+	return sharedPool;
+}
+
+PixelBufferPool::~PixelBufferPool() { Trim(); }
+
+uint8_t* PixelBufferPool::Acquire(size_t size)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		auto freeIt = _freeBuffers.find(size);
+		if (freeIt != _freeBuffers.end() && !freeIt->second.empty())
+		{
+			uint8_t* buffer = freeIt->second.back();
+			freeIt->second.pop_back();
+			_retainedBytes -= size;
+			_reuseCount++;
+			return buffer;
+		}
+	}
+	_allocationCount++;
+	return new uint8_t[size];
+}
+
+void PixelBufferPool::Release(uint8_t* buffer, size_t size)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		if (_retainedBytes + size <= DefaultRetainLimitBytes)
+		{
+			_freeBuffers[size].push_back(buffer);
+			_retainedBytes += size;
+			return;
+		}
+	}
+	delete[] buffer;
+}
+
+void PixelBufferPool::Trim()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	for (auto& [size, buffers] : _freeBuffers)
+	{
+		for (uint8_t* buffer : buffers)
+		{
+			delete[] buffer;
+		}
+	}
+	_freeBuffers.clear();
+	_retainedBytes = 0;
+}
+
+// Enough lines in flight to keep every worker decoding
+static size_t GetPipelineLineCount(const tf::Executor& executor)
+{
+	return max(FrameLoader::MinPipelineLines, executor.num_workers());
+}
+
+FrameLoader::FrameLoader(tf::Executor& executor)
+	: _executor(executor),
+	  _loadImagePipeline(GetPipelineLineCount(executor),
+		  tf::Pipe<> {tf::PipeType::SERIAL, [this](tf::Pipeflow& pf) { EmitStage(pf); }},
+		  tf::Pipe<> {tf::PipeType::PARALLEL, [this](tf::Pipeflow& pf) { DecodeStage(pf); }},
+		  tf::Pipe<> {tf::PipeType::SERIAL, [this](tf::Pipeflow& pf) { HandOffStage(pf); }}),
+	  _uploadImageRing(HandOffCapacity), _loadImagePipeData(GetPipelineLineCount(executor))
+{
+	_taskFlow.composed_of(_loadImagePipeline).name("pipeline");
+}
+
+FrameLoader::~FrameLoader()
+{
+	// Release anything the consumer didn't pull
+	Cancel();
+}
+
+bool FrameLoader::Load(vector<FrameSource> frameSources)
+{
+	if (IsLoading()) return false;
+
+	// The previous run is done, make sure its task has returned before touching the pipeline
+	Wait();
+
+	_loadFramesList = std::move(frameSources);
+	_handedOffCount = 0;
+	_estimatedFrameBytes = 0;
+	if (_loadFramesList.empty()) return true;
+
+	// Frames the previous runs added become cache hits from here on
+	if (_frameCache != nullptr) _frameCache->Refresh();
+
+	// Token identifiers must start from zero on every run
+	_loadImagePipeline.reset();
+	_loadHandle = _executor.run(_taskFlow);
+	return true;
+}
+
+void FrameLoader::Wait()
+{
+	if (_loadHandle.valid())
+	{
+		_loadHandle.wait();
+	}
+}
+
+void FrameLoader::Cancel()
+{
+	_cancelRequested = true;
+
+	// The emit stage may be waiting on the budget, keep releasing what reaches the hand-off buffer
+	while (_loadHandle.valid() && _loadHandle.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+	{
+		DropHandedOffFrames();
+	}
+	DropHandedOffFrames();
+
+	_loadFramesList.clear();
+	_handedOffCount = 0;
+	_cancelRequested = false;
+}
+
+size_t FrameLoader::PullLoadedFrames(std::deque<LoadImageJob>& uploadDeque, size_t maxCount)
+{
+	size_t pulledCount = 0;
+	LoadImageJob job;
+	while (pulledCount < maxCount && _uploadImageRing.TryPop(job))
+	{
+		uploadDeque.push_back(std::move(job));
+		pulledCount++;
+	}
+	if (pulledCount > 0) NotifyRingSlotsFreed();
+	return pulledCount;
+}
+
+void FrameLoader::ReleaseImageData(LoadImageJob& job)
+{
+	if (job.ImageData == nullptr) return;
+	PixelBufferPool::GetShared().Release(static_cast<uint8_t*>(job.ImageData), job.ImageDataSize);
+	job.ImageData = nullptr;
+	job.ImageDataSize = 0;
+
+	if (job.Budget != nullptr)
+	{
+		job.Budget->Release(job.BudgetBytes);
+		job.Budget = nullptr;
+		job.BudgetBytes = 0;
+	}
+}
+
+bool FrameLoader::ResolveFrameSources(const vector<string>& paths, vector<FrameSource>& frameSources,
+	string* error)
+{
+	frameSources.reserve(frameSources.size() + paths.size());
+	FrameTimestampResolver timestampResolver;
+	for (const string& path : paths)
+	{
+		if (!FrameSequenceFile::IsFrameSequencePath(path))
+		{
+			frameSources.push_back({path, nullptr, 0, timestampResolver.Resolve(path)});
+			continue;
+		}
+
+		auto sequence = std::make_shared<FrameSequenceFile>();
+		if (!sequence->Open(path, error)) return false;
+
+		const uint32_t frameCount = sequence->GetFrameCount();
+		for (uint32_t frameIt = 0; frameIt < frameCount; ++frameIt)
+		{
+			string imagePath = fmt::format("{0}/{1}", path, sequence->GetFrameName(frameIt));
+			frameSources.push_back({std::move(imagePath), sequence, frameIt, sequence->GetEntry(frameIt).TimestampUs});
+		}
+	}
+	return true;
+}
+
+// Reads a whole file into bytes, which keep their capacity from one frame to the next
+static bool ReadFrameFile(const string& path, vector<uint8_t>& bytes)
+{
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr) return false;
+
+	fseek(file, 0, SEEK_END);
+	const long fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	bytes.resize(fileSize > 0 ? static_cast<size_t>(fileSize) : 0);
+	const bool read = fileSize > 0 && fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	fclose(file);
+	return read;
+}
+
+bool FrameLoader::DecodeFrameSource(const FrameSource& source, LoadImageJob& job, const FrameDecodeOptions& options)
+{
+	// Every decoding thread keeps the encoded bytes of its last loose file and the RGB pixels of its last
+	// block compressed frame, so steady state decoding allocates nothing but the frames it hands off
+	thread_local vector<uint8_t> fileBytes;
+	thread_local vector<uint8_t> scratchPixels;
+
+	job.NumComp = 3;
+	job.Format = FramePixelFormat::RGB8;
+	job.ImageData = nullptr;
+	job.ImageDataSize = 0;
+
+	const uint8_t* encoded = nullptr;
+	size_t encodedSize = 0;
+	if (source.Sequence != nullptr)
+	{
+		encoded = source.Sequence->GetPayload(source.SequenceIndex);
+		encodedSize = source.Sequence->GetEntry(source.SequenceIndex).Size;
+	}
+	else
+	{
+		if (!ReadFrameFile(source.ImagePath, fileBytes)) return false;
+		encoded = fileBytes.data();
+		encodedSize = fileBytes.size();
+	}
+
+	const FrameDecoder& decoder = GetFrameDecoder(DetectFrameImageFormat(encoded, encodedSize));
+	if (!decoder.ReadSize(encoded, encodedSize, job.Width, job.Height)) return false;
+
+	// Block compressed frames only need the RGB pixels until they are compressed
+	const size_t pixelsSize = size_t(job.Width) * job.Height * 3;
+	uint8_t* pixels = nullptr;
+	if (options.Format == FramePixelFormat::BC1)
+	{
+		if (scratchPixels.size() < pixelsSize) scratchPixels.resize(pixelsSize);
+		pixels = scratchPixels.data();
+	}
+	else
+	{
+		pixels = PixelBufferPool::GetShared().Acquire(pixelsSize);
+	}
+
+	if (!decoder.DecodeRGB(encoded, encodedSize, pixels, size_t(job.Width) * 3))
+	{
+		if (options.Format != FramePixelFormat::BC1) PixelBufferPool::GetShared().Release(pixels, pixelsSize);
+		return false;
+	}
+	if (options.Format == FramePixelFormat::RGB8)
+	{
+		job.ImageData = pixels;
+		job.ImageDataSize = pixelsSize;
+	}
+
+	// Thumbnails come from the pixels we already have, never from a second decode. Hashes are always taken from the
+	// thumbnail sized downscale (made or not), so batch analysis hashes the frames exactly as the timeline does.
+	if (options.Thumbnail || options.PerceptualHash)
+	{
+		steadyClock::time_point start = steadyClock::now();
+		int fitWidth, fitHeight;
+		FitThumbnail(job.Width, job.Height, fitWidth, fitHeight);
+		uint8_t fitPixels[ThumbnailWidth * ThumbnailHeight * 3];
+		DownscaleBox(pixels, job.Width, job.Height, fitPixels, fitWidth, fitHeight);
+		if (options.Thumbnail)
+		{
+			uint8_t thumbnailPixels[ThumbnailWidth * ThumbnailHeight * 3];
+			LetterboxThumbnail(fitPixels, fitWidth, fitHeight, thumbnailPixels);
+			job.Thumbnail.resize(GetBC1DataSize(ThumbnailWidth, ThumbnailHeight));
+			CompressBC1(thumbnailPixels, ThumbnailWidth, ThumbnailHeight, job.Thumbnail.data());
+			if (options.ThumbnailNs != nullptr) *options.ThumbnailNs += ElapsedNs(start);
+			start = steadyClock::now();
+		}
+
+		// Hashing the thumbnail instead of the frame saves another full pass over the pixels (bars left out)
+		if (options.PerceptualHash)
+		{
+			job.PerceptualHash = ComputePerceptualHash(fitPixels, fitWidth, fitHeight);
+			if (options.HashNs != nullptr) *options.HashNs += ElapsedNs(start);
+		}
+	}
+	if (options.Statistics)
+	{
+		steadyClock::time_point start = steadyClock::now();
+		MeasureFrameStatistics(pixels, job.Width, job.Height, job.Statistics);
+		if (options.StatisticsNs != nullptr) *options.StatisticsNs += ElapsedNs(start);
+	}
+	if (options.Format == FramePixelFormat::RGB8) return true;
+
+	// Compress here so the main thread upload is a plain copy and held frames take 6x less memory
+	steadyClock::time_point start = steadyClock::now();
+	const size_t blocksSize = GetBC1DataSize(job.Width, job.Height);
+	uint8_t* blocks = PixelBufferPool::GetShared().Acquire(blocksSize);
+	CompressBC1(pixels, job.Width, job.Height, blocks);
+
+	job.Format = FramePixelFormat::BC1;
+	job.ImageData = blocks;
+	job.ImageDataSize = blocksSize;
+	if (options.CompressNs != nullptr) *options.CompressNs += ElapsedNs(start);
+	return true;
+}
+
+void FrameLoader::EmitStage(tf::Pipeflow& pf)
+{
+	steadyClock::time_point start = steadyClock::now();
+
+	// Stop emitting tokens if we reached loading queue end
+	if (pf.token() == _loadFramesList.size() || _cancelRequested)
+	{
+		pf.stop();
+		return;
+	}
+
+	// Enqueue the image to be loaded from the pipe
+	const FrameSource& source = _loadFramesList[pf.token()];
+	LoadImageJob& job = _loadImagePipeData[pf.line()];
+	job = LoadImageJob{};
+	job.Source = source;
+
+	// Packed frames know their size up-front, loose files assume the size of the last decoded frame
+	// (captures rarely change resolution) and are corrected after decoding
+	size_t frameBytes = _estimatedFrameBytes;
+	if (source.Sequence != nullptr)
+	{
+		const FrameIndexEntry& entry = source.Sequence->GetEntry(source.SequenceIndex);
+		frameBytes = size_t(entry.Width) * entry.Height * STBI_rgb;
+
+		// Page in packed frames one pipeline length ahead of the decoders
+		source.Sequence->Prefetch(source.SequenceIndex + static_cast<uint32_t>(_loadImagePipeData.size()));
+	}
+	else if (frameBytes == 0)
+	{
+		int width, height, numComp;
+		if (stbi_info(source.ImagePath.c_str(), &width, &height, &numComp))
+		{
+			frameBytes = size_t(width) * height * STBI_rgb;
+		}
+	}
+
+	// Throttle the whole pipeline here, before any decoder allocates pixels
+	const uint64_t emitNs = ElapsedNs(start);
+	_stats.BudgetWaitNs += _pixelBudget.Acquire(frameBytes);
+	job.Budget = &_pixelBudget;
+	job.BudgetBytes = frameBytes;
+	_stats.EmitNs += emitNs;
+}
+
+void FrameLoader::DecodeStage(tf::Pipeflow& pf)
+{
+	steadyClock::time_point start = steadyClock::now();
+
+	LoadImageJob& job = _loadImagePipeData[pf.line()];
+	FrameDecodeOptions decodeOptions;
+	decodeOptions.Format = _pixelFormat;
+	decodeOptions.Thumbnail = _makeThumbnails;
+	decodeOptions.PerceptualHash = true;
+	decodeOptions.Statistics = _measureStatistics;
+	decodeOptions.CompressNs = &_stats.CompressNs;
+	decodeOptions.ThumbnailNs = &_stats.ThumbnailNs;
+	decodeOptions.HashNs = &_stats.HashNs;
+	decodeOptions.StatisticsNs = &_stats.StatisticsNs;
+	if (ReadCachedFrame(job) || DecodeFrameSource(job.Source, job, decodeOptions))
+	{
+		const size_t frameBytes = size_t(job.Width) * job.Height * job.NumComp;
+		_stats.FramesDecoded++;
+		_stats.DecodedBytes += frameBytes;
+		_estimatedFrameBytes = frameBytes;
+
+		// The budget was charged for the decoded size, only what stays in memory is held until release
+		if (job.ImageDataSize != job.BudgetBytes)
+		{
+			_pixelBudget.Charge(job.ImageDataSize);
+			_pixelBudget.Release(job.BudgetBytes);
+			job.BudgetBytes = job.ImageDataSize;
+		}
+	}
+	else
+	{
+		// Failed jobs hold no pixels
+		_pixelBudget.Release(job.BudgetBytes);
+		job.Budget = nullptr;
+		job.BudgetBytes = 0;
+		_stats.FramesFailed++;
+	}
+	_stats.DecodeNs += ElapsedNs(start);
+}
+
+void FrameLoader::HandOffStage(tf::Pipeflow& pf)
+{
+	steadyClock::time_point start = steadyClock::now();
+
+	// Frames reach this stage in order, which is what delta encoding needs
+	LoadImageJob& job = _loadImagePipeData[pf.line()];
+
+	// Decoded frames are cached in import order, so importing them again reads the cache sequentially
+	if (_frameCache != nullptr && !job.Cached && job.ImageData != nullptr && job.Format == FramePixelFormat::BC1)
+	{
+		_packedStatistics.resize(_measureStatistics ? GetPackedStatisticsSize(job.Statistics) : 0);
+		if (_measureStatistics) PackFrameStatistics(job.Statistics, _packedStatistics.data());
+		_frameCache->Add(job.Fingerprint, static_cast<const uint8_t*>(job.ImageData), job.ImageDataSize,
+			job.Thumbnail.data(), job.Thumbnail.size(), _packedStatistics.data(), _packedStatistics.size(), job.Width,
+			job.Height, job.PerceptualHash);
+	}
+	if (_deltaStore != nullptr && job.ImageData != nullptr && job.Format == FramePixelFormat::BC1)
+	{
+		job.DeltaFrameIndex = _deltaStore->AddFrame(static_cast<const uint8_t*>(job.ImageData), job.Width, job.Height);
+	}
+
+	// The consumer drains the ring every frame, it only fills up when the render thread stalls. The stage then
+	// sleeps until slots are freed, yielding in a loop took the core away from the decoders and the consumer.
+	if (!_uploadImageRing.TryPush(std::move(job)))
+	{
+		std::unique_lock<std::mutex> lock(_ringFullLock);
+		_ringFullWaiting.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst); // Pairs with NotifyRingSlotsFreed
+		_ringSlotsFreed.wait(lock, [&]() { return _uploadImageRing.TryPush(std::move(job)); });
+		_ringFullWaiting.store(false, std::memory_order_relaxed);
+		_stats.RingFullNs += ElapsedNs(start);
+	}
+	job.ImageData = nullptr;
+	_handedOffCount++;
+	_stats.HandOffNs += ElapsedNs(start);
+	if (_onHandOff) _onHandOff();
+}
+
+bool FrameLoader::ReadCachedFrame(LoadImageJob& job)
+{
+	if (_frameCache == nullptr || _pixelFormat != FramePixelFormat::BC1) return false;
+	steadyClock::time_point start = steadyClock::now();
+
+	// Packed frames are fingerprinted by their container
+	const FrameSource& source = job.Source;
+	const string& filePath = source.Sequence != nullptr ? source.Sequence->GetPath() : source.ImagePath;
+	const FrameCacheEntry* entry = nullptr;
+	if (FrameCache::GetFingerprint(filePath, source.ImagePath, job.Fingerprint))
+	{
+		entry = _frameCache->Find(job.Fingerprint);
+	}
+	if (entry == nullptr || (_makeThumbnails && entry->ThumbnailSize == 0) ||
+		(_measureStatistics && entry->StatisticsSize == 0))
+	{
+		_stats.CacheNs += ElapsedNs(start);
+		return false;
+	}
+
+	uint8_t* blocks = PixelBufferPool::GetShared().Acquire(entry->BlocksSize);
+	memcpy(blocks, _frameCache->GetBlocks(*entry), entry->BlocksSize);
+	job.ImageData = blocks;
+	job.ImageDataSize = entry->BlocksSize;
+	job.Width = static_cast<int>(entry->Width);
+	job.Height = static_cast<int>(entry->Height);
+	job.NumComp = 3;
+	job.Format = FramePixelFormat::BC1;
+	if (_makeThumbnails)
+	{
+		const uint8_t* thumbnail = _frameCache->GetThumbnail(*entry);
+		job.Thumbnail.assign(thumbnail, thumbnail + entry->ThumbnailSize);
+	}
+	if (_measureStatistics)
+	{
+		UnpackFrameStatistics(_frameCache->GetStatistics(*entry), entry->StatisticsSize, job.Statistics);
+	}
+	job.PerceptualHash = entry->PerceptualHash;
+	job.Cached = true;
+
+	_stats.FramesCached++;
+	_stats.CacheNs += ElapsedNs(start);
+	return true;
+}
+
+void FrameLoader::DropHandedOffFrames()
+{
+	LoadImageJob job;
+	while (_uploadImageRing.TryPop(job))
+	{
+		ReleaseImageData(job);
+	}
+	NotifyRingSlotsFreed();
+}
+
+void FrameLoader::NotifyRingSlotsFreed()
+{
+	// Either the hand-off stage sees the freed slots before it sleeps, or this sees it waiting
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!_ringFullWaiting.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lock(_ringFullLock);
+	_ringSlotsFreed.notify_one();
+}
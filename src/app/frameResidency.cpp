@@ -0,0 +1,419 @@
+#include <app/frameResidency.h>
+
+// StdLib Includes
+#include <algorithm>
+
+// Third Party Includes
+#include <glad/glad.h>
+#include <string.h>
+
+// Internal Includes
+#include <app/blockCompression.h>
+#include <app/frameDeltaStore.h>
+
+FrameResidency::DecodeResults::~DecodeResults()
+{
+	for (auto& [frameIndex, job] : Jobs)
+	{
+		FrameLoader::ReleaseImageData(job);
+	}
+}
+
+FrameResidency::FrameResidency(tf::Executor& executor, vector<FrameTexture>& frames)
+	: _executor(executor), _frames(frames), _decodeResults(std::make_shared<DecodeResults>())
+{
+}
+
+FrameResidency::~FrameResidency() { Clear(); }
+
+void FrameResidency::OfferDecodedFrame(int frameIndex, LoadImageJob&& job)
+{
+	ReserveFrameSlots();
+
+	// Whether it is worth uploading is only decided after the next window planning
+	if (_frameStates[frameIndex] == FrameState::NotResident)
+	{
+		_frameStates[frameIndex] = FrameState::Decoding;
+		_readyJobs.emplace_back(frameIndex, std::move(job));
+		return;
+	}
+	FrameLoader::ReleaseImageData(job);
+}
+
+void FrameResidency::Update(const vector<PlaybackHint>& hints)
+{
+	_tick++;
+	ReserveFrameSlots();
+	PlanWindow(hints);
+
+	// The window may have shrunk, drop the least recently used textures first
+	while (_textureCount > _windowSize)
+	{
+		int frameIndex = FindEvictionCandidate(true);
+		if (frameIndex < 0) break;
+
+		_textureArrays.Free(Evict(frameIndex));
+		_textureCount--;
+	}
+
+	// Textures staged on the previous update are synced before staging new ones
+	CollectDecodes();
+	SyncUploads();
+	StageUploads();
+	RequestDecodes();
+}
+
+FrameLayer FrameResidency::AcquireTexture(const PlaybackHint& hint, int frameIndex, int& shownFrameIndex)
+{
+	ReserveFrameSlots();
+	const int firstFrame = hint.FirstFrame;
+	const int frameCount = hint.FrameCount < 0 ? static_cast<int>(_frames.size()) : hint.FrameCount;
+	if (frameIndex < firstFrame || frameIndex >= firstFrame + frameCount) return FrameLayer();
+
+	// Fallback to an older frame of the same stream rather than flickering while the requested one is uploaded
+	const int searchCount = min(_windowSize, frameCount);
+	for (int searchIt = 0; searchIt < searchCount; ++searchIt)
+	{
+		const int candidate = firstFrame + (frameIndex - firstFrame - searchIt + frameCount) % frameCount;
+		if (_frameStates[candidate] == FrameState::Resident)
+		{
+			_lastUseTick[candidate] = _tick;
+			shownFrameIndex = candidate;
+			return _frames[candidate].Layer;
+		}
+	}
+	return FrameLayer();
+}
+
+void FrameResidency::Clear()
+{
+	// Async decodes still running will complete into the orphaned results, which release them
+	_decodeResults = std::make_shared<DecodeResults>();
+	_decodesInFlight = 0;
+
+	for (auto& [frameIndex, job] : _readyJobs)
+	{
+		FrameLoader::ReleaseImageData(job);
+	}
+	_readyJobs.clear();
+
+	_syncImageUploadQueue = {};
+	_uploadRing.Release();
+
+	for (int frameIndex : _residentFrames)
+	{
+		_frames[frameIndex].Layer = FrameLayer();
+	}
+	_residentFrames.clear();
+	_textureArrays.Release();
+	_textureCount = 0;
+
+	_frameStates.clear();
+	_lastUseTick.clear();
+	_desiredEpoch.clear();
+	_desiredFrames.clear();
+}
+
+void FrameResidency::SetWindowSize(int windowSize)
+{
+	_windowSize = max(windowSize, 1);
+	_textureArrays.SetMaxChunkLayers(_windowSize);
+}
+
+void FrameResidency::ReserveFrameSlots()
+{
+	const size_t frameCount = _frames.size();
+	if (_frameStates.size() == frameCount) return;
+
+	_frameStates.resize(frameCount, FrameState::NotResident);
+	_lastUseTick.resize(frameCount, 0);
+	_desiredEpoch.resize(frameCount, 0);
+}
+
+void FrameResidency::PlanWindow(const vector<PlaybackHint>& hints)
+{
+	_planEpoch++;
+	_desiredFrames.clear();
+
+	const int frameCount = static_cast<int>(_frames.size());
+	if (frameCount == 0 || hints.empty()) return;
+
+	// Every playhead gets its share of the window
+	const int hintCount = static_cast<int>(hints.size());
+	const int desiredCount = max(min(_windowSize, frameCount) / hintCount, 1);
+	_hintDesiredFrames.resize(hintCount);
+	for (int hintIt = 0; hintIt < hintCount; ++hintIt)
+	{
+		PlanHintWindow(hints[hintIt], desiredCount, _hintDesiredFrames[hintIt]);
+	}
+
+	// Interleave them by distance, so every stream gets its next frames decoded before any stream gets far ahead
+	for (size_t rank = 0;; ++rank)
+	{
+		bool anyLeft = false;
+		for (const vector<int>& hintFrames : _hintDesiredFrames)
+		{
+			if (rank >= hintFrames.size()) continue;
+			_desiredFrames.push_back(hintFrames[rank]);
+			anyLeft = true;
+		}
+		if (!anyLeft) break;
+	}
+}
+
+void FrameResidency::PlanHintWindow(const PlaybackHint& hint, int desiredCount, vector<int>& desiredFrames)
+{
+	desiredFrames.clear();
+
+	const int firstFrame = max(hint.FirstFrame, 0);
+	const int frameCount = hint.FrameCount < 0 ? static_cast<int>(_frames.size()) - firstFrame : hint.FrameCount;
+	if (frameCount <= 0 || firstFrame + frameCount > static_cast<int>(_frames.size())) return;
+
+	desiredCount = min(desiredCount, frameCount);
+	auto desire = [&](int frameIndex)
+	{
+		frameIndex = firstFrame + (((frameIndex - firstFrame) % frameCount) + frameCount) % frameCount;
+		if (_desiredEpoch[frameIndex] == _planEpoch) return;
+		_desiredEpoch[frameIndex] = _planEpoch;
+		desiredFrames.push_back(frameIndex);
+	};
+
+	// Paused viewers step both ways, playing ones mostly need what comes next.
+	// The faster the playback the less the frames behind the playhead matter.
+	const int direction = hint.Direction < 0 ? -1 : 1;
+	const int aheadPerBehind = hint.Direction == 0 ? 1 : max(3, static_cast<int>(3.0f * hint.Speed));
+	auto desireAround = [&](int stride, int count)
+	{
+		int ahead = 0, behind = 0;
+		for (int guard = 0; static_cast<int>(desiredFrames.size()) < count && guard < frameCount; ++guard)
+		{
+			desire(hint.Playhead + direction * stride * ++ahead);
+			if (ahead % aheadPerBehind == 0) desire(hint.Playhead - direction * stride * ++behind);
+		}
+	};
+
+	desire(hint.Playhead);
+
+	// When skipping by more than one frame, half of the window follows the skip pattern
+	if (hint.Stride > 1)
+	{
+		desireAround(hint.Stride, desiredCount / 2);
+	}
+	desireAround(1, desiredCount);
+}
+
+void FrameResidency::CollectDecodes()
+{
+	vector<std::pair<int, LoadImageJob>> decodedJobs;
+	{
+		std::lock_guard<std::mutex> lock(_decodeResults->Lock);
+		decodedJobs.swap(_decodeResults->Jobs);
+	}
+
+	const int frameCount = static_cast<int>(_frames.size());
+	for (auto& [frameIndex, job] : decodedJobs)
+	{
+		_decodesInFlight--;
+		if (frameIndex >= frameCount || _frameStates[frameIndex] != FrameState::Decoding)
+		{
+			FrameLoader::ReleaseImageData(job);
+			continue;
+		}
+
+		// Failed frames are never requested again
+		if (job.ImageData == nullptr)
+		{
+			_frameStates[frameIndex] = FrameState::Failed;
+			continue;
+		}
+		_readyJobs.emplace_back(frameIndex, std::move(job));
+	}
+}
+
+void FrameResidency::SyncUploads()
+{
+	if (_syncImageUploadQueue.empty()) return;
+
+	// Every update we sync a number of frames from the sync queue
+	int syncCost = 0;
+	while (!_syncImageUploadQueue.empty() && syncCost < MaxSyncCostPerUpdate)
+	{
+		const SyncImageUploadJob& job = _syncImageUploadQueue.front();
+
+		// Storage of the layer already exists, this is a plain copy out of the staging slot
+		_uploadRing.Bind(job.UploadSlot);
+		_textureArrays.Upload(job.Layer, job.DataSize);
+		syncCost += job.Format == FramePixelFormat::BC1 ? 1 : RGBSyncCost;
+
+		// The upload is issued, the slot can be staged into again (the driver renames its storage if need be)
+		_uploadRing.Free();
+
+		MakeResident(job.FrameIndex, job.Layer);
+		_syncImageUploadQueue.pop();
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void FrameResidency::StageUploads()
+{
+	if (_readyJobs.empty()) return;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	int stagedCount = 0;
+	while (!_readyJobs.empty() && stagedCount < MaxStagesPerUpdate && !_uploadRing.IsFull())
+	{
+		auto [frameIndex, job] = std::move(_readyJobs.front());
+		_readyJobs.pop_front();
+
+		// The playhead moved away while it was decoding
+		const FrameLayer layer =
+			IsDesired(frameIndex) ? AllocateTexture(job.Width, job.Height, job.Format) : FrameLayer();
+		if (layer.TextureId == 0)
+		{
+			_frameStates[frameIndex] = FrameState::NotResident;
+			FrameLoader::ReleaseImageData(job);
+			continue;
+		}
+
+		// Stage the pixels in the next slot of the upload ring (for async transfer)
+		const size_t textureSize = job.ImageDataSize;
+		const int uploadSlot = _uploadRing.Acquire(textureSize);
+		uint8_t* stagingData = _uploadRing.Map(uploadSlot, textureSize);
+		bool staged = stagingData != nullptr;
+		if (staged)
+		{
+			memcpy(stagingData, job.ImageData, textureSize);
+			staged = _uploadRing.Unmap(uploadSlot);
+		}
+		if (!staged)
+		{
+			// The slot could not be mapped (or its contents were lost), upload straight from the pixels instead
+			_uploadRing.Unacquire();
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			_textureArrays.Upload(layer, textureSize, job.ImageData);
+			FrameLoader::ReleaseImageData(job);
+			MakeResident(frameIndex, layer);
+			stagedCount++;
+			continue;
+		}
+
+		// The pixels go back to the pool, for the decoders to fill again
+		FrameLoader::ReleaseImageData(job);
+
+		// Enqueue image for upload sync
+		_frameStates[frameIndex] = FrameState::Uploading;
+		_syncImageUploadQueue.emplace(frameIndex, job.Format, textureSize, uploadSlot, layer);
+		stagedCount++;
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	// Don't hold pixels of frames that already left the window until their turn comes
+	auto leftWindowIt = std::stable_partition(_readyJobs.begin(), _readyJobs.end(),
+		[this](const std::pair<int, LoadImageJob>& readyJob) { return IsDesired(readyJob.first); });
+	for (auto readyIt = leftWindowIt; readyIt != _readyJobs.end(); ++readyIt)
+	{
+		_frameStates[readyIt->first] = FrameState::NotResident;
+		FrameLoader::ReleaseImageData(readyIt->second);
+	}
+	_readyJobs.erase(leftWindowIt, _readyJobs.end());
+}
+
+void FrameResidency::RequestDecodes()
+{
+	for (int frameIndex : _desiredFrames)
+	{
+		if (_decodesInFlight >= MaxDecodesInFlight) break;
+		if (_frameStates[frameIndex] != FrameState::NotResident) continue;
+
+		_frameStates[frameIndex] = FrameState::Decoding;
+		_decodesInFlight++;
+		const FrameTexture& frame = _frames[frameIndex];
+		_executor.silent_async(
+			[results = _decodeResults, deltaStore = _deltaStore, frame, frameIndex]()
+			{
+				LoadImageJob job;
+				job.Source = frame.Source;
+				if (deltaStore != nullptr && frame.DeltaFrameIndex >= 0)
+				{
+					// Rebuilding from the keyframe and its delta is a couple of copies
+					job.Width = frame.Width;
+					job.Height = frame.Height;
+					job.NumComp = 3;
+					job.Format = FramePixelFormat::BC1;
+					job.ImageDataSize = GetBC1DataSize(frame.Width, frame.Height);
+					job.ImageData = PixelBufferPool::GetShared().Acquire(job.ImageDataSize);
+					deltaStore->DecodeFrame(frame.DeltaFrameIndex, static_cast<uint8_t*>(job.ImageData));
+				}
+				else
+				{
+					FrameLoader::DecodeFrameSource(frame.Source, job);
+				}
+
+				std::lock_guard<std::mutex> lock(results->Lock);
+				results->Jobs.emplace_back(frameIndex, std::move(job));
+			});
+	}
+}
+
+void FrameResidency::MakeResident(int frameIndex, const FrameLayer& layer)
+{
+	_frames[frameIndex].Layer = layer;
+	_frameStates[frameIndex] = FrameState::Resident;
+	_lastUseTick[frameIndex] = _tick;
+	_residentFrames.push_back(frameIndex);
+}
+
+FrameLayer FrameResidency::AllocateTexture(int width, int height, FramePixelFormat format)
+{
+	if (_textureCount < _windowSize)
+	{
+		_textureCount++;
+		return _textureArrays.Allocate(width, height, format);
+	}
+
+	// Re-use the layer of the least recently used frame that left the window (unless its size differs)
+	const int frameIndex = FindEvictionCandidate(false);
+	if (frameIndex < 0) return FrameLayer();
+
+	const FrameLayer layer = Evict(frameIndex);
+	if (_textureArrays.Fits(layer, width, height, format)) return layer;
+	_textureArrays.Free(layer);
+	return _textureArrays.Allocate(width, height, format);
+}
+
+FrameLayer FrameResidency::Evict(int frameIndex)
+{
+	auto residentIt = std::find(_residentFrames.begin(), _residentFrames.end(), frameIndex);
+	*residentIt = _residentFrames.back();
+	_residentFrames.pop_back();
+
+	const FrameLayer layer = _frames[frameIndex].Layer;
+	_frames[frameIndex].Layer = FrameLayer();
+	_frameStates[frameIndex] = FrameState::NotResident;
+	return layer;
+}
+
+int FrameResidency::FindEvictionCandidate(bool allowDesired) const
+{
+	int candidate = -1;
+	bool candidateDesired = true;
+	for (int frameIndex : _residentFrames)
+	{
+		const bool desired = IsDesired(frameIndex);
+		if (desired && !allowDesired) continue;
+
+		// Frames out of the window always go first, then the least recently used
+		const bool better = candidate < 0 || (candidateDesired && !desired) ||
+							(candidateDesired == desired && _lastUseTick[frameIndex] < _lastUseTick[candidate]);
+		if (better)
+		{
+			candidate = frameIndex;
+			candidateDesired = desired;
+		}
+	}
+	return candidate;
+}
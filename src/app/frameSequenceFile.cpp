@@ -0,0 +1,249 @@
+#include <app/frameSequenceFile.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+// Third Party Includes
+#include <fmt/core.h>
+#include <stb_image.h>
+#include <taskflow/core/executor.hpp>
+#include <taskflow/core/taskflow.hpp>
+#include <taskflow/algorithm/pipeline.hpp>
+
+// Internal Includes
+#include <app/frameTimeline.h>
+
+namespace fs = std::filesystem;
+
+// Containers easily go past 2GB, plain fseek takes a long
+static int SeekFile(FILE* file, uint64_t offset)
+{
+#if WIN32
+	return _fseeki64(file, static_cast<int64_t>(offset), SEEK_SET);
+#else
+	return fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+bool FrameSequenceFile::Open(const string& path, string* error)
+{
+	Close();
+
+	auto fail = [&](const string& reason)
+	{
+		if (error != nullptr) *error = fmt::format("{0}: {1}", path, reason);
+		Close();
+		return false;
+	};
+
+	if (!_file.Open(path)) return fail("couldn't map file");
+
+	const size_t fileSize = _file.GetSize();
+	if (fileSize < sizeof(FrameSequenceHeader)) return fail("file too small");
+
+	_header = reinterpret_cast<const FrameSequenceHeader*>(_file.GetData());
+	if (memcmp(_header->Magic, FrameSequenceMagic, sizeof(FrameSequenceMagic)) != 0) return fail("not a frame sequence");
+	if (_header->Version != FrameSequenceVersion) return fail(fmt::format("unsupported version {0}", _header->Version));
+
+	// Validate every offset up-front so frame access never needs bound checks. Sizes are compared to what is left
+	// of the file past their offset, offset + size may wrap around on a corrupted file.
+	const uint64_t indexSize = static_cast<uint64_t>(_header->FrameCount) * sizeof(FrameIndexEntry);
+	if (_header->IndexOffset > fileSize || indexSize > fileSize - _header->IndexOffset ||
+		_header->NamesOffset > fileSize)
+	{
+		return fail("corrupted index");
+	}
+
+	_index = reinterpret_cast<const FrameIndexEntry*>(_file.GetData() + _header->IndexOffset);
+	_names = reinterpret_cast<const char*>(_file.GetData() + _header->NamesOffset);
+	const uint64_t namesSize = fileSize - _header->NamesOffset;
+	for (uint32_t frameIt = 0; frameIt < _header->FrameCount; ++frameIt)
+	{
+		const FrameIndexEntry& entry = _index[frameIt];
+		if (entry.Offset > fileSize || entry.Size > fileSize - entry.Offset ||
+			entry.NameOffset + uint64_t(entry.NameSize) > namesSize)
+		{
+			return fail(fmt::format("corrupted index entry {0}", frameIt));
+		}
+	}
+
+	_path = path;
+	return true;
+}
+
+void FrameSequenceFile::Close()
+{
+	_file.Close();
+	_path.clear();
+	_header = nullptr;
+	_index = nullptr;
+	_names = nullptr;
+}
+
+void FrameSequenceFile::Prefetch(uint32_t frameIndex, uint32_t frameCount) const
+{
+	const uint32_t count = GetFrameCount();
+	if (frameIndex >= count) return;
+
+	// Payloads are contiguous, so a frame range is a single byte range
+	const uint32_t lastFrame = min(frameIndex + frameCount, count) - 1;
+	const uint64_t begin = _index[frameIndex].Offset;
+	const uint64_t end = _index[lastFrame].Offset + _index[lastFrame].Size;
+	if (end > begin) _file.Prefetch(begin, end - begin);
+}
+
+std::string_view FrameSequenceFile::GetFrameName(uint32_t frameIndex) const
+{
+	const FrameIndexEntry& entry = _index[frameIndex];
+	return std::string_view(_names + entry.NameOffset, entry.NameSize);
+}
+
+bool FrameSequenceFile::IsFrameSequencePath(const string& path)
+{
+	const size_t extPos = path.find_last_of('.');
+	if (extPos == string::npos) return false;
+
+	string ext = path.substr(extPos);
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+	return ext == FrameSequenceExtension;
+}
+
+// Used to read source files in parallel while packing
+struct PackFrameJob
+{
+	vector<uint8_t> Payload;
+	FrameIndexEntry Entry;
+	bool Valid = false;
+};
+
+bool PackFrameSequence(const vector<string>& framePaths, const string& outputPath, tf::Executor& executor,
+	string* error)
+{
+	FILE* outFile = fopen(outputPath.c_str(), "wb");
+	if (outFile == nullptr)
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't create {0}", outputPath);
+		return false;
+	}
+
+	// Frame count is known, so the index is reserved right after the header and filled at the end
+	FrameSequenceHeader header = {};
+	memcpy(header.Magic, FrameSequenceMagic, sizeof(FrameSequenceMagic));
+	header.Version = FrameSequenceVersion;
+	header.FrameCount = static_cast<uint32_t>(framePaths.size());
+	header.IndexOffset = sizeof(FrameSequenceHeader);
+
+	// Sidecar and file name timestamps are resolved up front, the resolver caches per directory
+	FrameTimestampResolver timestampResolver;
+	vector<int64_t> timestamps(framePaths.size());
+	for (size_t frameIt = 0; frameIt < framePaths.size(); ++frameIt)
+	{
+		timestamps[frameIt] = timestampResolver.Resolve(framePaths[frameIt]);
+	}
+
+	vector<FrameIndexEntry> index(framePaths.size());
+	uint64_t writeOffset = header.IndexOffset + index.size() * sizeof(FrameIndexEntry);
+	SeekFile(outFile, writeOffset);
+
+	string names;
+	string failedPath;
+	std::atomic<bool> packFailed = {false};
+	constexpr size_t packLines = 16;
+	std::array<PackFrameJob, packLines> packPipeData;
+	tf::Pipeline packPipeline(packLines,
+		tf::Pipe {tf::PipeType::SERIAL,
+			[&](tf::Pipeflow& pf)
+			{
+				if (pf.token() == framePaths.size() || packFailed)
+				{
+					pf.stop();
+					return;
+				}
+				packPipeData[pf.line()].Valid = false;
+			}},
+		tf::Pipe {tf::PipeType::PARALLEL,
+			[&](tf::Pipeflow& pf)
+			{
+				PackFrameJob& job = packPipeData[pf.line()];
+				const string& framePath = framePaths[pf.token()];
+
+				std::error_code fsError;
+				const uintmax_t fileSize = fs::file_size(framePath, fsError);
+				FILE* frameFile = fsError ? nullptr : fopen(framePath.c_str(), "rb");
+				if (frameFile == nullptr) return;
+
+				job.Payload.resize(static_cast<size_t>(fileSize));
+				const size_t readSize = fread(job.Payload.data(), 1, job.Payload.size(), frameFile);
+				fclose(frameFile);
+				if (readSize != job.Payload.size()) return;
+
+				// Probe dimensions from the header only, frames are not decoded while packing
+				int width, height, numComp;
+				if (!stbi_info_from_memory(job.Payload.data(), static_cast<int>(job.Payload.size()), &width, &height,
+						&numComp))
+				{
+					return;
+				}
+
+				// Frames without a timestamp keep none, as when they are imported loose
+				job.Entry = {};
+				job.Entry.Size = job.Payload.size();
+				job.Entry.Width = static_cast<uint32_t>(width);
+				job.Entry.Height = static_cast<uint32_t>(height);
+				job.Entry.TimestampUs = timestamps[pf.token()];
+				job.Valid = true;
+			}},
+		tf::Pipe {tf::PipeType::SERIAL, [&](tf::Pipeflow& pf)
+			{
+				PackFrameJob& job = packPipeData[pf.line()];
+				const string& framePath = framePaths[pf.token()];
+				if (!job.Valid || fwrite(job.Payload.data(), 1, job.Payload.size(), outFile) != job.Payload.size())
+				{
+					failedPath = framePath;
+					packFailed = true;
+					return;
+				}
+
+				// Keep the file name (with extension) so frames can be told apart in the analyzer
+				const string fileName = fs::path(framePath).filename().string();
+				job.Entry.Offset = writeOffset;
+				job.Entry.NameOffset = static_cast<uint32_t>(names.size());
+				job.Entry.NameSize = static_cast<uint32_t>(fileName.size());
+				names += fileName;
+
+				index[pf.token()] = job.Entry;
+				writeOffset += job.Payload.size();
+			}});
+
+	tf::Taskflow packTaskFlow;
+	packTaskFlow.composed_of(packPipeline).name("pack");
+	executor.run(packTaskFlow).wait();
+
+	if (failedPath.empty())
+	{
+		header.NamesOffset = writeOffset;
+		fwrite(names.data(), 1, names.size(), outFile);
+		SeekFile(outFile, 0);
+		fwrite(&header, sizeof(header), 1, outFile);
+		fwrite(index.data(), sizeof(FrameIndexEntry), index.size(), outFile);
+	}
+
+	const bool success = failedPath.empty() && ferror(outFile) == 0;
+	fclose(outFile);
+	if (!success)
+	{
+		if (error != nullptr)
+		{
+			*error = failedPath.empty() ? fmt::format("Couldn't write {0}", outputPath)
+										: fmt::format("Couldn't pack frame {0}", failedPath);
+		}
+		std::error_code fsError;
+		fs::remove(outputPath, fsError);
+	}
+	return success;
+}
@@ -0,0 +1,329 @@
+#include <app/frameStatistics.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define STATISTICS_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define STATISTICS_USE_SSE2 0
+#endif
+
+// Every other row is measured, plenty for a mean and half the cost of a full pass. Histograms need the luma of every
+// pixel and are filled one pixel at a time, a row out of 8 is enough for 64 bins.
+static constexpr int SampledRowStep = 2;
+static constexpr int HistogramRowStep = 8;
+// Cell sums add up the luma of their sampled pixels, times 256
+static constexpr uint32_t CellDivisor = LumaCellSize * (LumaCellSize / SampledRowStep) * 256;
+
+struct PackedStatisticsHeader
+{
+	uint32_t CellsX;
+	uint32_t CellsY;
+	float MeanLuma;
+	float Histogram[LumaHistogramBins];
+};
+
+// Rec. 601 weights in fixed point, they add up to 256
+static constexpr int RedWeight = 77;
+static constexpr int GreenWeight = 150;
+static constexpr int BlueWeight = 29;
+
+static inline uint32_t GetWeightedLuma(const uint8_t* rgb)
+{
+	return rgb[0] * RedWeight + rgb[1] * GreenWeight + rgb[2] * BlueWeight;
+}
+
+// Adds the luma of every group of 8 pixels (times 256) into its cell sum, returns the sum of the whole row.
+// Sums are linear in the channels, so the pixels are weighted in place with multiply-adds instead of deinterleaved.
+static uint64_t AccumulateLumaRow(const uint8_t* rgbRow, int width, int cellsX, uint32_t* cellSums)
+{
+	uint64_t rowSum = 0;
+	int x = 0;
+#if STATISTICS_USE_SSE2
+	// The channel of a byte depends on its offset modulo 3, every 8 bytes start on the next phase of the weights
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weights0 = _mm_setr_epi16(RedWeight, GreenWeight, BlueWeight, RedWeight, GreenWeight, BlueWeight,
+		RedWeight, GreenWeight);
+	const __m128i weights1 = _mm_setr_epi16(BlueWeight, RedWeight, GreenWeight, BlueWeight, RedWeight, GreenWeight,
+		BlueWeight, RedWeight);
+	const __m128i weights2 = _mm_setr_epi16(GreenWeight, BlueWeight, RedWeight, GreenWeight, BlueWeight, RedWeight,
+		GreenWeight, BlueWeight);
+	__m128i rowSums = zero;
+	for (; x + 16 <= width; x += 16)
+	{
+		// Two groups of 8 pixels, 24 bytes each
+		const __m128i* source = reinterpret_cast<const __m128i*>(rgbRow + x * 3);
+		const __m128i a = _mm_loadu_si128(source + 0);
+		const __m128i b = _mm_loadu_si128(source + 1);
+		const __m128i c = _mm_loadu_si128(source + 2);
+		__m128i sums0 = _mm_madd_epi16(_mm_unpacklo_epi8(a, zero), weights0);
+		sums0 = _mm_add_epi32(sums0, _mm_madd_epi16(_mm_unpackhi_epi8(a, zero), weights1));
+		sums0 = _mm_add_epi32(sums0, _mm_madd_epi16(_mm_unpacklo_epi8(b, zero), weights2));
+		__m128i sums1 = _mm_madd_epi16(_mm_unpackhi_epi8(b, zero), weights0);
+		sums1 = _mm_add_epi32(sums1, _mm_madd_epi16(_mm_unpacklo_epi8(c, zero), weights1));
+		sums1 = _mm_add_epi32(sums1, _mm_madd_epi16(_mm_unpackhi_epi8(c, zero), weights2));
+
+		// Horizontal sums of both groups, side by side in the two low lanes
+		const __m128i pairs = _mm_add_epi32(_mm_unpacklo_epi32(sums0, sums1), _mm_unpackhi_epi32(sums0, sums1));
+		const __m128i groupSums = _mm_add_epi32(pairs, _mm_unpackhi_epi64(pairs, pairs));
+		__m128i* cells = reinterpret_cast<__m128i*>(cellSums + x / LumaCellSize);
+		_mm_storel_epi64(cells, _mm_add_epi32(_mm_loadl_epi64(cells), groupSums));
+		rowSums = _mm_add_epi64(rowSums, _mm_unpacklo_epi32(groupSums, zero));
+	}
+	alignas(16) uint64_t lanes[2];
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes), rowSums);
+	rowSum = lanes[0] + lanes[1];
+#endif
+	for (; x < width; ++x)
+	{
+		const uint32_t luma = GetWeightedLuma(rgbRow + x * 3);
+		rowSum += luma;
+		if (x / LumaCellSize < cellsX) cellSums[x / LumaCellSize] += luma;
+	}
+	return rowSum;
+}
+
+// Luma of every pixel of a row, for the histogram
+static void ConvertLumaRow(const uint8_t* rgbRow, int width, uint8_t* lumaRow)
+{
+	int x = 0;
+#if STATISTICS_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i redWeight = _mm_set1_epi16(RedWeight);
+	const __m128i greenWeight = _mm_set1_epi16(GreenWeight);
+	const __m128i blueWeight = _mm_set1_epi16(BlueWeight);
+	const __m128i rounding = _mm_set1_epi16(128);
+	for (; x + 16 <= width; x += 16)
+	{
+		// Planar red, green and blue out of 16 interleaved pixels, by unpacking the three registers four times over
+		const __m128i* source = reinterpret_cast<const __m128i*>(rgbRow + x * 3);
+		__m128i a = _mm_loadu_si128(source + 0);
+		__m128i b = _mm_loadu_si128(source + 1);
+		__m128i c = _mm_loadu_si128(source + 2);
+		for (int roundIt = 0; roundIt < 4; ++roundIt)
+		{
+			const __m128i nextA = _mm_unpacklo_epi8(a, _mm_unpackhi_epi64(b, b));
+			const __m128i nextB = _mm_unpacklo_epi8(_mm_unpackhi_epi64(a, a), c);
+			const __m128i nextC = _mm_unpacklo_epi8(b, _mm_unpackhi_epi64(c, c));
+			a = nextA;
+			b = nextB;
+			c = nextC;
+		}
+
+		// Weights add up to 256, so the 16-bit sums can't overflow
+		__m128i lumaLo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), redWeight),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), greenWeight));
+		lumaLo = _mm_add_epi16(lumaLo, _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), blueWeight));
+		__m128i lumaHi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), redWeight),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), greenWeight));
+		lumaHi = _mm_add_epi16(lumaHi, _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), blueWeight));
+		lumaLo = _mm_srli_epi16(_mm_add_epi16(lumaLo, rounding), 8);
+		lumaHi = _mm_srli_epi16(_mm_add_epi16(lumaHi, rounding), 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lumaRow + x), _mm_packus_epi16(lumaLo, lumaHi));
+	}
+#endif
+	for (; x < width; ++x)
+	{
+		lumaRow[x] = static_cast<uint8_t>((GetWeightedLuma(rgbRow + x * 3) + 128) >> 8);
+	}
+}
+
+void MeasureFrameStatistics(const uint8_t* rgbPixels, int width, int height, FrameStatistics& statistics)
+{
+	// Scratch kept by every decoding thread, like its decoded pixels
+	thread_local vector<uint8_t> lumaRow;
+	thread_local vector<uint32_t> cellSums;
+
+	statistics.CellsX = width / LumaCellSize;
+	statistics.CellsY = height / LumaCellSize;
+	statistics.Cells.resize(size_t(statistics.CellsX) * statistics.CellsY);
+	if (lumaRow.size() < size_t(width)) lumaRow.resize(width);
+	cellSums.assign(statistics.CellsX, 0);
+
+	// Four histograms in turn, so runs of pixels in the same bin don't wait on each other's increments
+	uint32_t binCounts[4][LumaHistogramBins] = {};
+	uint64_t lumaSum = 0;
+	uint64_t sampleCount = 0;
+	uint64_t histogramSampleCount = 0;
+	for (int y = 0; y < height; y += SampledRowStep)
+	{
+		const uint8_t* rgbRow = rgbPixels + size_t(y) * width * 3;
+		lumaSum += AccumulateLumaRow(rgbRow, width, statistics.CellsX, cellSums.data());
+		sampleCount += width;
+
+		const uint8_t* luma = lumaRow.data();
+		int x = width;
+		if (y % HistogramRowStep == 0)
+		{
+			ConvertLumaRow(rgbRow, width, lumaRow.data());
+			histogramSampleCount += width;
+			x = 0;
+		}
+		for (; x + 4 <= width; x += 4)
+		{
+			binCounts[0][luma[x + 0] >> 2]++;
+			binCounts[1][luma[x + 1] >> 2]++;
+			binCounts[2][luma[x + 2] >> 2]++;
+			binCounts[3][luma[x + 3] >> 2]++;
+		}
+		for (; x < width; ++x)
+		{
+			binCounts[0][luma[x] >> 2]++;
+		}
+
+		// Cells are complete with their last sampled row, the rows past the last whole cell only count for the mean
+		// and histogram
+		if (y % LumaCellSize + SampledRowStep < LumaCellSize) continue;
+		const int cellY = y / LumaCellSize;
+		if (cellY < statistics.CellsY)
+		{
+			uint8_t* cells = statistics.Cells.data() + size_t(cellY) * statistics.CellsX;
+			for (int cellX = 0; cellX < statistics.CellsX; ++cellX)
+			{
+				cells[cellX] = static_cast<uint8_t>((cellSums[cellX] + CellDivisor / 2) / CellDivisor);
+			}
+		}
+		std::fill(cellSums.begin(), cellSums.end(), 0);
+	}
+
+	statistics.MeanLuma = sampleCount > 0 ? static_cast<float>(double(lumaSum) / sampleCount / (256.0 * 255.0)) : 0.0f;
+	for (int binIt = 0; binIt < LumaHistogramBins; ++binIt)
+	{
+		const uint32_t count = binCounts[0][binIt] + binCounts[1][binIt] + binCounts[2][binIt] + binCounts[3][binIt];
+		statistics.Histogram[binIt] =
+			histogramSampleCount > 0 ? static_cast<float>(double(count) / histogramSampleCount) : 0.0f;
+	}
+}
+
+float GetChangedRatio(const FrameStatistics& previous, const FrameStatistics& current)
+{
+	if (previous.Cells.empty() || current.Cells.empty()) return 0.0f;
+	if (previous.CellsX != current.CellsX || previous.CellsY != current.CellsY) return 1.0f;
+
+	const uint8_t* lhs = previous.Cells.data();
+	const uint8_t* rhs = current.Cells.data();
+	const size_t cellCount = current.Cells.size();
+	uint64_t changedCount = 0;
+	size_t cellIt = 0;
+#if STATISTICS_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i threshold = _mm_set1_epi8(static_cast<char>(ChangedLumaThreshold));
+	__m128i changedCounts = zero;
+	for (; cellIt + 16 <= cellCount; cellIt += 16)
+	{
+		// Absolute difference of unsigned bytes, then whatever is left above the threshold
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + cellIt));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + cellIt));
+		const __m128i difference = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+		const __m128i unchanged = _mm_cmpeq_epi8(_mm_subs_epu8(difference, threshold), zero);
+		changedCounts = _mm_add_epi64(changedCounts, _mm_sad_epu8(_mm_andnot_si128(unchanged, one), zero));
+	}
+	changedCount = static_cast<uint32_t>(_mm_cvtsi128_si32(changedCounts)) +
+				   static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(changedCounts, changedCounts)));
+#endif
+	for (; cellIt < cellCount; ++cellIt)
+	{
+		const int difference = lhs[cellIt] > rhs[cellIt] ? lhs[cellIt] - rhs[cellIt] : rhs[cellIt] - lhs[cellIt];
+		if (difference > ChangedLumaThreshold) changedCount++;
+	}
+	return static_cast<float>(double(changedCount) / cellCount);
+}
+
+size_t GetPackedStatisticsSize(const FrameStatistics& statistics)
+{
+	return sizeof(PackedStatisticsHeader) + statistics.Cells.size();
+}
+
+void PackFrameStatistics(const FrameStatistics& statistics, uint8_t* bytes)
+{
+	PackedStatisticsHeader header;
+	header.CellsX = static_cast<uint32_t>(statistics.CellsX);
+	header.CellsY = static_cast<uint32_t>(statistics.CellsY);
+	header.MeanLuma = statistics.MeanLuma;
+	memcpy(header.Histogram, statistics.Histogram, sizeof(header.Histogram));
+	memcpy(bytes, &header, sizeof(header));
+	memcpy(bytes + sizeof(header), statistics.Cells.data(), statistics.Cells.size());
+}
+
+bool UnpackFrameStatistics(const uint8_t* bytes, size_t size, FrameStatistics& statistics)
+{
+	PackedStatisticsHeader header;
+	if (size < sizeof(header)) return false;
+	memcpy(&header, bytes, sizeof(header));
+	if (size != sizeof(header) + size_t(header.CellsX) * header.CellsY) return false;
+
+	statistics.CellsX = static_cast<int>(header.CellsX);
+	statistics.CellsY = static_cast<int>(header.CellsY);
+	statistics.MeanLuma = header.MeanLuma;
+	memcpy(statistics.Histogram, header.Histogram, sizeof(header.Histogram));
+	statistics.Cells.assign(bytes + sizeof(header), bytes + size);
+	return true;
+}
+
+void FrameStatisticsSeries::SetFrame(int frameIndex, const FrameStatistics& statistics, float changedRatio)
+{
+	if (frameIndex < 0) return;
+	if (_meanLuma.size() <= static_cast<size_t>(frameIndex))
+	{
+		_meanLuma.resize(frameIndex + 1, 0.0f);
+		_changedRatio.resize(frameIndex + 1, 0.0f);
+		_histograms.resize(size_t(frameIndex + 1) * LumaHistogramBins, 0.0f);
+	}
+	_meanLuma[frameIndex] = statistics.MeanLuma;
+	_changedRatio[frameIndex] = changedRatio;
+	memcpy(_histograms.data() + size_t(frameIndex) * LumaHistogramBins, statistics.Histogram,
+		sizeof(statistics.Histogram));
+}
+
+void FrameStatisticsSeries::Clear()
+{
+	_meanLuma.clear();
+	_changedRatio.clear();
+	_histograms.clear();
+}
+
+void FrameStatisticsSeries::GetRangeHistogram(int firstFrame, int frameCount, float histogram[LumaHistogramBins]) const
+{
+	memset(histogram, 0, sizeof(float) * LumaHistogramBins);
+	if (firstFrame < 0) firstFrame = 0;
+	if (frameCount > GetFrameCount() - firstFrame) frameCount = GetFrameCount() - firstFrame;
+	if (frameCount <= 0) return;
+
+	// Frames are consecutive rows of the histogram array, summed bin by bin in registers
+	const float* frameHistogram = _histograms.data() + size_t(firstFrame) * LumaHistogramBins;
+#if STATISTICS_USE_SSE2
+	__m128 sums[LumaHistogramBins / 4];
+	for (__m128& sum : sums)
+	{
+		sum = _mm_setzero_ps();
+	}
+	for (int frameIt = 0; frameIt < frameCount; ++frameIt, frameHistogram += LumaHistogramBins)
+	{
+		for (int vectorIt = 0; vectorIt < LumaHistogramBins / 4; ++vectorIt)
+		{
+			sums[vectorIt] = _mm_add_ps(sums[vectorIt], _mm_loadu_ps(frameHistogram + vectorIt * 4));
+		}
+	}
+	const __m128 scale = _mm_set1_ps(1.0f / frameCount);
+	for (int vectorIt = 0; vectorIt < LumaHistogramBins / 4; ++vectorIt)
+	{
+		_mm_storeu_ps(histogram + vectorIt * 4, _mm_mul_ps(sums[vectorIt], scale));
+	}
+#else
+	for (int frameIt = 0; frameIt < frameCount; ++frameIt, frameHistogram += LumaHistogramBins)
+	{
+		for (int binIt = 0; binIt < LumaHistogramBins; ++binIt)
+		{
+			histogram[binIt] += frameHistogram[binIt];
+		}
+	}
+	for (int binIt = 0; binIt < LumaHistogramBins; ++binIt)
+	{
+		histogram[binIt] /= frameCount;
+	}
+#endif
+}
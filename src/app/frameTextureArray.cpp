@@ -0,0 +1,279 @@
+#include <app/frameTextureArray.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <deque>
+
+// Third Party Includes
+#include <glad/glad.h>
+#include <imgui/imgui.h>
+
+// Internal Includes
+#include <app/blockCompression.h>
+
+// Not part of the core profile loader, but exposed by every desktop driver
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+static size_t GetLayerBytes(int width, int height, FramePixelFormat format)
+{
+	return format == FramePixelFormat::BC1 ? GetBC1DataSize(width, height) : size_t(width) * height * 3;
+}
+
+FrameLayer FrameTextureArrays::Allocate(int width, int height, FramePixelFormat format)
+{
+	for (Chunk& chunk : _chunks)
+	{
+		if (chunk.Width != width || chunk.Height != height || chunk.Format != format || chunk.FreeLayers.empty())
+		{
+			continue;
+		}
+		const int layer = chunk.FreeLayers.back();
+		chunk.FreeLayers.pop_back();
+		return {chunk.TextureId, layer};
+	}
+
+	// Every chunk of this size is full, the new one is sized for the frames that fit in ChunkTargetBytes
+	const size_t layerBytes = GetLayerBytes(width, height, format);
+	const int maxLayers = max(min(_maxChunkLayers, MaxLayersPerChunk), 1);
+	Chunk chunk;
+	chunk.Width = width;
+	chunk.Height = height;
+	chunk.Format = format;
+	chunk.LayerCount = static_cast<int>(max(min(ChunkTargetBytes / layerBytes, size_t(maxLayers)), size_t(1)));
+
+	// Storage is left uninitialized, it must not be sourced from a staging buffer that is still bound
+	glGenTextures(1, &chunk.TextureId);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, chunk.TextureId);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	if (format == FramePixelFormat::BC1)
+	{
+		glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, width, height,
+			chunk.LayerCount, 0, static_cast<GLsizei>(layerBytes * chunk.LayerCount), nullptr);
+	}
+	else
+	{
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, width, height, chunk.LayerCount, 0, GL_RGB, GL_UNSIGNED_BYTE,
+			nullptr);
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// Layers are handed out from the first one
+	for (int layer = chunk.LayerCount - 1; layer > 0; --layer)
+	{
+		chunk.FreeLayers.push_back(layer);
+	}
+	_chunks.push_back(std::move(chunk));
+	return {_chunks.back().TextureId, 0};
+}
+
+void FrameTextureArrays::Free(const FrameLayer& layer)
+{
+	Chunk* chunk = FindChunk(layer.TextureId);
+	if (chunk == nullptr) return;
+
+	chunk->FreeLayers.push_back(layer.Layer);
+	if (static_cast<int>(chunk->FreeLayers.size()) < chunk->LayerCount) return;
+
+	glDeleteTextures(1, &chunk->TextureId);
+	*chunk = std::move(_chunks.back());
+	_chunks.pop_back();
+}
+
+bool FrameTextureArrays::Fits(const FrameLayer& layer, int width, int height, FramePixelFormat format) const
+{
+	const Chunk* chunk = FindChunk(layer.TextureId);
+	return chunk != nullptr && chunk->Width == width && chunk->Height == height && chunk->Format == format;
+}
+
+void FrameTextureArrays::Upload(const FrameLayer& layer, size_t dataSize, const void* pixels)
+{
+	const Chunk* chunk = FindChunk(layer.TextureId);
+	if (chunk == nullptr) return;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, chunk->TextureId);
+	if (chunk->Format == FramePixelFormat::BC1)
+	{
+		glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer.Layer, chunk->Width, chunk->Height, 1,
+			GL_COMPRESSED_RGB_S3TC_DXT1_EXT, static_cast<GLsizei>(dataSize), pixels);
+	}
+	else
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer.Layer, chunk->Width, chunk->Height, 1, GL_RGB,
+			GL_UNSIGNED_BYTE, pixels);
+	}
+}
+
+void FrameTextureArrays::Release()
+{
+	for (Chunk& chunk : _chunks)
+	{
+		glDeleteTextures(1, &chunk.TextureId);
+	}
+	_chunks.clear();
+}
+
+FrameTextureArrays::Chunk* FrameTextureArrays::FindChunk(unsigned int textureId)
+{
+	auto chunkIt = std::find_if(_chunks.begin(), _chunks.end(),
+		[textureId](const Chunk& chunk) { return chunk.TextureId == textureId; });
+	return chunkIt != _chunks.end() ? &*chunkIt : nullptr;
+}
+
+const FrameTextureArrays::Chunk* FrameTextureArrays::FindChunk(unsigned int textureId) const
+{
+	return const_cast<FrameTextureArrays*>(this)->FindChunk(textureId);
+}
+
+// Same vertex layout and projection as the ImGui backend shader, sampling a layer of an array texture
+static const char* LayerVertexShader = "#version 330 core\n"
+									   "uniform mat4 ProjMtx;\n"
+									   "in vec2 Position;\n"
+									   "in vec2 UV;\n"
+									   "in vec4 Color;\n"
+									   "out vec2 Frag_UV;\n"
+									   "out vec4 Frag_Color;\n"
+									   "void main()\n"
+									   "{\n"
+									   "    Frag_UV = UV;\n"
+									   "    Frag_Color = Color;\n"
+									   "    gl_Position = ProjMtx * vec4(Position.xy, 0, 1);\n"
+									   "}\n";
+
+static const char* LayerFragmentShader = "#version 330 core\n"
+										 "uniform sampler2DArray Texture;\n"
+										 "uniform float Layer;\n"
+										 "in vec2 Frag_UV;\n"
+										 "in vec4 Frag_Color;\n"
+										 "layout (location = 0) out vec4 Out_Color;\n"
+										 "void main()\n"
+										 "{\n"
+										 "    Out_Color = Frag_Color * texture(Texture, vec3(Frag_UV.st, Layer));\n"
+										 "}\n";
+
+// Layer shown by one FrameLayerImage, referenced by its draw callback until the frame is rendered
+struct LayerDraw
+{
+	unsigned int TextureId;
+	int Layer;
+};
+
+struct LayerShader
+{
+	GLuint Program = 0;
+	GLint ProjMtxLocation = -1;
+	GLint TextureLocation = -1;
+	GLint LayerLocation = -1;
+	bool Failed = false; // Not built again, the layers are drawn with the ImGui shader (blank)
+};
+
+static LayerShader layerShader;
+static std::deque<LayerDraw> layerDraws;
+static int layerDrawsFrame = -1;
+
+static GLuint CompileShader(GLenum type, const char* source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled != GL_TRUE)
+	{
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+// Built on first use, when the program of the ImGui backend is known: the backend sets the vertex attributes up
+// for the locations of its own shader, so ours are bound to the same ones
+static bool BuildLayerShader(GLuint imguiProgram)
+{
+	if (layerShader.Program != 0 || layerShader.Failed) return layerShader.Program != 0;
+	layerShader.Failed = true;
+
+	GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, LayerVertexShader);
+	GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, LayerFragmentShader);
+	if (vertexShader == 0 || fragmentShader == 0)
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return false;
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+	for (const char* attribute : {"Position", "UV", "Color"})
+	{
+		const GLint location = glGetAttribLocation(imguiProgram, attribute);
+		if (location >= 0) glBindAttribLocation(program, static_cast<GLuint>(location), attribute);
+	}
+	glLinkProgram(program);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE)
+	{
+		glDeleteProgram(program);
+		return false;
+	}
+
+	layerShader.Program = program;
+	layerShader.ProjMtxLocation = glGetUniformLocation(program, "ProjMtx");
+	layerShader.TextureLocation = glGetUniformLocation(program, "Texture");
+	layerShader.LayerLocation = glGetUniformLocation(program, "Layer");
+	layerShader.Failed = false;
+	return true;
+}
+
+// Runs in the middle of the ImGui draw data, right before the image of the layer
+static void OnDrawFrameLayer(const ImDrawList* /*drawList*/, const ImDrawCmd* drawCmd)
+{
+	GLint imguiProgram = 0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &imguiProgram);
+	if (!BuildLayerShader(static_cast<GLuint>(imguiProgram))) return;
+
+	// The projection differs from one viewport to the other, take the one ImGui is drawing with
+	GLfloat projection[16];
+	glGetUniformfv(imguiProgram, glGetUniformLocation(imguiProgram, "ProjMtx"), projection);
+
+	// The array goes to a unit of its own, ImGui binds the (null) image texture to the first one
+	const LayerDraw& layerDraw = *static_cast<const LayerDraw*>(drawCmd->UserCallbackData);
+	glUseProgram(layerShader.Program);
+	glUniformMatrix4fv(layerShader.ProjMtxLocation, 1, GL_FALSE, projection);
+	glUniform1i(layerShader.TextureLocation, 1);
+	glUniform1f(layerShader.LayerLocation, static_cast<float>(layerDraw.Layer));
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, layerDraw.TextureId);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void FrameLayerImage(const FrameLayer& layer, const ImVec2& size)
+{
+	// Callback data lives until the frame is rendered, it is dropped once the next one starts
+	if (layerDrawsFrame != ImGui::GetFrameCount())
+	{
+		layerDraws.clear();
+		layerDrawsFrame = ImGui::GetFrameCount();
+	}
+	layerDraws.push_back({layer.TextureId, layer.Layer});
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	drawList->AddCallback(OnDrawFrameLayer, &layerDraws.back());
+	ImGui::Image(ImTextureID(), size);
+	drawList->AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+}
+
+void ReleaseFrameLayerShader()
+{
+	if (layerShader.Program != 0) glDeleteProgram(layerShader.Program);
+	layerShader = LayerShader();
+}
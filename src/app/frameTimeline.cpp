@@ -0,0 +1,217 @@
+#include <app/frameTimeline.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static int64_t MillisecondsToUs(double milliseconds)
+{
+	return static_cast<int64_t>(std::llround(milliseconds * 1000.0));
+}
+
+// "<file name>,<milliseconds>" per line, anything else (headers, comments) is skipped
+static void ParseTimestampsCsv(const string& text, std::unordered_map<string, int64_t>& timestamps)
+{
+	std::istringstream lines(text);
+	string line;
+	while (std::getline(lines, line))
+	{
+		const size_t comma = line.find(',');
+		if (comma == string::npos) continue;
+
+		const char* timeBegin = line.c_str() + comma + 1;
+		char* timeEnd = nullptr;
+		const double milliseconds = strtod(timeBegin, &timeEnd);
+		if (timeEnd == timeBegin) continue;
+
+		string name = line.substr(0, comma);
+		name.erase(std::remove(name.begin(), name.end(), '"'), name.end());
+		timestamps[name] = MillisecondsToUs(milliseconds);
+	}
+}
+
+// Flat object of "<file name>": <milliseconds>, scanned as string/number pairs (no general JSON support)
+static void ParseTimestampsJson(const string& text, std::unordered_map<string, int64_t>& timestamps)
+{
+	string key;
+	bool hasKey = false;
+	for (size_t offset = 0; offset < text.size();)
+	{
+		const char c = text[offset];
+		if (c == '"')
+		{
+			const size_t end = text.find('"', offset + 1);
+			if (end == string::npos) return;
+			key = text.substr(offset + 1, end - offset - 1);
+			hasKey = true;
+			offset = end + 1;
+		}
+		else if (hasKey && (isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.'))
+		{
+			char* numberEnd = nullptr;
+			const double milliseconds = strtod(text.c_str() + offset, &numberEnd);
+			timestamps[key] = MillisecondsToUs(milliseconds);
+			hasKey = false;
+			offset = numberEnd - text.c_str();
+		}
+		else
+		{
+			++offset;
+		}
+	}
+}
+
+static bool ReadTextFile(const string& path, string& text)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	std::ostringstream stream;
+	stream << file.rdbuf();
+	text = stream.str();
+	return true;
+}
+
+int64_t ParseFrameNameTimestamp(std::string_view fileName)
+{
+	const size_t extPos = fileName.find_last_of('.');
+	const std::string_view stem = fileName.substr(0, extPos);
+
+	// Last "_<digits>(ms|us)" token, the unit closes the stem
+	if (stem.size() < 4) return -1;
+	const std::string_view unit = stem.substr(stem.size() - 2);
+	if (unit != "ms" && unit != "us") return -1;
+
+	size_t digitsBegin = stem.size() - 2;
+	while (digitsBegin > 0 && isdigit(static_cast<unsigned char>(stem[digitsBegin - 1])))
+	{
+		--digitsBegin;
+	}
+	if (digitsBegin == stem.size() - 2 || digitsBegin == 0 || stem[digitsBegin - 1] != '_') return -1;
+
+	int64_t value = 0;
+	for (size_t digitIt = digitsBegin; digitIt < stem.size() - 2; ++digitIt)
+	{
+		value = value * 10 + (stem[digitIt] - '0');
+	}
+	return unit == "ms" ? value * 1000 : value;
+}
+
+int64_t FrameTimestampResolver::Resolve(const string& imagePath)
+{
+	const size_t separator = imagePath.find_last_of("/\\");
+	const string directory = imagePath.substr(0, separator + 1);
+	const string fileName = imagePath.substr(separator + 1);
+
+	const NameTimestamps& sidecar = GetDirectory(directory);
+	auto found = sidecar.find(fileName);
+	if (found != sidecar.end()) return found->second;
+
+	return ParseFrameNameTimestamp(fileName);
+}
+
+const FrameTimestampResolver::NameTimestamps& FrameTimestampResolver::GetDirectory(const string& directory)
+{
+	auto found = _directories.find(directory);
+	if (found != _directories.end()) return found->second;
+
+	NameTimestamps& timestamps = _directories[directory];
+	string text;
+	if (ReadTextFile(directory + "timestamps.csv", text))
+	{
+		ParseTimestampsCsv(text, timestamps);
+	}
+	else if (ReadTextFile(directory + "timestamps.json", text))
+	{
+		ParseTimestampsJson(text, timestamps);
+	}
+	return timestamps;
+}
+
+void FrameTimeline::Append(int64_t timestampUs)
+{
+	const int64_t previousStartUs = _startTimesUs.empty() ? 0 : _startTimesUs.back();
+	const int64_t deltaUs = timestampUs - _lastTimestampUs;
+	const bool validDelta = timestampUs >= 0 && _lastTimestampUs >= 0 && deltaUs > 0;
+
+	if (_startTimesUs.empty()) _startTimesUs.push_back(0);
+	else _startTimesUs.push_back(previousStartUs + (validDelta ? deltaUs : NominalFrameUs));
+
+	if (timestampUs >= 0 && _originUs < 0) _originUs = timestampUs - _startTimesUs.back();
+	if (timestampUs >= 0) _timestampedCount++;
+	_lastTimestampUs = timestampUs;
+}
+
+void FrameTimeline::Clear()
+{
+	_startTimesUs.clear();
+	_lastTimestampUs = -1;
+	_originUs = -1;
+	_timestampedCount = 0;
+	_statisticsFrameCount = 0;
+	_medianDurationUs = NominalFrameUs;
+	_hitches.clear();
+}
+
+int64_t FrameTimeline::GetFrameDuration(int frameIndex) const
+{
+	if (frameIndex + 1 < static_cast<int>(_startTimesUs.size()))
+	{
+		return _startTimesUs[frameIndex + 1] - _startTimesUs[frameIndex];
+	}
+	return _medianDurationUs;
+}
+
+int64_t FrameTimeline::GetTotalTime() const
+{
+	if (_startTimesUs.empty()) return 0;
+	return _startTimesUs.back() + _medianDurationUs;
+}
+
+int FrameTimeline::FindFrame(int64_t timeUs) const
+{
+	if (_startTimesUs.empty()) return 0;
+
+	// Last frame starting at or before the given time
+	auto next = std::upper_bound(_startTimesUs.begin(), _startTimesUs.end(), timeUs);
+	return std::max(0, static_cast<int>(next - _startTimesUs.begin()) - 1);
+}
+
+const vector<int>& FrameTimeline::GetHitches()
+{
+	UpdateStatistics();
+	return _hitches;
+}
+
+int64_t FrameTimeline::GetMedianDuration()
+{
+	UpdateStatistics();
+	return _medianDurationUs;
+}
+
+void FrameTimeline::UpdateStatistics()
+{
+	const int frameCount = static_cast<int>(_startTimesUs.size());
+	if (frameCount == _statisticsFrameCount) return;
+	_statisticsFrameCount = frameCount;
+	_hitches.clear();
+	if (frameCount < 2) return;
+
+	vector<int64_t> durations(frameCount - 1);
+	for (int frameIt = 0; frameIt + 1 < frameCount; ++frameIt)
+	{
+		durations[frameIt] = _startTimesUs[frameIt + 1] - _startTimesUs[frameIt];
+	}
+	const auto median = durations.begin() + durations.size() / 2;
+	std::nth_element(durations.begin(), median, durations.end());
+	_medianDurationUs = *median;
+
+	for (int frameIt = 0; frameIt + 1 < frameCount; ++frameIt)
+	{
+		if (GetFrameDuration(frameIt) > _medianDurationUs * HitchFactor) _hitches.push_back(frameIt);
+	}
+}
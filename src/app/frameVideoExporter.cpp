@@ -0,0 +1,280 @@
+#include <app/frameVideoExporter.h>
+
+// StdLib Includes
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+// Third Party Includes
+#include <fmt/core.h>
+
+// Internal Includes
+#include <app/frameTimeline.h>
+
+using steadyClock = std::chrono::steady_clock;
+
+static constexpr char Y4MFrameHeader[] = "FRAME\n";
+static constexpr size_t Y4MFrameHeaderSize = sizeof(Y4MFrameHeader) - 1;
+
+// Luma plane followed by the two chroma planes, subsampled 2x2 (rounded up for odd sizes)
+static size_t GetYuv420Size(int width, int height)
+{
+	const size_t chromaSize = size_t((width + 1) / 2) * ((height + 1) / 2);
+	return size_t(width) * height + chromaSize * 2;
+}
+
+// Nearest pixel, frames of another size than the video are rare (resolution changed mid-capture)
+static void ScaleNearest(const uint8_t* source, int sourceWidth, int sourceHeight, uint8_t* destination,
+	int destinationWidth, int destinationHeight)
+{
+	for (int y = 0; y < destinationHeight; ++y)
+	{
+		const uint8_t* sourceRow = source + size_t(y * sourceHeight / destinationHeight) * sourceWidth * 3;
+		uint8_t* destinationRow = destination + size_t(y) * destinationWidth * 3;
+		for (int x = 0; x < destinationWidth; ++x)
+		{
+			memcpy(destinationRow + x * 3, sourceRow + size_t(x * sourceWidth / destinationWidth) * 3, 3);
+		}
+	}
+}
+
+// BT.601 studio range. Chroma comes from the average of every 2x2 pixels, which sits at their center (C420jpeg).
+static void ConvertRGBToYuv420(const uint8_t* rgb, int width, int height, uint8_t* yuv)
+{
+	const int chromaWidth = (width + 1) / 2;
+	const int chromaHeight = (height + 1) / 2;
+	uint8_t* lumaPlane = yuv;
+	uint8_t* uPlane = lumaPlane + size_t(width) * height;
+	uint8_t* vPlane = uPlane + size_t(chromaWidth) * chromaHeight;
+
+	const size_t pixelCount = size_t(width) * height;
+	for (size_t pixelIt = 0; pixelIt < pixelCount; ++pixelIt)
+	{
+		const int r = rgb[pixelIt * 3 + 0];
+		const int g = rgb[pixelIt * 3 + 1];
+		const int b = rgb[pixelIt * 3 + 2];
+		lumaPlane[pixelIt] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+	}
+
+	for (int chromaY = 0; chromaY < chromaHeight; ++chromaY)
+	{
+		const uint8_t* topRow = rgb + size_t(chromaY * 2) * width * 3;
+		const uint8_t* bottomRow = rgb + size_t(min(chromaY * 2 + 1, height - 1)) * width * 3;
+		uint8_t* uRow = uPlane + size_t(chromaY) * chromaWidth;
+		uint8_t* vRow = vPlane + size_t(chromaY) * chromaWidth;
+		for (int chromaX = 0; chromaX < chromaWidth; ++chromaX)
+		{
+			const int left = chromaX * 2 * 3;
+			const int right = min(chromaX * 2 + 1, width - 1) * 3;
+			const int r = topRow[left + 0] + topRow[right + 0] + bottomRow[left + 0] + bottomRow[right + 0];
+			const int g = topRow[left + 1] + topRow[right + 1] + bottomRow[left + 1] + bottomRow[right + 1];
+			const int b = topRow[left + 2] + topRow[right + 2] + bottomRow[left + 2] + bottomRow[right + 2];
+
+			// Sums of four pixels, the average is folded into the shift
+			uRow[chromaX] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 512) >> 10) + 128);
+			vRow[chromaX] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 512) >> 10) + 128);
+		}
+	}
+}
+
+// Enough lines to keep every worker converting, few enough to bound the frames held in memory
+static size_t GetPipelineLineCount(const tf::Executor& executor)
+{
+	return min(max(executor.num_workers(), size_t(2)), FrameVideoExporter::MaxPipelineLines);
+}
+
+FrameVideoExporter::FrameVideoExporter(tf::Executor& executor)
+	: _executor(executor),
+	  _exportPipeline(GetPipelineLineCount(executor),
+		  tf::Pipe<> {tf::PipeType::SERIAL, [this](tf::Pipeflow& pf) { EmitStage(pf); }},
+		  tf::Pipe<> {tf::PipeType::PARALLEL, [this](tf::Pipeflow& pf) { ConvertStage(pf); }},
+		  tf::Pipe<> {tf::PipeType::SERIAL, [this](tf::Pipeflow& pf) { WriteStage(pf); }}),
+	  _exportLines(GetPipelineLineCount(executor))
+{
+	tf::Task pipelineTask = _taskFlow.composed_of(_exportPipeline).name("pipeline");
+	tf::Task closeTask = _taskFlow.emplace([this]() { CloseFile(); }).name("close");
+	pipelineTask.precede(closeTask);
+}
+
+FrameVideoExporter::~FrameVideoExporter() { Cancel(); }
+
+bool FrameVideoExporter::Export(const string& filePath, vector<FrameSource> frameSources, FrameTimeline& timeline,
+	int width, int height, string* error)
+{
+	if (IsExporting())
+	{
+		if (error != nullptr) *error = "An export is already running";
+		return false;
+	}
+	Wait();
+
+	if (frameSources.empty() || width <= 0 || height <= 0)
+	{
+		if (error != nullptr) *error = "There are no frames to export";
+		return false;
+	}
+
+	_file = fopen(filePath.c_str(), "wb");
+	if (_file == nullptr)
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't create {0}", filePath);
+		return false;
+	}
+
+	// Output frames last the median capture duration, every capture frame is repeated for as many output frames
+	// as it covers (or dropped if it covers none). Gaps are held for MaxFrameGapUs at most, the rest is cut.
+	const int64_t frameDurationUs = std::clamp(timeline.GetMedianDuration(), MinFrameDurationUs, MaxFrameDurationUs);
+	const int64_t timelineFrameCount =
+		max((timeline.GetTotalTime() + frameDurationUs - 1) / frameDurationUs, int64_t(1));
+	const int maxRepeat = static_cast<int>(max(FrameTimeline::MaxFrameGapUs / frameDurationUs, int64_t(1)));
+	const int lastSource = static_cast<int>(frameSources.size()) - 1;
+	size_t outputFrameCount = 0;
+	_exportFrames.clear();
+	for (int64_t outputIt = 0; outputIt < timelineFrameCount; ++outputIt)
+	{
+		const int sourceIndex = min(timeline.FindFrame(outputIt * frameDurationUs), lastSource);
+		if (_exportFrames.empty() || _exportFrames.back().SourceIndex != sourceIndex)
+		{
+			_exportFrames.push_back({sourceIndex, 1});
+		}
+		else if (++_exportFrames.back().Repeat == maxRepeat && sourceIndex < lastSource)
+		{
+			// Skip to the output frame the next capture frame starts on
+			const int64_t nextStartUs = timeline.GetFrameTime(sourceIndex + 1);
+			outputIt = max(outputIt, (nextStartUs + frameDurationUs - 1) / frameDurationUs - 1);
+		}
+		outputFrameCount++;
+	}
+
+	const int64_t rateDivisor = std::gcd(int64_t(1000000), frameDurationUs);
+	const string header = fmt::format("YUV4MPEG2 W{0} H{1} F{2}:{3} Ip A1:1 C420jpeg\n", width, height,
+		1000000 / rateDivisor, frameDurationUs / rateDivisor);
+	fwrite(header.data(), 1, header.size(), _file);
+
+	// Frames failing before any was written show as black
+	_lastYuv.assign(GetYuv420Size(width, height), 128);
+	memset(_lastYuv.data(), 16, size_t(width) * height);
+
+	_frameSources = std::move(frameSources);
+	_width = width;
+	_height = height;
+	_filePath = filePath;
+	_error.clear();
+	_outputFrameCount = outputFrameCount;
+	_writtenCount = 0;
+	_failedCount = 0;
+	_writtenBytes = header.size();
+	_startTime = steadyClock::now();
+	_elapsedNs = 0;
+	_cancelRequested = false;
+
+	// Token identifiers must start from zero on every run
+	_exportPipeline.reset();
+	_exportHandle = _executor.run(_taskFlow);
+	return true;
+}
+
+void FrameVideoExporter::Cancel()
+{
+	_cancelRequested = true;
+	Wait();
+	_cancelRequested = false;
+}
+
+void FrameVideoExporter::Wait()
+{
+	if (_exportHandle.valid())
+	{
+		_exportHandle.wait();
+	}
+}
+
+bool FrameVideoExporter::IsExporting() const
+{
+	return _exportHandle.valid() && _exportHandle.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+double FrameVideoExporter::GetElapsedSeconds() const
+{
+	if (IsExporting()) return std::chrono::duration<double>(steadyClock::now() - _startTime).count();
+	return _elapsedNs * 1.0e-9;
+}
+
+void FrameVideoExporter::EmitStage(tf::Pipeflow& pf)
+{
+	if (pf.token() == _exportFrames.size() || _cancelRequested)
+	{
+		pf.stop();
+		return;
+	}
+
+	ExportLine& line = _exportLines[pf.line()];
+	line.FrameIndex = pf.token();
+	line.Converted = false;
+}
+
+void FrameVideoExporter::ConvertStage(tf::Pipeflow& pf)
+{
+	ExportLine& line = _exportLines[pf.line()];
+	if (_cancelRequested) return;
+
+	LoadImageJob job;
+	FrameDecodeOptions decodeOptions;
+	decodeOptions.Format = FramePixelFormat::RGB8;
+	const FrameSource& source = _frameSources[_exportFrames[line.FrameIndex].SourceIndex];
+	if (!FrameLoader::DecodeFrameSource(source, job, decodeOptions)) return;
+
+	const uint8_t* pixels = static_cast<const uint8_t*>(job.ImageData);
+	if (job.Width != _width || job.Height != _height)
+	{
+		line.ScaledPixels.resize(size_t(_width) * _height * 3);
+		ScaleNearest(pixels, job.Width, job.Height, line.ScaledPixels.data(), _width, _height);
+		pixels = line.ScaledPixels.data();
+	}
+	line.Yuv.resize(GetYuv420Size(_width, _height));
+	ConvertRGBToYuv420(pixels, _width, _height, line.Yuv.data());
+	line.Converted = true;
+
+	// The decoded pixels go back to the pool right away, only the YUV frame waits for its turn to be written
+	FrameLoader::ReleaseImageData(job);
+}
+
+void FrameVideoExporter::WriteStage(tf::Pipeflow& pf)
+{
+	ExportLine& line = _exportLines[pf.line()];
+	if (!_error.empty() || _cancelRequested) return;
+
+	// The line takes the buffer of the previous frame in exchange, nothing is copied
+	if (line.Converted)
+	{
+		_lastYuv.swap(line.Yuv);
+	}
+	else
+	{
+		_failedCount++;
+	}
+
+	const int repeat = _exportFrames[line.FrameIndex].Repeat;
+	for (int repeatIt = 0; repeatIt < repeat; ++repeatIt)
+	{
+		if (fwrite(Y4MFrameHeader, 1, Y4MFrameHeaderSize, _file) != Y4MFrameHeaderSize ||
+			fwrite(_lastYuv.data(), 1, _lastYuv.size(), _file) != _lastYuv.size())
+		{
+			_error = fmt::format("Couldn't write to {0} (is the disk full?)", _filePath);
+			_cancelRequested = true;
+			return;
+		}
+		_writtenBytes += Y4MFrameHeaderSize + _lastYuv.size();
+		_writtenCount++;
+	}
+}
+
+void FrameVideoExporter::CloseFile()
+{
+	if (fclose(_file) != 0 && _error.empty())
+	{
+		_error = fmt::format("Couldn't write to {0} (is the disk full?)", _filePath);
+	}
+	_file = nullptr;
+	_elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(steadyClock::now() - _startTime).count();
+}
@@ -0,0 +1,65 @@
+#include <app/pixelUploadRing.h>
+
+// Third Party Includes
+#include <glad/glad.h>
+
+int PixelUploadRing::Acquire(size_t size)
+{
+	if (IsFull()) return -1;
+
+	const int slotIndex = (_nextSlot + _usedCount) % static_cast<int>(_slots.size());
+	Slot& slot = _slots[slotIndex];
+	if (slot.BufferId == 0) glGenBuffers(1, &slot.BufferId);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.BufferId);
+
+	// Storage is kept from one frame to the next, it only has to be specified again to grow
+	if (slot.Capacity < size)
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+		slot.Capacity = size;
+		_bufferAllocationCount++;
+	}
+	_usedCount++;
+	return slotIndex;
+}
+
+uint8_t* PixelUploadRing::Map(int slotIndex, size_t size)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _slots[slotIndex].BufferId);
+	return static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+}
+
+bool PixelUploadRing::Unmap(int slotIndex)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _slots[slotIndex].BufferId);
+	return glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+}
+
+void PixelUploadRing::Bind(int slotIndex) const
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _slots[slotIndex].BufferId);
+}
+
+void PixelUploadRing::Unacquire()
+{
+	if (_usedCount > 0) _usedCount--;
+}
+
+void PixelUploadRing::Free()
+{
+	if (_usedCount == 0) return;
+	_nextSlot = (_nextSlot + 1) % static_cast<int>(_slots.size());
+	_usedCount--;
+}
+
+void PixelUploadRing::Release()
+{
+	for (Slot& slot : _slots)
+	{
+		if (slot.BufferId != 0) glDeleteBuffers(1, &slot.BufferId);
+		slot = Slot();
+	}
+	_nextSlot = 0;
+	_usedCount = 0;
+}
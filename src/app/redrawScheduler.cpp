@@ -0,0 +1,81 @@
+#include <app/redrawScheduler.h>
+
+// StdLib Includes
+#include <algorithm>
+
+// Third Party Includes
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+std::atomic<bool> RedrawScheduler::_wakeRequested = {false};
+
+void RedrawScheduler::Attach(GLFWwindow* window)
+{
+	_window = window;
+	glfwSetWindowUserPointer(window, this);
+
+	// The ImGui backend calls these before its own callbacks, so it still gets every event
+	glfwSetWindowFocusCallback(window, [](GLFWwindow* w, int) { OnInput(w); });
+	glfwSetCursorEnterCallback(window, [](GLFWwindow* w, int) { OnInput(w); });
+	glfwSetCursorPosCallback(window, [](GLFWwindow* w, double, double) { OnInput(w); });
+	glfwSetMouseButtonCallback(window, [](GLFWwindow* w, int, int, int) { OnInput(w); });
+	glfwSetScrollCallback(window, [](GLFWwindow* w, double, double) { OnInput(w); });
+	glfwSetKeyCallback(window, [](GLFWwindow* w, int, int, int, int) { OnInput(w); });
+	glfwSetCharCallback(window, [](GLFWwindow* w, unsigned int) { OnInput(w); });
+
+	// Not input, but the contents are lost (exposed, resized or restored) and have to be drawn again
+	glfwSetWindowRefreshCallback(window, OnInput);
+}
+
+bool RedrawScheduler::WaitForRedraw(double minFrameInterval, double& deltaTime)
+{
+	for (;;)
+	{
+		if (glfwWindowShouldClose(_window)) return false;
+
+		// Input and wakes are drawn as soon as the frame rate allows, other frames wait for their deadline
+		if (_wakeRequested.exchange(false)) _wokenUp = true;
+		const double requestedTime = _settleFrames > 0 || _wokenUp ? _lastDrawTime : _deadline;
+		const double dueTime = std::max(requestedTime, _lastDrawTime + minFrameInterval);
+		const double now = glfwGetTime();
+		if (now >= dueTime) break;
+
+		if (dueTime == NoDeadline)
+		{
+			glfwWaitEvents();
+		}
+		else
+		{
+			glfwWaitEventsTimeout(dueTime - now);
+		}
+	}
+
+	// The frame is due, take in whatever else arrived meanwhile
+	glfwPollEvents();
+
+	// Time spent waiting with nothing to do doesn't advance the application (playback resumes where it stopped)
+	const double now = glfwGetTime();
+	deltaTime = now - _lastDrawTime;
+	if (_deadline == NoDeadline) deltaTime = std::min(deltaTime, IdleDeltaTime);
+	_lastDrawTime = now;
+	return true;
+}
+
+void RedrawScheduler::OnFrameDrawn(double delay)
+{
+	if (_settleFrames > 0) _settleFrames--;
+	_wokenUp = false;
+	_deadline = _lastDrawTime + delay;
+}
+
+void RedrawScheduler::Wake()
+{
+	// A single empty event wakes the loop up, the next ones are only needed once it picked this one up
+	if (!_wakeRequested.exchange(true)) glfwPostEmptyEvent();
+}
+
+void RedrawScheduler::OnInput(GLFWwindow* window)
+{
+	auto* scheduler = static_cast<RedrawScheduler*>(glfwGetWindowUserPointer(window));
+	scheduler->_settleFrames = InputSettleFrames;
+}
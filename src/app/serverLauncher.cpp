@@ -1,5 +1,10 @@
 #include <app/serverLauncher.h>
 
+// StdLib Includes
+#include <charconv>
+#include <cstdlib>
+#include <iterator>
+
 // Third Party Includes
 #include <pfd.h>
 #include <fmt/format.h>
@@ -8,13 +13,29 @@
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
 #undef IMGUI_DEFINE_MATH_OPERATORS
+#include <implot/implot.h>
+
+// Platform Includes
+#if WIN32
+	#include <windows.h>
+#else
+	#include <climits>
+	#include <unistd.h>
+#endif
 
 // Internal Includes
 #include <RVCore/utils.h>
+#include <app/redrawScheduler.h>
 #include <app/settings.h>
 
 using std::string_view;
 
+#if WIN32
+static constexpr size_t AppPathSize = _MAX_PATH;
+#else
+static constexpr size_t AppPathSize = PATH_MAX;
+#endif
+
 ServerLauncherWindow::ServerLauncherWindow(bool isOpen)
 	: ShouldShow(isOpen), _settingsEntry(Settings::Register("ServerLauncherParams"))
 {
@@ -22,6 +43,7 @@ ServerLauncherWindow::ServerLauncherWindow(bool isOpen)
 	memcpy(_uprojectBuf, _uprojectFileName.c_str(), _uprojectFileName.size());
 	_uprojectBuf[_uprojectFileName.size()] = '\0';
 	_additionalParamBuf[0] = '\0';
+	_server.SetOutputCallback(RedrawScheduler::Wake);
 }
 
 ServerLauncherWindow::~ServerLauncherWindow()
@@ -31,13 +53,8 @@ ServerLauncherWindow::~ServerLauncherWindow()
 	_launchParams.clear();
 	_settingsEntry = nullptr;
 
-#if WIN32
 	// Close server-process if existing
-	if (_serverProcInfo != nullptr)
-	{
-		ForceCloseServer();
-	}
-#endif
+	_server.Stop();
 }
 
 void ServerLauncherWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
@@ -166,7 +183,7 @@ void ServerLauncherWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 				_launchParams.erase(_launchParams.begin() + _selectedParamId);
 				if (!_launchParams.empty())
 				{
-					_selectedParamId = max(_selectedParamId - 1, 0);
+					_selectedParamId = ImMax(_selectedParamId - 1, 0);
 					const auto& paramEntry = _launchParams[_selectedParamId];
 					memcpy(_paramBuf, paramEntry.c_str(), paramEntry.size() + 1);
 					_scrollTargetParamId = _selectedParamId;
@@ -187,18 +204,18 @@ void ServerLauncherWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 			_uprojectFileName = _uprojectBuf;
 		}
 
-#if WIN32
-		ImGui::BeginDisabled(_serverProcInfo != nullptr);
+		ImGui::BeginDisabled(_server.IsStarted());
 		if (ImGui::Button("Start Server"))
 		{
 			LaunchServerProcess();
 		}
 		ImGui::EndDisabled();
-		ImGui::BeginDisabled(_serverProcInfo == nullptr);
+		ImGui::BeginDisabled(!_server.IsStarted());
 		ImGui::SameLine();
 		if (ImGui::Button("Kill Server"))
 		{
-			_exitCode = ForceCloseServer();
+			_server.Stop();
+			_exitCode = 0;
 		}
 		ImGui::EndDisabled();
 		ImGui::SameLine();
@@ -209,14 +226,19 @@ void ServerLauncherWindow::Draw(ImGuiID dockSpaceId, double deltaTime)
 		ImGui::SameLine();
 		if (ImGui::Button("Clear Logs"))
 		{
-			_serverLogs.clear();
+			_logIndex.Clear();
+			_serverLogs.Clear();
+			_logRates.Clear();
+			_logRatesFollow = true;
+			_logFilter.HiddenCategories.clear();
 		}
 		ImGui::SameLine();
 		ImGui::Checkbox("Force Auto-Scroll", &_forceAutoScroll);
 		ImGui::SameLine();
+		ImGui::Checkbox("Plot Rates", &_plotLogRates);
+		ImGui::SameLine();
 		PullServerProcessStatus();
 		PullServerOutputLog();
-#endif
 	}
 	ImGui::End();
 }
@@ -229,6 +251,12 @@ void ServerLauncherWindow::DrawMenuBarWindowItems()
 	}
 }
 
+double ServerLauncherWindow::GetRedrawDelay() const
+{
+	// A search over a long log is evaluated a slice per frame
+	return ShouldShow && _logIndex.IsEvaluating() ? 0.0 : RedrawScheduler::NoDeadline;
+}
+
 void ServerLauncherWindow::LoadSettings()
 {
 	// Load Settings
@@ -240,11 +268,14 @@ void ServerLauncherWindow::LoadSettings()
 	size_t itPos = entryView.find_first_of('|');
 	if (itPos == size_t(-1)) return;
 
-	entryView[itPos] = '\0';
-	char* tokenPtr = &entryView[0];
+	// Entries are "Key=Value" tokens (see StoreSettings)
+	constexpr string_view countKey = "ParamsCount=";
+	const string_view countToken = string_view(entryView).substr(0, itPos);
+	if (countToken.compare(0, countKey.size(), countKey) != 0) return;
 
 	int paramsCount = 0;
-	if (sscanf_s(tokenPtr, "ParamsCount=%i", &paramsCount) != 1) return;
+	const char* countEnd = countToken.data() + countToken.size();
+	if (std::from_chars(countToken.data() + countKey.size(), countEnd, paramsCount).ec != std::errc()) return;
 
 	// Load each parameter
 	_launchParams.reserve(paramsCount);
@@ -254,10 +285,10 @@ void ServerLauncherWindow::LoadSettings()
 		itPos = entryView.find_first_of('|', itStart);
 		if (itPos == size_t(-1)) break;
 
-		entryView[itPos] = _paramBuf[0] = '\0';
-		tokenPtr = &entryView[itStart];
-		sscanf_s(tokenPtr, "Param=%s", _paramBuf);
-		_launchParams.push_back(string(_paramBuf));
+		constexpr string_view paramKey = "Param=";
+		const string_view paramToken = string_view(entryView).substr(itStart, itPos - itStart);
+		const bool hasKey = paramToken.compare(0, paramKey.size(), paramKey) == 0;
+		_launchParams.push_back(string(hasKey ? paramToken.substr(paramKey.size()) : string_view()));
 	}
 
 	// Override params buffer
@@ -296,48 +327,35 @@ void ServerLauncherWindow::StoreSettings()
 	}
 }
 
-#if WIN32
 void ServerLauncherWindow::LaunchServerProcess()
 {
 	// Reset Exit flag
 	_exitCode = 0;
 
-	// Setup server pipes
-	// Set the bInheritHandle flag so pipe handles are inherited.
-	SECURITY_ATTRIBUTES saAttr;
-	ZeroMemory(&saAttr, sizeof(saAttr));
-	saAttr.nLength = sizeof(SECURITY_ATTRIBUTES);
-	saAttr.bInheritHandle = true;
-	saAttr.lpSecurityDescriptor = nullptr;
-
-	// Create a pipe for the child process's STDOUT.
-	if (!CreatePipe(&_hChildStdOut_Rd, &_hChildStdOut_Wr, &saAttr, 0))
-	{
-		pfd::message pipeCreationError("Create Pipe Error", "Couldn't create pipe: Stdout", pfd::choice::ok,
-									   pfd::icon::error);
-	}
-
-	// Ensure the read handle to the pipe for STDOUT is not inherited.
-	if (!SetHandleInformation(_hChildStdOut_Rd, HANDLE_FLAG_INHERIT, 0))
-	{
-		pfd::message pipeCreationError("Create Pipe Error", "Couldn't set handle information on Stdout",
-									   pfd::choice::ok, pfd::icon::error);
-	}
-
 	// Build launch command line
 	string cmdLine;
 
 	// Get UE4Editor Path
+#if WIN32
 	size_t ue4PathSize = 0;
 	char* ue4PathArr = nullptr;
 	_dupenv_s(&ue4PathArr, &ue4PathSize, "UE_EDITOR_PATH");
-	cmdLine = ue4PathArr;
+	if (ue4PathArr != nullptr) cmdLine = ue4PathArr;
+	free(ue4PathArr);
+#else
+	const char* ue4Path = std::getenv("UE_EDITOR_PATH");
+	if (ue4Path != nullptr) cmdLine = ue4Path;
+#endif
 
 	// Get current executable directory
-	char appPath[_MAX_PATH + 1];
-	GetModuleFileName(nullptr, appPath, _MAX_PATH);
-	string fileName, fileExt;
-	string directory = rv::splitFilename(string(appPath), fileName, fileExt);
+	char appPath[AppPathSize + 1] = {};
+#if WIN32
+	GetModuleFileName(nullptr, appPath, AppPathSize);
+#else
+	if (readlink("/proc/self/exe", appPath, AppPathSize) < 0) appPath[0] = '\0';
+#endif
+	string fileName;
+	string directory = rv::splitFilename(string(appPath), fileName);
 	cmdLine += " " + directory; // " D:\\Aquiris\\wc2\\";
 
 	// Append UPROJECT
@@ -372,111 +390,18 @@ void ServerLauncherWindow::LaunchServerProcess()
 	// Last insertion of custom parameters line
 	cmdLine += " " + _additionalParamLine;
 
-	_serverProcInfo = new PROCESS_INFORMATION();
-	STARTUPINFO siStartInfo;
-	BOOL bSuccess = FALSE;
-
-	// Set up members of the PROCESS_INFORMATION structure.
-	ZeroMemory(_serverProcInfo, sizeof(PROCESS_INFORMATION));
-
-	// Set up members of the STARTUPINFO structure.
-	// This structure specifies the STDIN and STDOUT handles for redirection.
-	ZeroMemory(&siStartInfo, sizeof(STARTUPINFO));
-	siStartInfo.cb = sizeof(STARTUPINFO);
-	siStartInfo.hStdError = _hChildStdOut_Wr;
-	siStartInfo.hStdOutput = _hChildStdOut_Wr;
-	siStartInfo.dwFlags |= STARTF_USESTDHANDLES;
-
-	// Create the child process.
-	bSuccess = CreateProcessA(nullptr,
-							  (TCHAR*)cmdLine.c_str(), // command line
-							  nullptr,				   // process security attributes
-							  nullptr,				   // primary thread security attributes
-							  TRUE,					   // handles are inherited
-							  0,					   // creation flags
-							  nullptr,				   // use parent's environment
-							  nullptr,				   // use parent's current directory
-							  &siStartInfo,			   // STARTUPINFO pointer
-							  _serverProcInfo);		   // receives PROCESS_INFORMATION
-
-	// If an error occurs, exit the application.
-	if (!bSuccess)
+	// The process reads its output on a thread of its own and wakes the main loop up when there is some
+	string launchError;
+	if (!_server.Start(cmdLine, &launchError))
 	{
-		string errorMsg = fmt::format("Couldn't launch server executable! Path:{0}", launchPath);
-		pfd::message launchErrorDialog("Server Launch Failed", errorMsg, pfd::choice::ok,
-									   pfd::icon::error);
-		delete _serverProcInfo;
-		_serverProcInfo = nullptr;
+		string errorMsg = fmt::format("Couldn't launch server executable! Path:{0}\n{1}", launchPath, launchError);
+		pfd::message launchErrorDialog("Server Launch Failed", errorMsg, pfd::choice::ok, pfd::icon::error);
 		return;
 	}
-
-	// Launch a thread to perform async loading of the data
-	_hAsyncReadServerHandle = CreateThread(0, 0, AsyncReadServerStdout, this, 0, nullptr);
-
-	// Assign process to job object which will auto-terminate the server when the app crashes
-	HANDLE ghJob = CreateJobObject(nullptr, nullptr); // GLOBAL
-	if (ghJob == nullptr)
-	{
-		pfd::message jobCreationErrorDialog("Job Object - Creation Failed",
-											"Beware, if the app crashes the server process will NOT close!",
-											pfd::choice::ok, pfd::icon::error);
-	}
-
-	JOBOBJECT_EXTENDED_LIMIT_INFORMATION jobInfo = {0};
-
-	// Configure all child processes associated with the job to terminate when the
-	jobInfo.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
-	if (!SetInformationJobObject(ghJob, JobObjectExtendedLimitInformation, &jobInfo, sizeof(jobInfo)))
-	{
-		pfd::message jobSetInfoErrorDialog("Job Object - Set Info Failed",
-										   "Beware, if the app crashes the server process will NOT close!",
-										   pfd::choice::ok, pfd::icon::error);
-	}
-
-	if (!AssignProcessToJobObject(ghJob, _serverProcInfo->hProcess))
+	if (!launchError.empty())
 	{
-		pfd::message jobAssignServerErrorDialog("Job Object - Assign Server Failed",
-												"Beware, if the app crashes the server process will NOT close!",
-												pfd::choice::ok, pfd::icon::error);
+		pfd::message jobErrorDialog("Job Object - Creation Failed", launchError, pfd::choice::ok, pfd::icon::error);
 	}
-
-	// Close handles to the stdout pipe no longer needed by the child process.
-	// We have to close the stdout write handle in order to start reading from the other end.
-	CloseHandle(_hChildStdOut_Wr);
-}
-
-DWORD ServerLauncherWindow::ForceCloseServer()
-{
-	if (_serverProcInfo == nullptr) return _exitCode;
-
-	// Terminate server thread
-	TerminateProcess(_serverProcInfo->hProcess, 0);
-	DWORD exitCode = WaitForSingleObject(_serverProcInfo->hProcess, 1000);
-	CloseHandle(_serverProcInfo->hProcess);
-	CloseHandle(_serverProcInfo->hThread);
-
-	// Terminate async read thread
-	TerminateThread(_hAsyncReadServerHandle, 0);
-	WaitForSingleObject(_hAsyncReadServerHandle, 1000);
-	CloseHandle(_hAsyncReadServerHandle);
-
-	// Invalidate process info
-	delete _serverProcInfo;
-	_serverProcInfo = nullptr;
-
-	return exitCode;
-}
-
-static LogVerbosity ParseLogVerbosity(string_view logStrView)
-{
-	if (logStrView.find("Fatal") != -1) return LogVerbosity::Fatal;
-	if (logStrView.find("Error") != -1) return LogVerbosity::Error;
-	if (logStrView.find("Warning") != -1) return LogVerbosity::Warning;
-	if (logStrView.find("Display") != -1) return LogVerbosity::Display;
-	if (logStrView.find("Log") != -1) return LogVerbosity::Log;
-	if (logStrView.find("Verbose") != -1) return LogVerbosity::Verbose;
-	if (logStrView.find("VeryVerbose") != -1) return LogVerbosity::VeryVerbose;
-	return LogVerbosity::Log;
 }
 
 constexpr ImVec4 LogColors[7] = {
@@ -491,80 +416,29 @@ constexpr ImVec4 LogColors[7] = {
 
 void ServerLauncherWindow::PullServerOutputLog()
 {
-	static string output;
-	{
-		std::lock_guard<std::mutex> lock(_threadMutex);
-		if (!_asyncReadQueue.empty())
-		{
-			output.assign(_asyncReadQueue.begin(), _asyncReadQueue.end());
-			_asyncReadQueue.clear();
-		}
-	}
-
-	// Push log entry
-	if (!output.empty())
-	{
-		size_t iniEndLine = 0;
-		size_t endEndLine = output.find_first_of('\n', iniEndLine);
-		while (endEndLine != string::npos)
-		{
-			// Parse log entry
-			size_t msgSize = endEndLine - iniEndLine;
-			string msg = output.substr(iniEndLine, msgSize);
-			string_view msgView = msg;
-
-			// Parse verbosity
-			LogVerbosity verbosity = LogVerbosity::Log;
-			size_t verbIniP = -1;
-
-			// Has time-stamp
-			if (msgView[0] == '[')
-			{
-				// Skip time-stamp
-				verbIniP = msgView.find_first_of(']', verbIniP + 1);
-				// Skip log counter
-				verbIniP = msgView.find_first_of(']', verbIniP + 1);
-			}
-
-			// Skip log category
-			verbIniP = msgView.find_first_of(':', verbIniP + 1) + 1;
-			size_t verbEndP = msgView.find_first_of(':', verbIniP + 1);
-			if (verbIniP != -1 && verbEndP != -1)
-			{
-				string_view verbView = msgView.substr(verbIniP, verbEndP - verbIniP);
-				verbosity = ParseLogVerbosity(verbView);
-			}
-
-			// Create log entry 
-			_serverLogs.push_back({std::forward<string>(msg), verbosity});
-
-			// Continue next-line parsing
-			iniEndLine = endEndLine + 1;
-			if (endEndLine == output.size() - 1) break;
-			endEndLine = output.find_first_of('\n', iniEndLine);
-
-			// No more endLines and we have a piece of log left
-			if (endEndLine == -1)
-			{
-				_ASSERT(false);
-				_partialLogLine = std::forward<string>(output.substr(iniEndLine, output.size() - iniEndLine + 1));
-			}
-		}
-		output.clear();
-	}
-
-	ImGui::BeginChild("Server Output Log", ImVec2(0, 0), false, ImGuiWindowFlags_HorizontalScrollbar);
+	if (_server.PullOutput(_readBatch) > 0) _serverLogs.Append(_readBatch.data(), _readBatch.size());
+	_logIndex.Update(_serverLogs);
+	_logRates.Update(_serverLogs);
+	DrawLogFilter();
+
+	// Only the lines matching the filter are walked, the index keeps their ids
+	const bool filtering = _logIndex.IsFiltering();
+	const float ratesHeight = _plotLogRates ? ImGui::GetFontSize() * 12.0f : 0.0f;
+	const float logHeight = _plotLogRates ? -(ratesHeight + ImGui::GetStyle().ItemSpacing.y) : 0.0f;
+	ImGui::BeginChild("Server Output Log", ImVec2(0, logHeight), false, ImGuiWindowFlags_HorizontalScrollbar);
 	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1)); // Tighten spacing
 	if (_copyToClipboard) ImGui::LogToClipboard();
 	ImGuiListClipper clipper;
-	clipper.Begin(static_cast<int>(_serverLogs.size()));
+	clipper.Begin(static_cast<int>(filtering ? _logIndex.GetMatchCount() : _serverLogs.GetLineCount()));
 	while (clipper.Step())
 	{
 		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 		{
-			const LogEntry& logEntry = _serverLogs[i];
-			ImGui::PushStyleColor(ImGuiCol_Text, LogColors[(int)logEntry.verbosity]);
-			ImGui::TextUnformatted(logEntry.message.c_str());
+			// Drawn straight out of the arena, lines aren't null terminated
+			const LogLine& logLine = _serverLogs.GetLine(filtering ? _logIndex.GetMatch(i) : i);
+			const string_view text = _serverLogs.GetText(logLine);
+			ImGui::PushStyleColor(ImGuiCol_Text, LogColors[(int)logLine.Verbosity]);
+			ImGui::TextUnformatted(text.data(), text.data() + text.size());
 			ImGui::PopStyleColor();
 
 			// Auto-scroll
@@ -578,68 +452,172 @@ void ServerLauncherWindow::PullServerOutputLog()
 	ImGui::PopStyleVar();
 	ImGui::EndChild();
 	_copyToClipboard = false;
+
+	if (_plotLogRates) DrawLogRates(ratesHeight);
 }
 
-void ServerLauncherWindow::PullServerProcessStatus()
+void ServerLauncherWindow::DrawLogRates(float height)
 {
-	if (_serverProcInfo != nullptr)
+	if (_logRates.IsEmpty())
 	{
-		if (!GetExitCodeProcess(_serverProcInfo->hProcess, &_exitCode))
-		{
-			ImGui::TextUnformatted("Server Status: Invalid Handle");
-		}
+		ImGui::Dummy(ImVec2(0.0f, height));
+		return;
 	}
 
-	if (_exitCode == STILL_ACTIVE)
+	// Volume goes on the left axis, warnings and errors on the right one, a few warnings a second would be flat next to
+	// thousands of traffic lines otherwise
+	const ImPlotFlags plotFlags = ImPlotFlags_NoTitle | ImPlotFlags_NoMenus | ImPlotFlags_NoBoxSelect;
+	if (!ImPlot::BeginPlot("##_logRatesPlot", ImVec2(-1.0f, height), plotFlags)) return;
+	ImPlot::SetupAxes(nullptr, "lines/s", 0, ImPlotAxisFlags_AutoFit);
+	ImPlot::SetupAxis(ImAxis_Y2, "warnings/s", ImPlotAxisFlags_AuxDefault | ImPlotAxisFlags_AutoFit);
+	ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Time);
+	ImPlot::SetupLegend(ImPlotLocation_NorthWest, ImPlotLegendFlags_Horizontal);
+
+	// The view follows the newest second while its right edge is there, and stays where the user put it otherwise
+	constexpr double FollowSeconds = 300.0;
+	const double endTime = _logRates.GetEndTime();
+	const ImPlotCond followCondition =
+		_logRatesFollow && endTime != _logRatesEndTime ? ImPlotCond_Always : ImPlotCond_Once;
+	const double firstTime = _logRates.GetFirstTime();
+	const double startTime = firstTime > endTime - FollowSeconds ? firstTime : endTime - FollowSeconds;
+	ImPlot::SetupAxisLimits(ImAxis_X1, startTime, endTime, followCondition);
+
+	// Series plot straight out of the ring
+	const double ringStartTime = _logRates.GetRingStartTime();
+	const int ringOffset = _logRates.GetRingOffset();
+	const auto plotSeries = [&](const char* label, int series)
 	{
-		ImGui::TextUnformatted("Server Status: Running");
-	}
-	else if (_exitCode != 0)
+		ImPlot::PlotLine(label, _logRates.GetCounts(series), static_cast<int>(ServerLogRates::BucketCount),
+			ServerLogRates::BucketSeconds, ringStartTime, 0, ringOffset);
+	};
+	plotSeries("All Lines", ServerLogRates::AllLinesSeries);
+	_logRates.FindBusiestCategories(4, _busiestLogRates);
+	for (const LogRateSeries& rate : _busiestLogRates)
 	{
-		ImGui::Text("Server Status: Crashed (ExitCode=%lu)", _exitCode);
-		ForceCloseServer();
+		const string_view category = rate.Category == 0 ? "(None)" : _serverLogs.GetCategoryName(rate.Category);
+		const string label = fmt::format("{0}##rate{1}", category, rate.Series);
+		plotSeries(label.c_str(), rate.Series);
 	}
-	else
+
+	ImPlot::SetAxes(ImAxis_X1, ImAxis_Y2);
+	plotSeries("Errors", ServerLogRates::GetVerbositySeries(LogVerbosity::Error));
+	plotSeries("Warnings", ServerLogRates::GetVerbositySeries(LogVerbosity::Warning));
+	_logRates.FindBusiestWarnings(4, _busiestLogRates);
+	for (const LogRateSeries& rate : _busiestLogRates)
 	{
-		ImGui::Text("Server Status: Not Running");
+		const string_view category = rate.Category == 0 ? "(None)" : _serverLogs.GetCategoryName(rate.Category);
+		const string label = fmt::format("{0} {1}##rate{2}", category, LogVerbosityNames[int(rate.Verbosity)],
+			rate.Series);
+		plotSeries(label.c_str(), rate.Series);
 	}
-}
-
-std::mutex ServerLauncherWindow::_threadMutex;
 
-void ServerLauncherWindow::CloseServerOnCrashCallback(void* pVoid)
-{
-	auto* window = static_cast<ServerLauncherWindow*>(pVoid);
-	window->ForceCloseServer();
+	_logRatesFollow = ImPlot::GetPlotLimits().X.Max >= endTime - ServerLogRates::BucketSeconds;
+	_logRatesEndTime = endTime;
+	ImPlot::EndPlot();
 }
 
-DWORD ServerLauncherWindow::AsyncReadServerStdout(void* pVoid)
+void ServerLauncherWindow::DrawLogFilter()
 {
-	auto* window = static_cast<ServerLauncherWindow*>(pVoid);
+	bool filterChanged = false;
+	ImGui::SetNextItemWidth(ImGui::GetFontSize() * 16.0f);
+	if (ImGui::InputTextWithHint("##logSearch", "Search", _logSearchBuf, sizeof(_logSearchBuf)))
+	{
+		_logFilter.Search = _logSearchBuf;
+		filterChanged = true;
+	}
 
-	constexpr size_t BUFSIZE = 4096;
-	DWORD dwRead, dwWritten;
-	char chBuf[BUFSIZE];
-	bool bSuccess = false;
+	ImGui::SameLine();
+	constexpr uint8_t WarningsOnly = 1 << int(LogVerbosity::Warning);
+	bool warningsOnly = _logFilter.Verbosities == WarningsOnly;
+	if (ImGui::Checkbox("Warnings only", &warningsOnly))
+	{
+		_logFilter.Verbosities = warningsOnly ? WarningsOnly : 0x7F;
+		filterChanged = true;
+	}
 
-	// HANDLE hParentStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10.0f);
+	if (ImGui::BeginCombo("##logVerbosities", "Verbosities"))
+	{
+		for (int verbosity = 0; verbosity < int(std::size(LogVerbosityNames)); ++verbosity)
+		{
+			bool shown = _logFilter.ShowsVerbosity(LogVerbosity(verbosity));
+			const string label = fmt::format("{0} ({1})", LogVerbosityNames[verbosity],
+				_logIndex.GetVerbosityLineCount(LogVerbosity(verbosity)));
+			if (ImGui::Checkbox(label.c_str(), &shown))
+			{
+				_logFilter.Verbosities ^= 1 << verbosity;
+				filterChanged = true;
+			}
+		}
+		ImGui::EndCombo();
+	}
 
-	for (;;)
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10.0f);
+	if (ImGui::BeginCombo("##logCategories", "Categories", ImGuiComboFlags_HeightLarge))
 	{
-		bSuccess = ReadFile(window->_hChildStdOut_Rd, chBuf, BUFSIZE, &dwRead, NULL);
-		if (!bSuccess || dwRead == 0) continue;
+		vector<uint8_t>& hidden = _logFilter.HiddenCategories;
+		const size_t categoryCount = _serverLogs.GetCategoryCount();
+		if (ImGui::Button("Show All"))
+		{
+			hidden.clear();
+			filterChanged = true;
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Hide All"))
+		{
+			hidden.assign(categoryCount, 1);
+			filterChanged = true;
+		}
+		for (size_t category = 0; category < categoryCount; ++category)
+		{
+			bool shown = _logFilter.ShowsCategory(static_cast<uint16_t>(category));
+			const string_view name = category == 0 ? "(None)" : _serverLogs.GetCategoryName(uint16_t(category));
+			const string label = fmt::format("{0} ({1})##{2}", name,
+				_logIndex.GetCategoryLineCount(static_cast<uint16_t>(category)), category);
+			if (ImGui::Checkbox(label.c_str(), &shown))
+			{
+				if (hidden.size() <= category) hidden.resize(category + 1, 0);
+				hidden[category] = shown ? 0 : 1;
+				filterChanged = true;
+			}
+		}
+		ImGui::EndCombo();
+	}
 
-		// Thread-lock block copy buffer
+	if (filterChanged) _logIndex.SetFilter(_serverLogs, _logFilter);
+	if (_logIndex.IsFiltering())
+	{
+		ImGui::SameLine();
+		ImGui::Text("%zu of %zu lines", _logIndex.GetMatchCount(), _serverLogs.GetLineCount());
+		if (_logIndex.IsEvaluating())
 		{
-			std::lock_guard<std::mutex> lock(_threadMutex);
-			window->_asyncReadQueue.insert(window->_asyncReadQueue.end(), &chBuf[0], &chBuf[dwRead]);
+			ImGui::SameLine();
+			ImGui::TextDisabled("(searching %.0f%%)", _logIndex.GetEvaluatedRatio() * 100.0f);
 		}
+	}
+}
 
-		// TODO: Remove this write
-		// bSuccess = WriteFile(hParentStdOut, chBuf, dwRead, &dwWritten, NULL);
-		if (!bSuccess) break;
+void ServerLauncherWindow::PullServerProcessStatus()
+{
+	// The reader wakes the main loop up once the server exited, its last output was read by then
+	if (_server.IsStarted() && _server.HasExited())
+	{
+		_exitCode = _server.GetExitCode();
+		_server.Stop();
 	}
 
-	return 0;
+	if (_server.IsStarted())
+	{
+		ImGui::TextUnformatted("Server Status: Running");
+	}
+	else if (_exitCode != 0)
+	{
+		ImGui::Text("Server Status: Crashed (ExitCode=%u)", _exitCode);
+	}
+	else
+	{
+		ImGui::Text("Server Status: Not Running");
+	}
 }
-#endif
@@ -0,0 +1,819 @@
+#include <app/serverLogIndex.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SERVER_LOG_INDEX_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define SERVER_LOG_INDEX_USE_SSE2 0
+#endif
+
+#if _MSC_VER
+	#include <intrin.h>
+#endif
+
+// Lines scanned between two reads of the clock, when no index narrows them down
+static constexpr size_t ScanBlockLines = 4096;
+// Lines ahead of the one being verified whose text is fetched already
+static constexpr size_t PrefetchDistance = 8;
+
+static constexpr char FoldCase(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+// Bytes of words folded to lower case, 0 for the separators between words. Bytes past 0x7F are word bytes, so UTF-8
+// text stays in one word.
+struct WordByteTable
+{
+	char Folded[256] = {};
+
+	constexpr WordByteTable()
+	{
+		for (int byte = 1; byte < 256; ++byte)
+		{
+			const char c = static_cast<char>(byte);
+			const bool isWordByte = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+									c == '_' || byte >= 0x80;
+			Folded[byte] = isWordByte ? FoldCase(c) : 0;
+		}
+	}
+};
+static constexpr WordByteTable WordBytes;
+
+static bool IsWordByte(char c) { return WordBytes.Folded[static_cast<uint8_t>(c)] != 0; }
+
+// FNV-1a, words are short
+static constexpr uint32_t WordHashSeed = 2166136261u;
+static uint32_t HashWordByte(uint32_t hash, char c) { return (hash ^ static_cast<uint8_t>(c)) * 16777619u; }
+
+static void AppendVarint(vector<uint8_t>& bytes, uint32_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+static uint32_t ReadVarint(const uint8_t* bytes, uint32_t& offset)
+{
+	uint32_t value = 0;
+	for (int shift = 0;; shift += 7)
+	{
+		const uint8_t byte = bytes[offset++];
+		value |= uint32_t(byte & 0x7F) << shift;
+		if (byte < 0x80) return value;
+	}
+}
+
+static int FindFirstBit(uint64_t value)
+{
+#if _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+static int CountBits(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	// Only a popcnt instruction when the target has one (-mpopcnt), a library call otherwise
+	return __builtin_popcountll(value);
+#else
+	// MSVC's __popcnt64 is the instruction itself, which CPUs before SSE4.2 don't have
+	value -= (value >> 1) & 0x5555555555555555ull;
+	value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+	value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+	return static_cast<int>((value * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+static void PrefetchText(string_view text)
+{
+#if SERVER_LOG_INDEX_USE_SSE2
+	_mm_prefetch(text.data(), _MM_HINT_T0);
+	_mm_prefetch(text.data() + 64, _MM_HINT_T0);
+#else
+	(void)text;
+#endif
+}
+
+#if SERVER_LOG_INDEX_USE_SSE2
+static __m128i FoldCase16(__m128i bytes)
+{
+	// Signed compares, bytes past 0x7F aren't letters either
+	const __m128i upper = _mm_and_si128(
+		_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1)));
+	return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+}
+#endif
+
+static bool EqualsFolded(const char* text, const char* search, size_t size)
+{
+	for (size_t byteIt = 0; byteIt < size; ++byteIt)
+	{
+		if (FoldCase(text[byteIt]) != search[byteIt]) return false;
+	}
+	return true;
+}
+
+// Whether text holds the search, which is folded to lower case already
+static bool ContainsFolded(string_view text, const string& search)
+{
+	const size_t size = search.size();
+	if (size == 0) return true;
+	if (size > text.size()) return false;
+	const size_t lastStart = text.size() - size;
+	size_t start = 0;
+
+#if SERVER_LOG_INDEX_USE_SSE2
+	// Only the starts where both the first and the last byte match are compared in full, 16 starts at a time
+	const __m128i first = _mm_set1_epi8(search[0]);
+	const __m128i last = _mm_set1_epi8(search[size - 1]);
+	for (; start + 16 <= lastStart + 1; start += 16)
+	{
+		const __m128i firstBytes = FoldCase16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + start)));
+		const __m128i lastBytes =
+			FoldCase16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + start + size - 1)));
+		uint32_t starts = static_cast<uint32_t>(
+			_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(firstBytes, first), _mm_cmpeq_epi8(lastBytes, last))));
+		while (starts != 0)
+		{
+			const size_t matchStart = start + FindFirstBit(starts);
+			if (size <= 2 || EqualsFolded(text.data() + matchStart + 1, search.data() + 1, size - 2)) return true;
+			starts &= starts - 1;
+		}
+	}
+#endif
+
+	for (; start <= lastStart; ++start)
+	{
+		if (FoldCase(text[start]) == search[0] && EqualsFolded(text.data() + start + 1, search.data() + 1, size - 1))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Merges sorted posting lists, pairwise so every id is copied about log2(lists) times
+static void MergePostingLists(const vector<const vector<uint32_t>*>& lists, vector<uint32_t>& merged)
+{
+	merged.clear();
+	if (lists.empty()) return;
+
+	vector<vector<uint32_t>> pending;
+	pending.reserve(lists.size());
+	for (const vector<uint32_t>* list : lists)
+	{
+		pending.push_back(*list);
+	}
+	while (pending.size() > 1)
+	{
+		for (size_t listIt = 0; listIt + 1 < pending.size(); listIt += 2)
+		{
+			vector<uint32_t>& first = pending[listIt];
+			vector<uint32_t>& second = pending[listIt + 1];
+			merged.resize(first.size() + second.size());
+			std::merge(first.begin(), first.end(), second.begin(), second.end(), merged.begin());
+			first.swap(merged);
+			second.clear();
+		}
+		pending.erase(std::remove_if(pending.begin() + 1, pending.end(),
+						  [](const vector<uint32_t>& list) { return list.empty(); }),
+			pending.end());
+	}
+	merged.swap(pending[0]);
+}
+
+// Copies of every id are made once per level of the pairwise merge
+static size_t GetMergeCost(size_t idCount, size_t listCount)
+{
+	size_t levels = 1;
+	while ((size_t(1) << levels) < listCount) levels++;
+	return idCount * levels;
+}
+
+ServerLogIndex::ServerLogIndex()
+{
+	_wordThread = std::thread([this]() { IndexWords(); });
+}
+
+ServerLogIndex::~ServerLogIndex()
+{
+	{
+		std::lock_guard<std::mutex> lock(_wordLock);
+		_stopWords = true;
+	}
+	_wordWake.notify_one();
+	_wordThread.join();
+}
+
+void ServerLogIndex::Update(const ServerLogStore& store)
+{
+	const size_t lineCount = store.GetLineCount();
+	_newLines.clear();
+	for (size_t lineIndex = _indexedCount; lineIndex < lineCount; ++lineIndex)
+	{
+		const LogLine& line = store.GetLine(lineIndex);
+		const uint32_t lineId = static_cast<uint32_t>(lineIndex);
+		_verbosityLines[int(line.Verbosity)].push_back(lineId);
+		if (line.Category >= _categoryLines.size()) _categoryLines.resize(line.Category + 1);
+		_categoryLines[line.Category].push_back(lineId);
+		_lineVerbosities.push_back(static_cast<uint8_t>(line.Verbosity));
+		_lineCategories.push_back(line.Category);
+
+		const string_view text = store.GetText(line);
+		_newLines.push_back({text.data(), text.size()});
+	}
+	_indexedCount = lineCount;
+
+	if (!_newLines.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(_wordLock);
+			_pendingLines.insert(_pendingLines.end(), _newLines.begin(), _newLines.end());
+		}
+		_wordWake.notify_one();
+	}
+
+	if (!_filtering) return;
+	// A posting list grows along with the index
+	if (_matchList != &_matches)
+	{
+		_evaluatedCount = _indexedCount;
+		return;
+	}
+	ContinueEvaluation(store);
+}
+
+void ServerLogIndex::Clear()
+{
+	{
+		std::lock_guard<std::mutex> lock(_wordLock);
+		_pendingLines.clear();
+		_pendingStart = 0;
+		_wordIndexedCount = 0;
+		_wordText = "\n";
+		_wordStarts.clear();
+		_wordHashes.clear();
+		_wordSlots.clear();
+		_wordPostings.clear();
+	}
+
+	for (vector<uint32_t>& lines : _verbosityLines)
+	{
+		lines.clear();
+	}
+	_categoryLines.clear();
+	_lineVerbosities.clear();
+	_lineCategories.clear();
+	_indexedCount = 0;
+
+	_filter.HiddenCategories.clear();
+	_filtering = !_search.empty() || _filter.Verbosities != 0x7F;
+	_matches.clear();
+	_evaluatedCount = 0;
+
+	// The parts of the search stay, their words are found again as the new lines are indexed
+	for (SearchRun& run : _searchRuns)
+	{
+		run.CursorEnd = 0;
+	}
+	_searchCursors.clear();
+	_searchIndexedCount = 0;
+	_searchWordCount = 0;
+	_headerMatches.clear();
+}
+
+void ServerLogIndex::WaitForWords()
+{
+	std::unique_lock<std::mutex> lock(_wordLock);
+	_wordsIndexed.wait(lock, [this]() { return _pendingStart == _pendingLines.size(); });
+}
+
+void ServerLogIndex::SetFilter(const ServerLogStore& store, const LogFilter& filter)
+{
+	_filter = filter;
+	_search.resize(filter.Search.size());
+	std::transform(filter.Search.begin(), filter.Search.end(), _search.begin(), FoldCase);
+	Evaluate(store);
+}
+
+size_t ServerLogIndex::GetMemoryBytes() const
+{
+	size_t memoryBytes = _matches.capacity() * sizeof(uint32_t) + _lineVerbosities.capacity() * sizeof(uint8_t) +
+						 _lineCategories.capacity() * sizeof(uint16_t);
+	for (const vector<uint32_t>& lines : _verbosityLines)
+	{
+		memoryBytes += lines.capacity() * sizeof(uint32_t);
+	}
+	for (const vector<uint32_t>& lines : _categoryLines)
+	{
+		memoryBytes += lines.capacity() * sizeof(uint32_t);
+	}
+
+	std::lock_guard<std::mutex> lock(_wordLock);
+	memoryBytes += _pendingLines.capacity() * sizeof(PendingLine) + _wordText.capacity() +
+				   (_wordStarts.capacity() + _wordHashes.capacity() + _wordSlots.capacity()) * sizeof(uint32_t) +
+				   _wordPostings.capacity() * sizeof(WordPostings);
+	for (const WordPostings& postings : _wordPostings)
+	{
+		memoryBytes += postings.Deltas.capacity();
+	}
+	return memoryBytes;
+}
+
+void ServerLogIndex::IndexWords()
+{
+	std::unique_lock<std::mutex> lock(_wordLock);
+	for (;;)
+	{
+		_wordWake.wait(lock, [this]() { return _stopWords || _pendingStart < _pendingLines.size(); });
+		if (_stopWords) return;
+
+		const size_t batchEnd = std::min(_pendingStart + WordBatchSize, _pendingLines.size());
+		for (; _pendingStart < batchEnd; ++_pendingStart)
+		{
+			AddLineWords(_pendingLines[_pendingStart], static_cast<uint32_t>(_wordIndexedCount++));
+		}
+		if (_pendingStart == _pendingLines.size())
+		{
+			_pendingLines.clear();
+			_pendingStart = 0;
+			_wordsIndexed.notify_all();
+		}
+		else if (_pendingStart >= 16 * WordBatchSize && _pendingStart * 2 >= _pendingLines.size())
+		{
+			// Lines keep coming while it's behind, the indexed ones are dropped once they are half of the queue
+			_pendingLines.erase(_pendingLines.begin(), _pendingLines.begin() + _pendingStart);
+			_pendingStart = 0;
+		}
+
+		// Update and the searches get their turn between batches
+		lock.unlock();
+		std::this_thread::yield();
+		lock.lock();
+	}
+}
+
+void ServerLogIndex::AddLineWords(const PendingLine& line, uint32_t lineId)
+{
+	const char* text = line.Text;
+	size_t byteIt = 0;
+	while (byteIt < line.Size)
+	{
+		char folded = WordBytes.Folded[static_cast<uint8_t>(text[byteIt++])];
+		if (folded == 0) continue;
+
+		_foldedWord.clear();
+		uint32_t hash = WordHashSeed;
+		do
+		{
+			_foldedWord.push_back(folded);
+			hash = HashWordByte(hash, folded);
+		} while (byteIt < line.Size && (folded = WordBytes.Folded[static_cast<uint8_t>(text[byteIt++])]) != 0);
+
+		// A line is listed once per word, however many times it holds it
+		WordPostings& postings = _wordPostings[InternWord(_foldedWord.data(), _foldedWord.size(), hash)];
+		if (postings.NextLine == lineId + 1) continue;
+		AppendVarint(postings.Deltas, lineId - postings.NextLine);
+		postings.NextLine = lineId + 1;
+		postings.LineCount++;
+	}
+}
+
+uint32_t ServerLogIndex::InternWord(const char* word, size_t size, uint32_t hash)
+{
+	if ((_wordStarts.size() + 1) * 2 > _wordSlots.size()) GrowWordSlots();
+	const size_t slot = FindWordSlot(word, size, hash);
+	if (_wordSlots[slot] != 0) return _wordSlots[slot] - 1;
+
+	const uint32_t wordId = static_cast<uint32_t>(_wordStarts.size());
+	_wordStarts.push_back(static_cast<uint32_t>(_wordText.size()));
+	_wordText.append(word, size);
+	_wordText.push_back('\n');
+	_wordHashes.push_back(hash);
+	_wordPostings.emplace_back();
+	_wordSlots[slot] = wordId + 1;
+	return wordId;
+}
+
+size_t ServerLogIndex::FindWordSlot(const char* word, size_t size, uint32_t hash) const
+{
+	const size_t slotMask = _wordSlots.size() - 1;
+	for (size_t slot = hash & slotMask;; slot = (slot + 1) & slotMask)
+	{
+		const uint32_t slotWord = _wordSlots[slot];
+		if (slotWord == 0) return slot;
+		const uint32_t wordId = slotWord - 1;
+		const size_t start = _wordStarts[wordId];
+		if (_wordHashes[wordId] == hash && GetWordEnd(wordId) - start == size &&
+			memcmp(_wordText.data() + start, word, size) == 0)
+		{
+			return slot;
+		}
+	}
+}
+
+size_t ServerLogIndex::GetWordEnd(uint32_t word) const
+{
+	return word + 1 < _wordStarts.size() ? _wordStarts[word + 1] - 1 : _wordText.size() - 1;
+}
+
+void ServerLogIndex::GrowWordSlots()
+{
+	_wordSlots.assign(std::max(_wordSlots.size() * 2, size_t(1024)), 0);
+	const size_t slotMask = _wordSlots.size() - 1;
+	for (uint32_t wordId = 0; wordId < _wordHashes.size(); ++wordId)
+	{
+		size_t slot = _wordHashes[wordId] & slotMask;
+		while (_wordSlots[slot] != 0) slot = (slot + 1) & slotMask;
+		_wordSlots[slot] = wordId + 1;
+	}
+}
+
+void ServerLogIndex::FindRunWords(const SearchRun& run, uint32_t firstWord, vector<uint32_t>& words) const
+{
+	words.clear();
+	if (firstWord >= _wordStarts.size()) return;
+	const string_view text(_search.data() + run.Start, run.Size);
+
+	// A part between two separators is a whole word
+	if (run.AfterSeparator && run.BeforeSeparator)
+	{
+		uint32_t hash = WordHashSeed;
+		for (char c : text)
+		{
+			hash = HashWordByte(hash, c);
+		}
+		const uint32_t slotWord = _wordSlots[FindWordSlot(text.data(), text.size(), hash)];
+		if (slotWord != 0 && slotWord - 1 >= firstWord) words.push_back(slotWord - 1);
+		return;
+	}
+
+	// Words are separated by line breaks, a part found in the text of the words is in a single one
+	const string_view wordText = _wordText;
+	size_t position = wordText.find(text, _wordStarts[firstWord]);
+	while (position != string_view::npos)
+	{
+		const uint32_t word = static_cast<uint32_t>(
+			std::upper_bound(_wordStarts.begin(), _wordStarts.end(), uint32_t(position)) - _wordStarts.begin() - 1);
+		const size_t wordEnd = GetWordEnd(word);
+		const bool startsWord = !run.AfterSeparator || position == _wordStarts[word];
+		const bool endsWord = !run.BeforeSeparator || position + text.size() == wordEnd;
+		if (startsWord && endsWord) words.push_back(word);
+		// Only the start of a word can start it, a later position may still end it
+		position = wordText.find(text, startsWord && !endsWord ? position + 1 : wordEnd);
+	}
+}
+
+void ServerLogIndex::AddRunCursors(size_t run, const vector<uint32_t>& words)
+{
+	vector<WordCursor> cursors;
+	cursors.reserve(words.size());
+	for (uint32_t word : words)
+	{
+		cursors.push_back({word, 0, 0});
+	}
+	_searchCursors.insert(_searchCursors.begin() + _searchRuns[run].CursorEnd, cursors.begin(), cursors.end());
+	for (size_t runIt = run; runIt < _searchRuns.size(); ++runIt)
+	{
+		_searchRuns[runIt].CursorEnd += cursors.size();
+	}
+}
+
+void ServerLogIndex::Evaluate(const ServerLogStore& store)
+{
+	_matches.clear();
+	_matchList = &_matches;
+	_evaluatedCount = 0;
+	const vector<uint8_t>& hidden = _filter.HiddenCategories;
+	const bool hidesCategories = std::find(hidden.begin(), hidden.end(), 1) != hidden.end();
+	_filtering = !_search.empty() || _filter.Verbosities != 0x7F || hidesCategories;
+	_searchRuns.clear();
+	_searchCursors.clear();
+	_searchIndexedCount = 0;
+	_searchWordCount = 0;
+	if (!_filtering) return;
+
+	if (!_search.empty())
+	{
+		EvaluateSearch(store);
+		ContinueEvaluation(store);
+		return;
+	}
+
+	// A single verbosity is drawn from its posting list as it is
+	int shownVerbosity = -1;
+	int shownVerbosityCount = 0;
+	for (int verbosity = 0; verbosity < VerbosityCount; ++verbosity)
+	{
+		if (!_filter.ShowsVerbosity(LogVerbosity(verbosity))) continue;
+		shownVerbosity = verbosity;
+		shownVerbosityCount++;
+	}
+	if (shownVerbosityCount == 1 && !hidesCategories)
+	{
+		_matchList = &_verbosityLines[shownVerbosity];
+		_evaluatedCount = _indexedCount;
+		return;
+	}
+
+	// Merging the lists of the shown verbosities or categories beats scanning the columns when they hold a small part
+	// of the log, the lines arriving afterwards are matched as they come either way
+	vector<const vector<uint32_t>*> verbosityLists, categoryLists;
+	size_t verbosityLineCount = 0, categoryLineCount = 0;
+	for (int verbosity = 0; verbosity < VerbosityCount; ++verbosity)
+	{
+		if (!_filter.ShowsVerbosity(LogVerbosity(verbosity)) || _verbosityLines[verbosity].empty()) continue;
+		verbosityLists.push_back(&_verbosityLines[verbosity]);
+		verbosityLineCount += _verbosityLines[verbosity].size();
+	}
+	for (size_t category = 0; category < _categoryLines.size(); ++category)
+	{
+		if (!_filter.ShowsCategory(static_cast<uint16_t>(category)) || _categoryLines[category].empty()) continue;
+		categoryLists.push_back(&_categoryLines[category]);
+		categoryLineCount += _categoryLines[category].size();
+	}
+
+	const size_t verbosityCost = GetMergeCost(verbosityLineCount, verbosityLists.size());
+	const size_t categoryCost = GetMergeCost(categoryLineCount, categoryLists.size());
+	if (std::min(verbosityCost, categoryCost) * 4 < _indexedCount)
+	{
+		MergePostingLists(verbosityCost <= categoryCost ? verbosityLists : categoryLists, _matches);
+		_matches.erase(std::remove_if(_matches.begin(), _matches.end(),
+						   [this](uint32_t lineIndex)
+						   {
+							   return !_filter.ShowsVerbosity(LogVerbosity(_lineVerbosities[lineIndex])) ||
+									  !_filter.ShowsCategory(_lineCategories[lineIndex]);
+						   }),
+			_matches.end());
+		_evaluatedCount = _indexedCount;
+		return;
+	}
+	// Most lines are shown, the matches are never moved while the columns are scanned
+	_matches.reserve(_indexedCount);
+	ContinueEvaluation(store);
+}
+
+void ServerLogIndex::EvaluateSearch(const ServerLogStore& store)
+{
+	_searchIsWord = std::all_of(_search.begin(), _search.end(), IsWordByte);
+	_headerMatches.clear();
+	MatchSearchHeaders(store, 0);
+
+	for (size_t start = 0; start < _search.size();)
+	{
+		if (!IsWordByte(_search[start]))
+		{
+			start++;
+			continue;
+		}
+		size_t end = start + 1;
+		while (end < _search.size() && IsWordByte(_search[end])) end++;
+		_searchRuns.push_back(
+			{static_cast<uint32_t>(start), static_cast<uint32_t>(end - start), start > 0, end < _search.size(), 0});
+		start = end;
+	}
+	// Separators alone are searched by the text of every line
+	if (_searchRuns.empty()) return;
+
+	std::lock_guard<std::mutex> lock(_wordLock);
+	_searchIndexedCount = _wordIndexedCount;
+	_searchWordCount = _wordStarts.size();
+
+	// Every line of the search holds all of its parts, the rarest ones are enough to narrow the lines down
+	vector<vector<uint32_t>> runWords(_searchRuns.size());
+	vector<std::pair<size_t, size_t>> runLineCounts;
+	for (size_t run = 0; run < _searchRuns.size(); ++run)
+	{
+		FindRunWords(_searchRuns[run], 0, runWords[run]);
+		size_t lineCount = 0;
+		for (uint32_t word : runWords[run])
+		{
+			lineCount += _wordPostings[word].LineCount;
+		}
+		runLineCounts.push_back({lineCount, run});
+	}
+	std::sort(runLineCounts.begin(), runLineCounts.end());
+	const size_t maxLineCount = std::max(runLineCounts[0].first * 8, RangeSize);
+
+	vector<SearchRun> runs;
+	for (const std::pair<size_t, size_t>& runLineCount : runLineCounts)
+	{
+		if (!runs.empty() && runLineCount.first > maxLineCount) break;
+		runs.push_back(_searchRuns[runLineCount.second]);
+	}
+	_searchRuns.swap(runs);
+	for (size_t run = 0; run < _searchRuns.size(); ++run)
+	{
+		AddRunCursors(run, runWords[runLineCounts[run].second]);
+	}
+}
+
+void ServerLogIndex::ExtendSearch()
+{
+	std::lock_guard<std::mutex> lock(_wordLock);
+	if (_wordIndexedCount <= _evaluatedCount) return;
+
+	// Words new to the index have no line before the lines it covered last time
+	vector<uint32_t> words;
+	for (size_t run = 0; run < _searchRuns.size(); ++run)
+	{
+		FindRunWords(_searchRuns[run], static_cast<uint32_t>(_searchWordCount), words);
+		AddRunCursors(run, words);
+	}
+	_searchIndexedCount = _wordIndexedCount;
+	_searchWordCount = _wordStarts.size();
+}
+
+void ServerLogIndex::ContinueEvaluation(const ServerLogStore& store)
+{
+	const auto deadline = std::chrono::steady_clock::now() + EvaluationBudget;
+	const bool searching = !_search.empty();
+
+	// Shown categories are looked up without bound checks, verbosities are a bit each
+	_shownCategories.resize(store.GetCategoryCount());
+	for (size_t category = 0; category < _shownCategories.size(); ++category)
+	{
+		_shownCategories[category] = _filter.ShowsCategory(static_cast<uint16_t>(category)) ? 1 : 0;
+	}
+	const uint32_t shownVerbosities = _filter.Verbosities;
+	if (searching)
+	{
+		MatchSearchHeaders(store, _headerMatches.size() / (VerbosityCount + 1));
+		if (!_searchRuns.empty() && _evaluatedCount >= _searchIndexedCount) ExtendSearch();
+	}
+
+	while (_evaluatedCount < _indexedCount)
+	{
+		if (_evaluatedCount < _searchIndexedCount)
+		{
+			const size_t rangeEnd = std::min((_evaluatedCount | (RangeSize - 1)) + 1, _searchIndexedCount);
+			EvaluateSearchRange(store, _evaluatedCount, rangeEnd);
+			_evaluatedCount = rangeEnd;
+		}
+		else if (!searching)
+		{
+			// Every line is written, the count only moves past the shown ones
+			const size_t blockEnd = std::min(_evaluatedCount + ScanBlockLines, _indexedCount);
+			const size_t matchCount = _matches.size();
+			_matches.resize(matchCount + blockEnd - _evaluatedCount);
+			uint32_t* matches = _matches.data() + matchCount;
+			size_t blockMatchCount = 0;
+			for (size_t lineIndex = _evaluatedCount; lineIndex < blockEnd; ++lineIndex)
+			{
+				matches[blockMatchCount] = static_cast<uint32_t>(lineIndex);
+				blockMatchCount += _shownCategories[_lineCategories[lineIndex]] &
+								   (shownVerbosities >> _lineVerbosities[lineIndex]);
+			}
+			_matches.resize(matchCount + blockMatchCount);
+			_evaluatedCount = blockEnd;
+		}
+		else
+		{
+			// The lines the word thread didn't reach yet
+			const size_t blockEnd = std::min(_evaluatedCount + ScanBlockLines, _indexedCount);
+			for (size_t lineIndex = _evaluatedCount; lineIndex < blockEnd; ++lineIndex)
+			{
+				const uint8_t verbosity = _lineVerbosities[lineIndex];
+				const uint16_t category = _lineCategories[lineIndex];
+				if (((shownVerbosities >> verbosity) & 1) == 0 || _shownCategories[category] == 0) continue;
+				if (!_headerMatches[category * (VerbosityCount + 1) + verbosity] &&
+					!ContainsFolded(store.GetText(lineIndex), _search))
+				{
+					continue;
+				}
+				_matches.push_back(static_cast<uint32_t>(lineIndex));
+			}
+			_evaluatedCount = blockEnd;
+		}
+
+		if (std::chrono::steady_clock::now() >= deadline) break;
+	}
+}
+
+void ServerLogIndex::EvaluateSearchRange(const ServerLogStore& store, size_t rangeStart, size_t rangeEnd)
+{
+	// The lines holding every part of the search
+	const size_t bitWordCount = (rangeEnd - rangeStart + 63) / 64;
+	_rangeLines.assign(bitWordCount, 0);
+	{
+		std::lock_guard<std::mutex> lock(_wordLock);
+		GatherRunLines(0, rangeStart, rangeEnd, _rangeLines.data());
+		// Every cursor moves past the range, even once no line is left
+		for (size_t run = 1; run < _searchRuns.size(); ++run)
+		{
+			_runLines.assign(bitWordCount, 0);
+			GatherRunLines(run, rangeStart, rangeEnd, _runLines.data());
+			for (size_t bitWordIt = 0; bitWordIt < bitWordCount; ++bitWordIt)
+			{
+				_rangeLines[bitWordIt] &= _runLines[bitWordIt];
+			}
+		}
+	}
+
+	// Shown lines in order, with the low bit set on the ones the index doesn't prove (without separators they are all
+	// matches already). Every line is written, the count only moves past the shown ones.
+	size_t lineCount = 0;
+	for (size_t bitWordIt = 0; bitWordIt < bitWordCount; ++bitWordIt)
+	{
+		lineCount += CountBits(_rangeLines[bitWordIt]);
+	}
+	vector<uint32_t>& shownLines = _searchIsWord ? _matches : _rangeCandidates;
+	if (!_searchIsWord) _rangeCandidates.clear();
+	const size_t firstShown = shownLines.size();
+	shownLines.resize(firstShown + lineCount);
+	uint32_t* shown = shownLines.data() + firstShown;
+	size_t shownCount = 0;
+	const uint32_t shownVerbosities = _filter.Verbosities;
+	for (size_t bitWordIt = 0; bitWordIt < bitWordCount; ++bitWordIt)
+	{
+		for (uint64_t lines = _rangeLines[bitWordIt]; lines != 0; lines &= lines - 1)
+		{
+			const size_t lineIndex = rangeStart + bitWordIt * 64 + FindFirstBit(lines);
+			const uint8_t verbosity = _lineVerbosities[lineIndex];
+			const uint16_t category = _lineCategories[lineIndex];
+			if (_searchIsWord)
+			{
+				shown[shownCount] = static_cast<uint32_t>(lineIndex);
+			}
+			else
+			{
+				const uint32_t unproven = _headerMatches[category * (VerbosityCount + 1) + verbosity] ^ 1;
+				shown[shownCount] = static_cast<uint32_t>((lineIndex - rangeStart) << 1) | unproven;
+			}
+			shownCount += _shownCategories[category] & (shownVerbosities >> verbosity);
+		}
+	}
+	shownLines.resize(firstShown + shownCount);
+	if (_searchIsWord) return;
+
+	// Reading the text is bound by memory latency, the lines ahead are fetched while one is verified
+	const size_t candidateCount = _rangeCandidates.size();
+	for (size_t candidateIt = 0; candidateIt < candidateCount; ++candidateIt)
+	{
+		if (candidateIt + PrefetchDistance < candidateCount)
+		{
+			const uint32_t ahead = _rangeCandidates[candidateIt + PrefetchDistance];
+			if (ahead & 1) PrefetchText(store.GetText(rangeStart + (ahead >> 1)));
+		}
+		const uint32_t candidate = _rangeCandidates[candidateIt];
+		const size_t lineIndex = rangeStart + (candidate >> 1);
+		if ((candidate & 1) && !ContainsFolded(store.GetText(lineIndex), _search)) continue;
+		_matches.push_back(static_cast<uint32_t>(lineIndex));
+	}
+}
+
+void ServerLogIndex::GatherRunLines(size_t run, size_t rangeStart, size_t rangeEnd, uint64_t* rangeLines)
+{
+	const size_t cursorStart = run > 0 ? _searchRuns[run - 1].CursorEnd : 0;
+	for (size_t cursorIt = cursorStart; cursorIt < _searchRuns[run].CursorEnd; ++cursorIt)
+	{
+		WordCursor& cursor = _searchCursors[cursorIt];
+		const vector<uint8_t>& deltas = _wordPostings[cursor.Word].Deltas;
+		while (cursor.Offset < deltas.size())
+		{
+			uint32_t offset = cursor.Offset;
+			const uint32_t line = cursor.NextLine + ReadVarint(deltas.data(), offset);
+			if (line >= rangeEnd) break;
+			// Lines searched by their text before the cursors were extended are skipped
+			if (line >= rangeStart)
+			{
+				const size_t bit = line - rangeStart;
+				rangeLines[bit >> 6] |= uint64_t(1) << (bit & 63);
+			}
+			cursor.Offset = offset;
+			cursor.NextLine = line + 1;
+		}
+	}
+}
+
+void ServerLogIndex::MatchSearchHeaders(const ServerLogStore& store, size_t firstCategory)
+{
+	// Lines of a category start with "Category: Verbosity:", or "Category:" when they are Log (category 0 is the lines
+	// without one)
+	_headerMatches.resize(store.GetCategoryCount() * (VerbosityCount + 1), 0);
+	string header;
+	for (size_t category = std::max(firstCategory, size_t(1)); category < store.GetCategoryCount(); ++category)
+	{
+		for (int verbosity = 0; verbosity < VerbosityCount; ++verbosity)
+		{
+			header = store.GetCategoryName(static_cast<uint16_t>(category));
+			header += ':';
+			if (LogVerbosity(verbosity) != LogVerbosity::Log)
+			{
+				header += ' ';
+				header += LogVerbosityNames[verbosity];
+				header += ':';
+			}
+			_headerMatches[category * (VerbosityCount + 1) + verbosity] = ContainsFolded(header, _search) ? 1 : 0;
+		}
+	}
+}
@@ -0,0 +1,254 @@
+#include <app/serverLogRates.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Unreal's log timestamp (UTC unless the server runs with -LOCALLOGTIMES), '0' stands for any digit
+static constexpr char TimestampPattern[] = "[0000.00.00-00.00.00:000]";
+static constexpr size_t TimestampSize = sizeof(TimestampPattern) - 1;
+static constexpr size_t TimestampSecondSize = 21;
+
+static int64_t FloorDivide(int64_t value, int64_t divisor)
+{
+	const int64_t quotient = value / divisor;
+	return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+static int ParseDigits(const char* digits, int count)
+{
+	int value = 0;
+	for (int digitIt = 0; digitIt < count; ++digitIt)
+	{
+		value = value * 10 + (digits[digitIt] - '0');
+	}
+	return value;
+}
+
+// Days from 1970-01-01 to a date of the proleptic Gregorian calendar
+static int64_t GetDaysFromCivil(int year, int month, int day)
+{
+	year -= month <= 2 ? 1 : 0;
+	const int64_t era = (year >= 0 ? year : year - 399) / 400;
+	const int64_t yearOfEra = year - era * 400;
+	const int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+	const int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+void ServerLogRates::Update(const ServerLogStore& store)
+{
+	const size_t lineCount = store.GetLineCount();
+	if (_countedLineCount == lineCount) return;
+
+	// The lines of a batch arrived together
+	const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+	const int64_t arrivalTime = std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count();
+	for (size_t lineIndex = _countedLineCount; lineIndex < lineCount; ++lineIndex)
+	{
+		const LogLine& line = store.GetLine(lineIndex);
+		int64_t time;
+		if (ParseTimestamp(store.GetText(line), time)) _arrivalOffset = time - arrivalTime;
+		else time = arrivalTime + _arrivalOffset;
+
+		const int64_t bucket = FloorDivide(time, BucketMilliseconds);
+		if (bucket != _pendingBucket)
+		{
+			AddPendingLines();
+			_pendingBucket = bucket;
+		}
+		const size_t pendingIndex = size_t(line.Category) * VerbosityCount + int(line.Verbosity);
+		if (pendingIndex >= _pendingCounts.size()) _pendingCounts.resize(pendingIndex + VerbosityCount, 0);
+		if (_pendingCounts[pendingIndex]++ == 0) _pendingIndices.push_back(static_cast<uint32_t>(pendingIndex));
+	}
+	AddPendingLines();
+	_countedLineCount = lineCount;
+}
+
+void ServerLogRates::Clear()
+{
+	_counts.clear();
+	_lineCounts.clear();
+	_categorySeries.clear();
+	_categoryVerbositySeries.clear();
+	_countedLineCount = 0;
+	_firstBucket = _newestBucket = NoBucket;
+	_pendingBucket = NoBucket;
+	_pendingCounts.clear();
+}
+
+double ServerLogRates::GetFirstTime() const
+{
+	return std::max(_firstBucket, _newestBucket + 1 - int64_t(BucketCount)) * BucketSeconds;
+}
+
+int ServerLogRates::GetCategorySeries(uint16_t category) const
+{
+	return category < _categorySeries.size() ? _categorySeries[category] : -1;
+}
+
+int ServerLogRates::GetCategoryVerbositySeries(uint16_t category, LogVerbosity verbosity) const
+{
+	const size_t seriesIndex = size_t(category) * VerbosityCount + int(verbosity);
+	return seriesIndex < _categoryVerbositySeries.size() ? _categoryVerbositySeries[seriesIndex] : -1;
+}
+
+void ServerLogRates::FindBusiestCategories(size_t count, vector<LogRateSeries>& busiest) const
+{
+	busiest.clear();
+	for (size_t category = 0; category < _categorySeries.size(); ++category)
+	{
+		const int series = _categorySeries[category];
+		if (series < 0 || _lineCounts[series] == 0) continue;
+		busiest.push_back({series, static_cast<uint16_t>(category), LogVerbosity::Log, _lineCounts[series]});
+	}
+
+	const auto busier = [](const LogRateSeries& a, const LogRateSeries& b) { return a.LineCount > b.LineCount; };
+	count = std::min(count, busiest.size());
+	std::partial_sort(busiest.begin(), busiest.begin() + count, busiest.end(), busier);
+	busiest.resize(count);
+}
+
+void ServerLogRates::FindBusiestWarnings(size_t count, vector<LogRateSeries>& busiest) const
+{
+	busiest.clear();
+	for (size_t seriesIndex = 0; seriesIndex < _categoryVerbositySeries.size(); ++seriesIndex)
+	{
+		const int series = _categoryVerbositySeries[seriesIndex];
+		const LogVerbosity verbosity = LogVerbosity(seriesIndex % VerbosityCount);
+		if (series < 0 || _lineCounts[series] == 0 || verbosity > LogVerbosity::Warning) continue;
+		busiest.push_back(
+			{series, static_cast<uint16_t>(seriesIndex / VerbosityCount), verbosity, _lineCounts[series]});
+	}
+
+	const auto busier = [](const LogRateSeries& a, const LogRateSeries& b) { return a.LineCount > b.LineCount; };
+	count = std::min(count, busiest.size());
+	std::partial_sort(busiest.begin(), busiest.begin() + count, busiest.end(), busier);
+	busiest.resize(count);
+}
+
+size_t ServerLogRates::GetMemoryBytes() const
+{
+	return (_counts.capacity() + _pendingCounts.capacity() + _pendingIndices.capacity()) * sizeof(uint32_t) +
+		   _lineCounts.capacity() * sizeof(uint64_t) +
+		   (_categorySeries.capacity() + _categoryVerbositySeries.capacity()) * sizeof(int);
+}
+
+size_t ServerLogRates::GetSlot(int64_t bucket)
+{
+	const int64_t slot = bucket % int64_t(BucketCount);
+	return static_cast<size_t>(slot < 0 ? slot + int64_t(BucketCount) : slot);
+}
+
+bool ServerLogRates::ParseTimestamp(string_view text, int64_t& time)
+{
+	if (text.size() < TimestampSize) return false;
+	const char* timestamp = text.data();
+	const auto isDigit = [](char c) { return static_cast<unsigned>(c - '0') < 10; };
+
+	// Only the milliseconds are checked while the second doesn't change
+	if (memcmp(timestamp, _second, TimestampSecondSize) != 0)
+	{
+		for (size_t byteIt = 0; byteIt < TimestampSecondSize; ++byteIt)
+		{
+			const char expected = TimestampPattern[byteIt];
+			if (expected == '0' ? !isDigit(timestamp[byteIt]) : timestamp[byteIt] != expected) return false;
+		}
+		const int year = ParseDigits(timestamp + 1, 4);
+		const int month = ParseDigits(timestamp + 6, 2);
+		const int day = ParseDigits(timestamp + 9, 2);
+		const int hours = ParseDigits(timestamp + 12, 2);
+		const int minutes = ParseDigits(timestamp + 15, 2);
+		const int seconds = ParseDigits(timestamp + 18, 2);
+		_secondTime =
+			GetDaysFromCivil(year, month, day) * 86400000 + hours * 3600000 + minutes * 60000 + seconds * 1000;
+		memcpy(_second, timestamp, TimestampSecondSize);
+	}
+	const char* milliseconds = timestamp + TimestampSecondSize;
+	if (!isDigit(milliseconds[0]) || !isDigit(milliseconds[1]) || !isDigit(milliseconds[2]) || milliseconds[3] != ']')
+	{
+		return false;
+	}
+	time = _secondTime + ParseDigits(milliseconds, 3);
+	return true;
+}
+
+void ServerLogRates::AddPendingLines()
+{
+	if (_pendingIndices.empty()) return;
+
+	const int64_t bucket = _pendingBucket;
+	if (_newestBucket == NoBucket)
+	{
+		for (int series = 0; series <= VerbosityCount; ++series)
+		{
+			AddSeries();
+		}
+		_firstBucket = _newestBucket = bucket;
+	}
+	else if (bucket > _newestBucket)
+	{
+		AdvanceTo(bucket);
+	}
+	else if (bucket <= _newestBucket - int64_t(BucketCount))
+	{
+		// The clock went back by more than the ring (a server restarted with local log times), it starts over
+		std::fill(_counts.begin(), _counts.end(), 0);
+		std::fill(_lineCounts.begin(), _lineCounts.end(), 0);
+		_firstBucket = _newestBucket = bucket;
+	}
+	_firstBucket = std::min(_firstBucket, bucket);
+
+	// In the order they first showed up, series are created as they were line by line
+	const size_t slot = GetSlot(bucket);
+	for (uint32_t pendingIndex : _pendingIndices)
+	{
+		const uint16_t category = static_cast<uint16_t>(pendingIndex / VerbosityCount);
+		const LogVerbosity verbosity = LogVerbosity(pendingIndex % VerbosityCount);
+		const uint32_t lineCount = _pendingCounts[pendingIndex];
+		_pendingCounts[pendingIndex] = 0;
+
+		if (category >= _categorySeries.size())
+		{
+			_categorySeries.resize(category + 1, -1);
+			_categoryVerbositySeries.resize(_categorySeries.size() * VerbosityCount, -1);
+		}
+		int& categorySeries = _categorySeries[category];
+		if (categorySeries < 0) categorySeries = AddSeries();
+		int& categoryVerbositySeries = _categoryVerbositySeries[pendingIndex];
+		if (categoryVerbositySeries < 0) categoryVerbositySeries = AddSeries();
+
+		// Added series move the counts
+		uint32_t* slotCounts = _counts.data() + slot;
+		for (int series : {AllLinesSeries, GetVerbositySeries(verbosity), categorySeries, categoryVerbositySeries})
+		{
+			slotCounts[series * BucketCount] += lineCount;
+			_lineCounts[series] += lineCount;
+		}
+	}
+	_pendingIndices.clear();
+}
+
+void ServerLogRates::AdvanceTo(int64_t bucket)
+{
+	// The buckets the ring moves over are cleared for reuse, a jump in time clears the whole ring at most
+	const int64_t lastCleared = std::min(bucket, _newestBucket + int64_t(BucketCount));
+	for (int64_t cleared = _newestBucket + 1; cleared <= lastCleared; ++cleared)
+	{
+		uint32_t* slotCounts = _counts.data() + GetSlot(cleared);
+		for (size_t series = 0; series < _lineCounts.size(); ++series)
+		{
+			_lineCounts[series] -= slotCounts[series * BucketCount];
+			slotCounts[series * BucketCount] = 0;
+		}
+	}
+	_newestBucket = bucket;
+}
+
+int ServerLogRates::AddSeries()
+{
+	_counts.resize(_counts.size() + BucketCount, 0);
+	_lineCounts.push_back(0);
+	return static_cast<int>(_lineCounts.size() - 1);
+}
@@ -0,0 +1,413 @@
+#include <app/serverLogStore.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#if defined(__AVX2__)
+	#define SERVER_LOG_USE_AVX2 1
+	#define SERVER_LOG_USE_SSE2 0
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SERVER_LOG_USE_AVX2 0
+	#define SERVER_LOG_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define SERVER_LOG_USE_AVX2 0
+	#define SERVER_LOG_USE_SSE2 0
+#endif
+
+#if _MSC_VER
+	#include <intrin.h>
+#endif
+
+// Bytes compared at once, one bit each in the masks. Reads are copied and scanned a batch at a time (the size of a
+// pipe read), then the lines that ended in it are parsed.
+static constexpr size_t ScanBlockSize = 64;
+static constexpr size_t ScanBatchSize = 4096;
+// Readable bytes past the end of a window, for loads that start in it
+static constexpr size_t ScanPaddingSize = 16;
+
+static constexpr size_t MaxVerbosityNameSize = 11;
+
+// "[Timestamp][Frame]Category: Verbosity: Message", offsets from the start of the line
+struct LogLineFields
+{
+	uint32_t CategoryStart = 0;
+	uint32_t CategoryLength = 0; // 0 when the line has no category
+	LogVerbosity Verbosity = LogVerbosity::Log;
+};
+
+// Positions of the bytes that delimit the header fields, within a window of ScanBlockSize bytes
+struct FieldMasks
+{
+	uint64_t Colons;
+	uint64_t Brackets; // Closing ones
+	uint64_t Spaces;
+};
+
+static int FindFirstBit(uint64_t value)
+{
+#if _MSC_VER && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return static_cast<int>(index);
+#elif _MSC_VER
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<uint32_t>(value))) return static_cast<int>(index);
+	_BitScanForward(&index, static_cast<uint32_t>(value >> 32));
+	return static_cast<int>(index) + 32;
+#else
+	return __builtin_ctzll(value);
+#endif
+}
+
+static void FindVerbosity(string_view name, LogVerbosity& verbosity)
+{
+	for (size_t verbosityIt = 0; verbosityIt < std::size(LogVerbosityNames); ++verbosityIt)
+	{
+		if (name == LogVerbosityNames[verbosityIt])
+		{
+			verbosity = static_cast<LogVerbosity>(verbosityIt);
+			return;
+		}
+	}
+}
+
+// Same as FindVerbosity without a branch on the name: the first letter and the length of the verbosity names hash
+// them apart, a masked comparison with the only candidate confirms the match. At least ScanPaddingSize bytes must be
+// readable from the start of the name.
+static void FindWindowVerbosity(const char* name, size_t size, LogVerbosity& verbosity)
+{
+	static constexpr uint8_t NoVerbosity = 0xFF;
+	static constexpr uint8_t VerbosityByHash[16] = {NoVerbosity, NoVerbosity, NoVerbosity, NoVerbosity, NoVerbosity,
+		NoVerbosity, NoVerbosity, 3, NoVerbosity, 5, 2, 4, NoVerbosity, 6, 1, 0};
+	static constexpr char PaddedVerbosityNames[][ScanPaddingSize] = {
+		"Fatal", "Error", "Warning", "Display", "Log", "Verbose", "VeryVerbose"};
+
+	const uint8_t candidate = VerbosityByHash[(static_cast<uint8_t>(name[0]) + size * 5) & 15];
+	if (candidate == NoVerbosity || size != LogVerbosityNames[candidate].size()) return;
+#if SERVER_LOG_USE_AVX2 || SERVER_LOG_USE_SSE2
+	const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(name));
+	const __m128i expected = _mm_loadu_si128(reinterpret_cast<const __m128i*>(PaddedVerbosityNames[candidate]));
+	const uint32_t equalBytes = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, expected)));
+	const uint32_t nameBytes = (1u << size) - 1;
+	verbosity = (equalBytes & nameBytes) == nameBytes ? static_cast<LogVerbosity>(candidate) : verbosity;
+#else
+	if (memcmp(name, PaddedVerbosityNames[candidate], size) == 0) verbosity = static_cast<LogVerbosity>(candidate);
+#endif
+}
+
+// Byte by byte, for headers that don't fit in a window. The category is the word right before the first colon, the
+// Log verbosity isn't printed and only an exact name counts (so a "Note:" opening the message stays a Log).
+static void ParseLineFields(string_view text, LogLineFields& fields)
+{
+	size_t categoryStart = 0;
+	if (!text.empty() && text[0] == '[')
+	{
+		const size_t timestampEnd = text.find(']');
+		if (timestampEnd == string_view::npos) return;
+		categoryStart = timestampEnd + 1;
+		if (categoryStart < text.size() && text[categoryStart] == '[')
+		{
+			const size_t frameEnd = text.find(']', categoryStart);
+			if (frameEnd == string_view::npos) return;
+			categoryStart = frameEnd + 1;
+		}
+	}
+
+	const size_t categoryEnd = text.find_first_of(": ]", categoryStart);
+	if (categoryEnd == string_view::npos || text[categoryEnd] != ':' || categoryEnd == categoryStart) return;
+	fields.CategoryStart = static_cast<uint32_t>(categoryStart);
+	fields.CategoryLength = static_cast<uint32_t>(categoryEnd - categoryStart);
+
+	const size_t verbosityStart = categoryEnd + 2;
+	const size_t verbosityEnd = text.find(':', verbosityStart);
+	if (verbosityStart > text.size() || text[categoryEnd + 1] != ' ' || verbosityEnd == string_view::npos) return;
+	FindVerbosity(text.substr(verbosityStart, verbosityEnd - verbosityStart), fields.Verbosity);
+}
+
+// Copies a block into the arena and finds its line breaks from the same loads
+static uint64_t CopyLineBreaks(const char* source, char* destination)
+{
+	uint64_t lineBreaks = 0;
+#if SERVER_LOG_USE_AVX2
+	for (int half = 0; half < 2; ++half)
+	{
+		const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + half * 32));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + half * 32), bytes);
+		const uint32_t halfBreaks = _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+		lineBreaks |= uint64_t(halfBreaks) << (half * 32);
+	}
+#elif SERVER_LOG_USE_SSE2
+	for (int quarter = 0; quarter < 4; ++quarter)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + quarter * 16));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + quarter * 16), bytes);
+		const uint32_t quarterBreaks = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+		lineBreaks |= uint64_t(quarterBreaks) << (quarter * 16);
+	}
+#else
+	for (size_t byteIt = 0; byteIt < ScanBlockSize; ++byteIt)
+	{
+		destination[byteIt] = source[byteIt];
+		lineBreaks |= uint64_t(source[byteIt] == '\n') << byteIt;
+	}
+#endif
+	return lineBreaks;
+}
+
+static void FindFieldBytes(const char* window, FieldMasks& masks)
+{
+	masks = {};
+#if SERVER_LOG_USE_AVX2
+	for (int half = 0; half < 2; ++half)
+	{
+		const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(window + half * 32));
+		const int shift = half * 32;
+		masks.Colons |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')))))
+						<< shift;
+		masks.Brackets |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(']')))))
+						  << shift;
+		masks.Spaces |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')))))
+						<< shift;
+	}
+#elif SERVER_LOG_USE_SSE2
+	for (int quarter = 0; quarter < 4; ++quarter)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(window + quarter * 16));
+		const int shift = quarter * 16;
+		masks.Colons |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')))) << shift;
+		masks.Brackets |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(']')))) << shift;
+		masks.Spaces |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')))) << shift;
+	}
+#else
+	for (size_t byteIt = 0; byteIt < ScanBlockSize; ++byteIt)
+	{
+		masks.Colons |= uint64_t(window[byteIt] == ':') << byteIt;
+		masks.Brackets |= uint64_t(window[byteIt] == ']') << byteIt;
+		masks.Spaces |= uint64_t(window[byteIt] == ' ') << byteIt;
+	}
+#endif
+}
+
+// Same fields as ParseLineFields, from the masks of the first ScanBlockSize bytes of the line (readable even past its
+// end, plus ScanPaddingSize). Returns false when the header goes on past the window, the line is then parsed byte by
+// byte.
+static bool ParseWindowFields(const char* window, size_t length, LogLineFields& fields)
+{
+	if (length == 0) return true;
+
+	FieldMasks masks;
+	FindFieldBytes(window, masks);
+	const bool isWholeLine = length <= ScanBlockSize;
+	const uint64_t inLine = isWholeLine ? ~uint64_t(0) >> (ScanBlockSize - length) : ~uint64_t(0);
+	const uint64_t colons = masks.Colons & inLine;
+	const uint64_t brackets = masks.Brackets & inLine;
+	const uint64_t wordEnds = (masks.Spaces | masks.Brackets) & inLine;
+
+	size_t categoryStart = 0;
+	if (window[0] == '[')
+	{
+		if (brackets == 0) return isWholeLine;
+		categoryStart = FindFirstBit(brackets) + 1;
+		if (categoryStart == ScanBlockSize) return false;
+		if (categoryStart < length && window[categoryStart] == '[')
+		{
+			const uint64_t frameBrackets = brackets & (brackets - 1);
+			if (frameBrackets == 0) return isWholeLine;
+			categoryStart = FindFirstBit(frameBrackets) + 1;
+			if (categoryStart == ScanBlockSize) return false;
+		}
+	}
+
+	// A space or bracket before the first colon means there is no category, wherever that colon is
+	const uint64_t afterStart = ~uint64_t(0) << categoryStart;
+	const uint64_t categoryColons = colons & afterStart;
+	if (categoryColons == 0) return isWholeLine || (wordEnds & afterStart) != 0;
+	const size_t categoryEnd = FindFirstBit(categoryColons);
+	const uint64_t beforeEnd = ~(~uint64_t(0) << categoryEnd);
+	if (categoryEnd == categoryStart || (wordEnds & afterStart & beforeEnd) != 0) return true;
+	fields.CategoryStart = static_cast<uint32_t>(categoryStart);
+	fields.CategoryLength = static_cast<uint32_t>(categoryEnd - categoryStart);
+
+	// No verbosity ends past the window when a space or too many bytes come first
+	const size_t verbosityStart = categoryEnd + 2;
+	if (verbosityStart > ScanBlockSize) return false;
+	if (verbosityStart > length || window[categoryEnd + 1] != ' ') return true;
+	const uint64_t verbosityColons = categoryColons & (categoryColons - 1);
+	if (verbosityColons == 0)
+	{
+		if (isWholeLine || ScanBlockSize - verbosityStart > MaxVerbosityNameSize) return true;
+		return verbosityStart < ScanBlockSize && (masks.Spaces & (~uint64_t(0) << verbosityStart)) != 0;
+	}
+	const size_t verbosityEnd = FindFirstBit(verbosityColons);
+	FindWindowVerbosity(window + verbosityStart, verbosityEnd - verbosityStart, fields.Verbosity);
+	return true;
+}
+
+void ServerLogStore::Append(const char* data, size_t size)
+{
+	while (size > 0)
+	{
+		if (_chunks.empty() || _chunks.back().Size == _chunks.back().Capacity) StartChunk();
+
+		const Chunk& chunk = _chunks.back();
+		const size_t copySize = std::min(size, chunk.Capacity - chunk.Size);
+		CopyAndIndexLines(data, copySize);
+		data += copySize;
+		size -= copySize;
+	}
+}
+
+void ServerLogStore::Clear()
+{
+	// Category names point into the arena, they go along with it
+	_lineBlocks.clear();
+	_lineCount = 0;
+	_categories.assign(1, string_view());
+	_categoryIds.clear();
+	_lastCategory = 0;
+	if (_chunks.empty()) return;
+
+	// The partial line moves into a fresh chunk (a huge line keeps its room), everything else is freed
+	Chunk& last = _chunks.back();
+	const size_t pendingSize = last.Size - _lineStart;
+	Chunk chunk;
+	chunk.Capacity = std::max(ChunkSize, pendingSize * 2);
+	chunk.Bytes.reset(new char[chunk.Capacity]);
+	chunk.Size = pendingSize;
+	memcpy(chunk.Bytes.get(), last.Bytes.get() + _lineStart, pendingSize);
+	_chunks.clear();
+	_chunks.push_back(std::move(chunk));
+	_lineStart = 0;
+}
+
+size_t ServerLogStore::GetMemoryBytes() const
+{
+	size_t memoryBytes = _lineBlocks.size() * LineBlockSize * sizeof(LogLine);
+	for (const Chunk& chunk : _chunks)
+	{
+		memoryBytes += chunk.Capacity;
+	}
+	return memoryBytes;
+}
+
+void ServerLogStore::StartChunk()
+{
+	// Lines never span chunks, the partial line at the end of a full chunk moves over to the next one. A line longer
+	// than a chunk gets a chunk twice its size, so it keeps growing geometrically until its line break shows up.
+	size_t pendingSize = 0;
+	const char* pending = nullptr;
+	if (!_chunks.empty())
+	{
+		pendingSize = _chunks.back().Size - _lineStart;
+		pending = _chunks.back().Bytes.get() + _lineStart;
+	}
+
+	Chunk chunk;
+	chunk.Capacity = std::max(ChunkSize, pendingSize * 2);
+	chunk.Bytes.reset(new char[chunk.Capacity]);
+	chunk.Size = pendingSize;
+	if (pendingSize > 0) memcpy(chunk.Bytes.get(), pending, pendingSize);
+
+	// A chunk holding nothing but the partial line is replaced, no line points into it
+	if (!_chunks.empty() && _lineStart == 0)
+	{
+		_chunks.back() = std::move(chunk);
+	}
+	else
+	{
+		if (!_chunks.empty()) _chunks.back().Size = _lineStart;
+		_chunks.push_back(std::move(chunk));
+	}
+	_lineStart = 0;
+}
+
+void ServerLogStore::CopyAndIndexLines(const char* data, size_t size)
+{
+	Chunk& chunk = _chunks.back();
+	char* bytes = chunk.Bytes.get();
+	uint64_t lineBreaks[ScanBatchSize / ScanBlockSize];
+	for (size_t batchOffset = 0; batchOffset < size; batchOffset += ScanBatchSize)
+	{
+		// The last block goes through a zeroed copy, its bits past the end stay clear
+		const size_t batchStart = chunk.Size;
+		const size_t batchSize = std::min(ScanBatchSize, size - batchOffset);
+		const size_t blockCount = (batchSize + ScanBlockSize - 1) / ScanBlockSize;
+		for (size_t blockIt = 0; blockIt < blockCount; ++blockIt)
+		{
+			const size_t blockOffset = blockIt * ScanBlockSize;
+			const char* source = data + batchOffset + blockOffset;
+			char* destination = bytes + batchStart + blockOffset;
+			if (blockOffset + ScanBlockSize <= batchSize)
+			{
+				lineBreaks[blockIt] = CopyLineBreaks(source, destination);
+				continue;
+			}
+			char block[ScanBlockSize] = {};
+			memcpy(block, source, batchSize - blockOffset);
+			memcpy(destination, block, batchSize - blockOffset);
+			lineBreaks[blockIt] = CopyLineBreaks(block, block);
+		}
+		chunk.Size += batchSize;
+
+		for (size_t blockIt = 0; blockIt < blockCount; ++blockIt)
+		{
+			for (uint64_t blockBreaks = lineBreaks[blockIt]; blockBreaks != 0; blockBreaks &= blockBreaks - 1)
+			{
+				AddLine(batchStart + blockIt * ScanBlockSize + FindFirstBit(blockBreaks));
+			}
+		}
+	}
+}
+
+void ServerLogStore::AddLine(size_t lineEnd)
+{
+	const Chunk& chunk = _chunks.back();
+	const char* text = chunk.Bytes.get() + _lineStart;
+	size_t length = lineEnd - _lineStart;
+	if (length > 0 && text[length - 1] == '\r') length--;
+
+	// Windows reaching past the copied bytes (at the end of a read) are taken from a zeroed copy
+	LogLineFields fields;
+	const char* window = text;
+	char paddedWindow[ScanBlockSize + ScanPaddingSize];
+	if (_lineStart + sizeof(paddedWindow) > chunk.Size)
+	{
+		memset(paddedWindow, 0, sizeof(paddedWindow));
+		memcpy(paddedWindow, text, std::min(chunk.Size - _lineStart, sizeof(paddedWindow)));
+		window = paddedWindow;
+	}
+	if (!ParseWindowFields(window, length, fields))
+	{
+		fields = LogLineFields();
+		ParseLineFields(string_view(text, length), fields);
+	}
+
+	LogLine line = {static_cast<uint32_t>(_chunks.size() - 1), static_cast<uint32_t>(_lineStart),
+		static_cast<uint32_t>(length), 0, fields.Verbosity};
+	if (fields.CategoryLength > 0)
+	{
+		line.Category = InternCategory(string_view(text + fields.CategoryStart, fields.CategoryLength));
+	}
+	if ((_lineCount & (LineBlockSize - 1)) == 0) _lineBlocks.emplace_back(new LogLine[LineBlockSize]);
+	_lineBlocks.back()[_lineCount & (LineBlockSize - 1)] = line;
+	_lineCount++;
+	_lineStart = lineEnd + 1;
+}
+
+uint16_t ServerLogStore::InternCategory(string_view name)
+{
+	if (_categories[_lastCategory] == name) return _lastCategory;
+	auto category = _categoryIds.find(name);
+	if (category != _categoryIds.end()) return _lastCategory = category->second;
+
+	// Ids are 16 bits, anything past that many categories is garbage rather than real output
+	if (_categories.size() > UINT16_MAX) return 0;
+	const uint16_t categoryId = static_cast<uint16_t>(_categories.size());
+	_categories.push_back(name);
+	_categoryIds.emplace(name, categoryId);
+	return _lastCategory = categoryId;
+}
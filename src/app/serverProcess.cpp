@@ -0,0 +1,250 @@
+#include <app/serverProcess.h>
+
+// Platform Includes
+#if WIN32
+	#include <windows.h>
+#else
+	#include <cerrno>
+	#include <csignal>
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <spawn.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+
+extern char** environ;
+#endif
+
+// Third Party Includes
+#include <fmt/core.h>
+
+ServerProcess::~ServerProcess() { Stop(); }
+
+size_t ServerProcess::PullOutput(vector<char>& batch)
+{
+	batch.clear();
+	std::lock_guard<std::mutex> lock(_outputLock);
+	batch.swap(_output);
+	return batch.size();
+}
+
+void ServerProcess::PushOutput(const char* data, size_t size)
+{
+	bool wasEmpty;
+	{
+		std::lock_guard<std::mutex> lock(_outputLock);
+		wasEmpty = _output.empty();
+		_output.insert(_output.end(), data, data + size);
+	}
+	// A batch that isn't empty was not pulled yet, its owner is awake already
+	if (wasEmpty && _onOutput) _onOutput();
+}
+
+#if WIN32
+bool ServerProcess::Start(const string& commandLine, string* error)
+{
+	Stop();
+
+	// Only the write end is inherited by the server
+	SECURITY_ATTRIBUTES pipeAttributes = {sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
+	HANDLE outputRead = nullptr;
+	HANDLE outputWrite = nullptr;
+	if (!CreatePipe(&outputRead, &outputWrite, &pipeAttributes, 0) ||
+		!SetHandleInformation(outputRead, HANDLE_FLAG_INHERIT, 0))
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't create the output pipe (error {0})", GetLastError());
+		if (outputRead != nullptr) CloseHandle(outputRead);
+		if (outputWrite != nullptr) CloseHandle(outputWrite);
+		return false;
+	}
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof(STARTUPINFOA);
+	startupInfo.hStdError = outputWrite;
+	startupInfo.hStdOutput = outputWrite;
+	startupInfo.dwFlags |= STARTF_USESTDHANDLES;
+
+	// CreateProcess may write to the command line
+	vector<char> commandBuffer(commandLine.begin(), commandLine.end());
+	commandBuffer.push_back('\0');
+
+	// Suspended until it's in the job, so nothing it starts escapes it
+	PROCESS_INFORMATION processInfo = {};
+	const BOOL launched = CreateProcessA(nullptr, commandBuffer.data(), nullptr, nullptr, TRUE, CREATE_SUSPENDED,
+		nullptr, nullptr, &startupInfo, &processInfo);
+	// The server holds the only write end from now on, reads end once it (and what it started) closed it
+	CloseHandle(outputWrite);
+	if (!launched)
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't launch: {0} (error {1})", commandLine, GetLastError());
+		CloseHandle(outputRead);
+		return false;
+	}
+
+	// Closing the job (Stop or the application going away) terminates the server
+	_job = CreateJobObject(nullptr, nullptr);
+	JOBOBJECT_EXTENDED_LIMIT_INFORMATION jobInfo = {};
+	jobInfo.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+	if (_job == nullptr ||
+		!SetInformationJobObject(_job, JobObjectExtendedLimitInformation, &jobInfo, sizeof(jobInfo)) ||
+		!AssignProcessToJobObject(_job, processInfo.hProcess))
+	{
+		if (error != nullptr) *error = "Beware, if the app crashes the server process will NOT close!";
+	}
+	ResumeThread(processInfo.hThread);
+	CloseHandle(processInfo.hThread);
+
+	_process = processInfo.hProcess;
+	_outputPipe = outputRead;
+	_exited = false;
+	_exitCode = 0;
+	_stopRequested = false;
+	_readThread = std::thread([this]() { ReadLoop(); });
+	return true;
+}
+
+void ServerProcess::Stop()
+{
+	if (!_readThread.joinable()) return;
+
+	_stopRequested = true;
+	TerminateProcess(_process, 1);
+
+	// Something the server started may still hold the pipe open, the blocking read is cancelled then (repeatedly, in
+	// case the reader was between the stop check and the read)
+	HANDLE readThread = _readThread.native_handle();
+	while (WaitForSingleObject(readThread, 10) == WAIT_TIMEOUT)
+	{
+		CancelSynchronousIo(readThread);
+	}
+	_readThread.join();
+
+	CloseHandle(_outputPipe);
+	CloseHandle(_process);
+	if (_job != nullptr) CloseHandle(_job);
+	_outputPipe = _process = _job = nullptr;
+}
+
+void ServerProcess::ReadLoop()
+{
+	char buffer[ReadSize];
+	while (!_stopRequested)
+	{
+		// Fails with ERROR_BROKEN_PIPE at the end of the output, ERROR_OPERATION_ABORTED when cancelled by Stop
+		DWORD readSize = 0;
+		if (!ReadFile(_outputPipe, buffer, ReadSize, &readSize, nullptr)) break;
+		if (readSize > 0) PushOutput(buffer, readSize);
+	}
+
+	DWORD exitCode = 0;
+	WaitForSingleObject(_process, INFINITE);
+	GetExitCodeProcess(_process, &exitCode);
+	_exitCode = exitCode;
+	_exited = true;
+	if (_onOutput) _onOutput();
+}
+#else
+bool ServerProcess::Start(const string& commandLine, string* error)
+{
+	Stop();
+
+	int outputPipe[2];
+	if (pipe2(outputPipe, O_CLOEXEC) != 0)
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't create the output pipe (errno {0})", errno);
+		return false;
+	}
+	if (pipe2(_stopPipe, O_CLOEXEC) != 0)
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't create the stop pipe (errno {0})", errno);
+		close(outputPipe[0]);
+		close(outputPipe[1]);
+		return false;
+	}
+
+	// Both outputs go to the write end, dup2 clears its close on exec flag in the child
+	posix_spawn_file_actions_t fileActions;
+	posix_spawn_file_actions_init(&fileActions);
+	posix_spawn_file_actions_adddup2(&fileActions, outputPipe[1], STDOUT_FILENO);
+	posix_spawn_file_actions_adddup2(&fileActions, outputPipe[1], STDERR_FILENO);
+
+	// A process group of its own, so Stop kills what the server (or the shell) started as well
+	posix_spawnattr_t attributes;
+	posix_spawnattr_init(&attributes);
+	posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+	posix_spawnattr_setpgroup(&attributes, 0);
+
+	const char* arguments[] = {"/bin/sh", "-c", commandLine.c_str(), nullptr};
+	pid_t processId = -1;
+	const int spawnError = posix_spawn(&processId, arguments[0], &fileActions, &attributes,
+		const_cast<char* const*>(arguments), environ);
+	posix_spawn_file_actions_destroy(&fileActions);
+	posix_spawnattr_destroy(&attributes);
+
+	// The server holds the only write end from now on, reads end once it (and what it started) closed it
+	close(outputPipe[1]);
+	if (spawnError != 0)
+	{
+		if (error != nullptr) *error = fmt::format("Couldn't launch: {0} (errno {1})", commandLine, spawnError);
+		close(outputPipe[0]);
+		close(_stopPipe[0]);
+		close(_stopPipe[1]);
+		_stopPipe[0] = _stopPipe[1] = -1;
+		return false;
+	}
+
+	_processId = processId;
+	_outputFd = outputPipe[0];
+	_exited = false;
+	_exitCode = 0;
+	_readThread = std::thread([this]() { ReadLoop(); });
+	return true;
+}
+
+void ServerProcess::Stop()
+{
+	if (!_readThread.joinable()) return;
+
+	// Only the reader reaps the process, the group id can't be taken by another one before it did
+	if (!_exited) kill(-_processId, SIGKILL);
+	const char stop = 1;
+	while (write(_stopPipe[1], &stop, 1) < 0 && errno == EINTR)
+	{
+	}
+	_readThread.join();
+
+	close(_outputFd);
+	close(_stopPipe[0]);
+	close(_stopPipe[1]);
+	_processId = _outputFd = _stopPipe[0] = _stopPipe[1] = -1;
+}
+
+void ServerProcess::ReadLoop()
+{
+	char buffer[ReadSize];
+	pollfd polls[2] = {{_outputFd, POLLIN, 0}, {_stopPipe[0], POLLIN, 0}};
+	for (;;)
+	{
+		if (poll(polls, 2, -1) < 0)
+		{
+			if (errno == EINTR) continue;
+			break;
+		}
+		if (polls[1].revents != 0) break;
+
+		// A hang up still reads what's left, then 0 at the end of the output
+		const ssize_t readSize = read(_outputFd, buffer, ReadSize);
+		if (readSize < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+		if (readSize <= 0) break;
+		PushOutput(buffer, static_cast<size_t>(readSize));
+	}
+
+	int status = 0;
+	while (waitpid(_processId, &status, 0) < 0 && errno == EINTR)
+	{
+	}
+	_exitCode = WIFSIGNALED(status) ? 128 + WTERMSIG(status) : WEXITSTATUS(status);
+	_exited = true;
+	if (_onOutput) _onOutput();
+}
+#endif
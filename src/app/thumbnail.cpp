@@ -0,0 +1,113 @@
+#include <app/thumbnail.h>
+
+// StdLib Includes
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define THUMBNAIL_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define THUMBNAIL_USE_SSE2 0
+#endif
+
+// Adds one source row into the 32-bit column accumulators
+static void AccumulateRow(const uint8_t* row, size_t size, uint32_t* sums)
+{
+	size_t offset = 0;
+#if THUMBNAIL_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	for (; offset + 16 <= size; offset += 16)
+	{
+		const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + offset));
+		const __m128i wordsLo = _mm_unpacklo_epi8(bytes, zero);
+		const __m128i wordsHi = _mm_unpackhi_epi8(bytes, zero);
+
+		__m128i* sumsVec = reinterpret_cast<__m128i*>(sums + offset);
+		_mm_storeu_si128(sumsVec + 0, _mm_add_epi32(_mm_loadu_si128(sumsVec + 0), _mm_unpacklo_epi16(wordsLo, zero)));
+		_mm_storeu_si128(sumsVec + 1, _mm_add_epi32(_mm_loadu_si128(sumsVec + 1), _mm_unpackhi_epi16(wordsLo, zero)));
+		_mm_storeu_si128(sumsVec + 2, _mm_add_epi32(_mm_loadu_si128(sumsVec + 2), _mm_unpacklo_epi16(wordsHi, zero)));
+		_mm_storeu_si128(sumsVec + 3, _mm_add_epi32(_mm_loadu_si128(sumsVec + 3), _mm_unpackhi_epi16(wordsHi, zero)));
+	}
+#endif
+	for (; offset < size; ++offset)
+	{
+		sums[offset] += row[offset];
+	}
+}
+
+void DownscaleBox(const uint8_t* rgbPixels, int width, int height, uint8_t* outPixels, int outWidth, int outHeight)
+{
+	const size_t rowSize = static_cast<size_t>(width) * 3;
+	std::vector<uint32_t> columnSums(rowSize);
+
+	for (int outY = 0; outY < outHeight; ++outY)
+	{
+		// Vertical pass: sum the covered source rows (this touches every source pixel, so it is the hot part)
+		const int rowBegin = static_cast<int>(static_cast<int64_t>(outY) * height / outHeight);
+		const int rowEnd = std::max(rowBegin + 1, static_cast<int>(static_cast<int64_t>(outY + 1) * height / outHeight));
+		std::fill(columnSums.begin(), columnSums.end(), 0);
+		for (int y = rowBegin; y < rowEnd; ++y)
+		{
+			AccumulateRow(rgbPixels + y * rowSize, rowSize, columnSums.data());
+		}
+
+		// Horizontal pass over the already reduced row
+		uint8_t* outRow = outPixels + static_cast<size_t>(outY) * outWidth * 3;
+		for (int outX = 0; outX < outWidth; ++outX)
+		{
+			const int columnBegin = static_cast<int>(static_cast<int64_t>(outX) * width / outWidth);
+			const int columnEnd =
+				std::max(columnBegin + 1, static_cast<int>(static_cast<int64_t>(outX + 1) * width / outWidth));
+			const uint32_t count = static_cast<uint32_t>((columnEnd - columnBegin) * (rowEnd - rowBegin));
+
+			uint32_t sum[3] = {0, 0, 0};
+			for (int x = columnBegin; x < columnEnd; ++x)
+			{
+				sum[0] += columnSums[x * 3 + 0];
+				sum[1] += columnSums[x * 3 + 1];
+				sum[2] += columnSums[x * 3 + 2];
+			}
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				outRow[outX * 3 + channel] = static_cast<uint8_t>((sum[channel] + count / 2) / count);
+			}
+		}
+	}
+}
+
+void FitThumbnail(int width, int height, int& fitWidth, int& fitHeight)
+{
+	fitWidth = ThumbnailWidth;
+	fitHeight = ThumbnailHeight;
+	if (width <= 0 || height <= 0) return;
+
+	// Wider than the thumbnail fills its width, taller fills its height
+	if (static_cast<int64_t>(width) * ThumbnailHeight >= static_cast<int64_t>(height) * ThumbnailWidth)
+	{
+		fitHeight = static_cast<int>((static_cast<int64_t>(height) * ThumbnailWidth + width / 2) / width);
+		fitHeight = std::min(std::max(fitHeight, 1), ThumbnailHeight);
+	}
+	else
+	{
+		fitWidth = static_cast<int>((static_cast<int64_t>(width) * ThumbnailHeight + height / 2) / height);
+		fitWidth = std::min(std::max(fitWidth, 1), ThumbnailWidth);
+	}
+}
+
+void LetterboxThumbnail(const uint8_t* fitPixels, int fitWidth, int fitHeight, uint8_t* thumbnailPixels)
+{
+	constexpr size_t thumbnailRowSize = static_cast<size_t>(ThumbnailWidth) * 3;
+	const size_t fitRowSize = static_cast<size_t>(fitWidth) * 3;
+	const int offsetX = (ThumbnailWidth - fitWidth) / 2;
+	const int offsetY = (ThumbnailHeight - fitHeight) / 2;
+
+	memset(thumbnailPixels, 0, thumbnailRowSize * ThumbnailHeight);
+	for (int y = 0; y < fitHeight; ++y)
+	{
+		uint8_t* thumbnailRow = thumbnailPixels + (offsetY + y) * thumbnailRowSize + offsetX * 3;
+		memcpy(thumbnailRow, fitPixels + y * fitRowSize, fitRowSize);
+	}
+}
@@ -1,16 +1,25 @@
-
 // Hide Console Window
 //#pragma comment(linker, "/SUBSYSTEM:windows /ENTRY:mainCRTStartup")
-
 #include <app/app.h>
+#include <app/frameBatchAnalysis.h>
 #include <fstream>
-
 int main(int argc, char** argv)
 {
-	setlocale(LC_ALL, "Portuguese");
+	// Headless analysis of frame captures, never creates a window
+	if (IsFrameBatchCommand(argc, argv))
+	{
+		FrameBatchOptions options;
+		string error;
+		if (!ParseFrameBatchArguments(argc, argv, options, &error))
+		{
+			PrintFrameBatchUsage(error);
+			return 1;
+		}
+		return RunFrameBatchAnalysis(options);
+	}
 
+	setlocale(LC_ALL, "Portuguese");
 	UE4NetworkTool app;
 	app.Run();
-
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,117 @@
+// Checks the freeze runs of the headless analysis (RunFrameBatchAnalysis) on generated captures: a still clip holds
+// a single run, a small object moving over a still background and frames that fail to decode hold none.
+// Returns the number of failed checks.
+
+#define STB_IMAGE_IMPLEMENTATION
+
+// StdLib Includes
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Third Party Includes
+#include <fmt/core.h>
+#include <stb_image.h>
+
+// Internal Includes
+#include <app/frameBatchAnalysis.h>
+#include "../bench/syntheticFrames.h"
+
+namespace fs = std::filesystem;
+
+constexpr int FrameWidth = 320;
+constexpr int FrameHeight = 180;
+constexpr int ClipFrames = 30;
+
+enum class ClipKind
+{
+	Still,
+	Moving, // An 8x8 block crossing the frame, too small to move the perceptual hash much
+	Failing // Still frames with undecodable files in the middle
+};
+
+static bool IsFailingFrame(int frameIndex) { return frameIndex >= 8 && frameIndex < 20; }
+
+static string WriteClip(const fs::path& directory, ClipKind kind)
+{
+	fs::remove_all(directory);
+	fs::create_directories(directory);
+
+	vector<uint8_t> pixels;
+	for (int frameIt = 0; frameIt < ClipFrames; ++frameIt)
+	{
+		const string framePath = (directory / fmt::format("frame_{0:04}.png", frameIt)).string();
+		if (kind == ClipKind::Failing && IsFailingFrame(frameIt))
+		{
+			std::ofstream(framePath, std::ios::binary) << "not a frame";
+			continue;
+		}
+
+		synthetic::GenerateFramePixels(pixels, FrameWidth, FrameHeight, 0);
+		if (kind == ClipKind::Moving)
+		{
+			const int blockX = 16 + frameIt * 8;
+			for (int y = 80; y < 88; ++y)
+			{
+				for (int x = blockX; x < blockX + 8; ++x)
+				{
+					uint8_t* pixel = &pixels[(static_cast<size_t>(y) * FrameWidth + x) * 3];
+					pixel[0] = 255;
+					pixel[1] = 255;
+					pixel[2] = 255;
+				}
+			}
+		}
+		synthetic::WriteFrame(framePath, synthetic::FrameFormat::Png, pixels, FrameWidth, FrameHeight);
+	}
+	return directory.string();
+}
+
+// The "freezeRuns" array of the only stream of the report
+static string AnalyzeClip(const string& directory, const fs::path& reportPath)
+{
+	FrameBatchOptions options;
+	options.Inputs.push_back(directory);
+	options.ReportPath = reportPath.string();
+	options.FreezeMinFrames = 10;
+	RunFrameBatchAnalysis(options);
+
+	std::stringstream report;
+	report << std::ifstream(reportPath).rdbuf();
+	const string json = report.str();
+	const size_t start = json.find("\"freezeRuns\": [");
+	if (start == string::npos) return "missing";
+	const size_t end = json.find(']', start);
+	return json.substr(start + 15, end - start - 15);
+}
+
+int main()
+{
+	const fs::path root = fs::temp_directory_path() / "frame_batch_analysis_test";
+	const fs::path reportPath = root / "report.json";
+	int failedChecks = 0;
+	auto check = [&](const char* name, bool passed, const string& freezeRuns)
+	{
+		fmt::print("{0}: {1} (freeze runs: [{2}])\n", name, passed ? "passed" : "FAILED", freezeRuns);
+		if (!passed) failedChecks++;
+	};
+
+	const string stillRuns = AnalyzeClip(WriteClip(root / "still", ClipKind::Still), reportPath);
+	check("Still clip holds one run", stillRuns.find("{\"firstFrame\": 0, \"lastFrame\": 29,") == 0 &&
+										  stillRuns.find("}, {") == string::npos, stillRuns);
+
+	const string movingRuns = AnalyzeClip(WriteClip(root / "moving", ClipKind::Moving), reportPath);
+	check("Moving clip holds no run", movingRuns.empty(), movingRuns);
+
+	// Frames 0-7 are too short to make a run, failed frames 8-19 must not make one either
+	const string failingRuns = AnalyzeClip(WriteClip(root / "failing", ClipKind::Failing), reportPath);
+	check("Failed frames end runs", failingRuns.find("{\"firstFrame\": 20, \"lastFrame\": 29,") == 0 &&
+										failingRuns.find("}, {") == string::npos, failingRuns);
+
+	std::error_code errorCode;
+	fs::remove_all(root, errorCode);
+	return failedChecks;
+}
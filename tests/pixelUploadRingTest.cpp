@@ -0,0 +1,150 @@
+// Checks the slot sequencing of the PixelUploadRing and that slots staged into again right after their upload was
+// issued (as FrameResidency::SyncUploads does) don't change the pixels of earlier uploads.
+// Needs an OpenGL 3.3 context, from a hidden GLFW window: a software rasterizer will do (Mesa llvmpipe under Xvfb,
+// LIBGL_ALWAYS_SOFTWARE=1). Returns SkipExitCode without a context, else the number of failed checks.
+
+// StdLib Includes
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Third Party Includes
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <fmt/core.h>
+
+// Internal Includes
+#include <app/pixelUploadRing.h>
+
+constexpr int SkipExitCode = 77;
+constexpr int FrameWidth = 64;
+constexpr int FrameHeight = 32;
+constexpr size_t FrameSize = size_t(FrameWidth) * FrameHeight * 3;
+
+static int failedChecks = 0;
+
+static void Check(const char* name, bool passed)
+{
+	fmt::print("{0}: {1}\n", name, passed ? "passed" : "FAILED");
+	if (!passed) failedChecks++;
+}
+
+static void FillFrame(uint8_t* pixels, int frameIndex)
+{
+	for (size_t byteIt = 0; byteIt < FrameSize; ++byteIt)
+	{
+		pixels[byteIt] = static_cast<uint8_t>(byteIt * 7 + frameIndex * 31);
+	}
+}
+
+// Acquire, Free and Unacquire move through the slots in order, whatever GL does with the buffers
+static void CheckSlotOrder()
+{
+	PixelUploadRing ring(4);
+	bool inOrder = true;
+	for (int slotIt = 0; slotIt < 4; ++slotIt)
+	{
+		inOrder &= ring.Acquire(FrameSize) == slotIt;
+	}
+	Check("Slots are taken in order", inOrder);
+	Check("A full ring hands out no slot", ring.IsFull() && ring.Acquire(FrameSize) == -1);
+
+	ring.Free();
+	Check("Freed slots are taken again after the newest one", ring.Acquire(FrameSize) == 0);
+
+	ring.Unacquire();
+	Check("Unacquired slots are taken again first", ring.GetUsedCount() == 3 && ring.Acquire(FrameSize) == 0);
+
+	while (ring.GetUsedCount() > 0)
+	{
+		ring.Free();
+	}
+	Check("An emptied ring goes on from the slot it stopped at", ring.Acquire(FrameSize) == 1);
+	ring.Release();
+}
+
+// Every frame is staged, uploaded and its slot freed before the next one, without waiting for the GPU. Slots come
+// around again while the driver may still read them, the invalidating map must not touch the pending uploads.
+static void CheckStagedUploads()
+{
+	constexpr int FrameCount = 64;
+	constexpr int SlotCount = 2;
+	PixelUploadRing ring(SlotCount);
+	vector<GLuint> textures(FrameCount);
+	glGenTextures(FrameCount, textures.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+	bool staged = true;
+	for (int frameIt = 0; frameIt < FrameCount; ++frameIt)
+	{
+		glBindTexture(GL_TEXTURE_2D, textures[frameIt]);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, FrameWidth, FrameHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+
+		const int slot = ring.Acquire(FrameSize);
+		uint8_t* stagingData = slot >= 0 ? ring.Map(slot, FrameSize) : nullptr;
+		if (stagingData == nullptr)
+		{
+			staged = false;
+			break;
+		}
+		FillFrame(stagingData, frameIt);
+		staged &= ring.Unmap(slot);
+
+		ring.Bind(slot);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, FrameWidth, FrameHeight, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		ring.Free();
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	Check("Frames are staged through the ring", staged && glGetError() == GL_NO_ERROR);
+	Check("Steady state creates no buffers", ring.GetBufferAllocationCount() == SlotCount);
+
+	int mismatchedCount = 0;
+	vector<uint8_t> expected(FrameSize), uploaded(FrameSize);
+	for (int frameIt = 0; frameIt < FrameCount; ++frameIt)
+	{
+		FillFrame(expected.data(), frameIt);
+		glBindTexture(GL_TEXTURE_2D, textures[frameIt]);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, uploaded.data());
+		if (memcmp(expected.data(), uploaded.data(), FrameSize) != 0) mismatchedCount++;
+	}
+	Check("Uploads keep the pixels they were staged with", mismatchedCount == 0);
+
+	// Larger frames grow the slot they go through, once
+	const int slot = ring.Acquire(FrameSize * 2);
+	ring.Free();
+	ring.Acquire(FrameSize * 2);
+	Check("Larger frames grow their slot", slot >= 0 && ring.GetBufferAllocationCount() == SlotCount + 2);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDeleteTextures(FrameCount, textures.data());
+	ring.Release();
+}
+
+int main()
+{
+	if (!glfwInit()) return SkipExitCode;
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "pixel_upload_ring_test", nullptr, nullptr);
+	if (window == nullptr)
+	{
+		fmt::print("No OpenGL 3.3 context, skipped\n");
+		glfwTerminate();
+		return SkipExitCode;
+	}
+	glfwMakeContextCurrent(window);
+	gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+	fmt::print("{0} | {1}\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+
+	CheckSlotOrder();
+	CheckStagedUploads();
+
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return failedChecks;
+}
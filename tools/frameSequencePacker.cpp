@@ -0,0 +1,74 @@
+// Packs a directory of frame snapshots into a single memory-mappable frame sequence (*.ufs).
+// Frames are packed in file name order, which matches the capture order of the snapshot writer.
+//
+// Usage: frame_sequence_packer <snapshot directory> <output.ufs>
+
+// StdLib Includes
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Third Party Includes
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <fmt/core.h>
+#include <taskflow/core/executor.hpp>
+
+// Internal Includes
+#include <app/frameSequenceFile.h>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		fmt::print(stderr, "Usage: frame_sequence_packer <snapshot directory> <output{0}>\n", FrameSequenceExtension);
+		return 1;
+	}
+
+	const fs::path inputDir = argv[1];
+	const string outputPath = argv[2];
+	if (!fs::is_directory(inputDir))
+	{
+		fmt::print(stderr, "Not a directory: {0}\n", inputDir.string());
+		return 1;
+	}
+
+	vector<string> framePaths;
+	for (const fs::directory_entry& entry : fs::directory_iterator(inputDir))
+	{
+		string ext = entry.path().extension().string();
+		std::transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return (char)tolower(c); });
+		if (ext == ".png" || ext == ".tga" || ext == ".bmp" || ext == ".jpeg" || ext == ".jpg" || ext == ".gif")
+		{
+			framePaths.push_back(entry.path().string());
+		}
+	}
+	std::sort(framePaths.begin(), framePaths.end());
+
+	if (framePaths.empty())
+	{
+		fmt::print(stderr, "No frame snapshots found in {0}\n", inputDir.string());
+		return 1;
+	}
+
+	fmt::print("Packing {0} frames into {1}\n", framePaths.size(), outputPath);
+	auto start = std::chrono::steady_clock::now();
+
+	string error;
+	tf::Executor executor;
+	if (!PackFrameSequence(framePaths, outputPath, executor, &error))
+	{
+		fmt::print(stderr, "{0}\n", error);
+		return 1;
+	}
+
+	const double elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	const double sizeMB = fs::file_size(outputPath) / (1024.0 * 1024.0);
+	fmt::print("Done in {0:.2f} s ({1:.1f} MB, {2:.1f} MB/s)\n", elapsedSec, sizeMB, sizeMB / elapsedSec);
+	return 0;
+}